@@ -0,0 +1,47 @@
+# Compile time benchmark for the explicit event instantiations, run by the astl-compile-benchmark target:
+#   cmake -DCXX=<compiler> -DINCLUDE_DIR=<core include dir> -DSOURCE=<unit> -DOUTPUT_DIR=<dir> [-DRUNS=n]
+#         [-DFLAGS=<flags>] -P compile_benchmark.cmake
+# The unit is compiled RUNS times with and without ASTL_EXTERN_TEMPLATES, the mean wall clock times and the object
+# sizes are reported.
+
+if (NOT RUNS)
+    set(RUNS 5)
+endif()
+separate_arguments(FLAGS)
+
+function(astl_time_compile variant defines result_ms result_size)
+    set(object ${OUTPUT_DIR}/compile_unit-${variant}.o)
+    set(total 0)
+    foreach (run RANGE 1 ${RUNS})
+        string(TIMESTAMP start "%s%f")
+        execute_process(
+            COMMAND ${CXX} -std=c++17 ${FLAGS} ${defines} -I${INCLUDE_DIR} -c ${SOURCE} -o ${object}
+            RESULT_VARIABLE status
+        )
+        string(TIMESTAMP stop "%s%f")
+        if (NOT status EQUAL 0)
+            message(FATAL_ERROR "compiling ${SOURCE} (${variant}) failed")
+        endif()
+        math(EXPR total "${total} + (${stop} - ${start}) / 1000")
+    endforeach()
+    math(EXPR mean "${total} / ${RUNS}")
+    file(SIZE ${object} size)
+    set(${result_ms} ${mean} PARENT_SCOPE)
+    set(${result_size} ${size} PARENT_SCOPE)
+endfunction()
+
+file(MAKE_DIRECTORY ${OUTPUT_DIR})
+astl_time_compile(implicit "" implicit_ms implicit_size)
+astl_time_compile(extern "-DASTL_EXTERN_TEMPLATES" extern_ms extern_size)
+
+math(EXPR saved_ms "${implicit_ms} - ${extern_ms}")
+if (implicit_ms GREATER 0)
+    math(EXPR saved_pct "100 * ${saved_ms} / ${implicit_ms}")
+else()
+    set(saved_pct 0)
+endif()
+
+message(STATUS "astl compile benchmark, ${RUNS} runs, flags '${FLAGS}'")
+message(STATUS "  implicit instantiation   ${implicit_ms} ms   ${implicit_size} bytes")
+message(STATUS "  extern templates         ${extern_ms} ms   ${extern_size} bytes")
+message(STATUS "  saved                    ${saved_ms} ms (${saved_pct}%)")
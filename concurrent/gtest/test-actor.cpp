@@ -0,0 +1,198 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/actor.h>
+#include <astl/future.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct AddTag{};
+    struct NameTag{};
+    struct alignas(128) wide_value
+    {
+        int value;
+    };
+}
+
+TEST(actor, RoutesByTagAndTypes)
+{
+    astl::actor_system system{2};
+    astl::actor a{system};
+    int sum{0};
+    std::string name{};
+    a.on<AddTag, int>([&sum](int const& v){ sum += v; });
+    a.on<NameTag, std::string>([&name](std::string const& v){ name = v; });
+
+    a.send<AddTag>(1);
+    a.send<AddTag>(2);
+    a.send<NameTag>(std::string{"actor"});
+    a.send<AddTag>(std::string{"unhandled"});   // no inbox for AddTag, std::string: dropped
+    system.wait_idle();
+
+    EXPECT_EQ(sum, 3);
+    EXPECT_EQ(name, "actor");
+}
+
+TEST(actor, OverAlignedMessages)
+{
+    astl::actor_system system{1};
+    astl::actor a{system};
+    int sum{0};
+    bool aligned{true};
+    a.on<AddTag, wide_value>([&](wide_value const& v){
+        aligned = aligned && reinterpret_cast<std::uintptr_t>(&v) % alignof(wide_value) == 0;
+        sum += v.value;
+    });
+    a.execute([&aligned, w = wide_value{0}](){
+        aligned = aligned && reinterpret_cast<std::uintptr_t>(&w) % alignof(wide_value) == 0;
+    });
+    for (int i = 1; i <= 4; ++i) {
+        a.send<AddTag>(wide_value{i});
+    }
+    system.wait_idle();
+
+    EXPECT_EQ(sum, 10);
+    EXPECT_TRUE(aligned);
+}
+
+TEST(actor, FifoPerSender)
+{
+    astl::actor_system system{3, 4};
+    astl::actor a{system};
+    std::vector<int> received{};
+    a.on<AddTag, int>([&received](int const& v){ received.push_back(v); });
+
+    for (int i = 0; i < 1000; ++i) {
+        a.send<AddTag>(i);
+    }
+    system.wait_idle();
+
+    ASSERT_EQ(received.size(), 1000u);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(received[i], i);
+    }
+}
+
+TEST(actor, HandlersNeverRunConcurrently)
+{
+    astl::actor_system system{4, 2};
+    astl::actor a{system};
+    int counter{0};     // unsynchronized on purpose, races show up with thread sanitizer
+    a.on<AddTag, int>([&counter](int const& v){ counter += v; });
+
+    std::vector<std::thread> senders{};
+    for (int t = 0; t < 4; ++t) {
+        senders.emplace_back([&a](){
+            for (int i = 0; i < 10000; ++i) {
+                a.send<AddTag>(1);
+            }
+        });
+    }
+    for (auto& s : senders) {
+        s.join();
+    }
+    system.wait_idle();
+
+    EXPECT_EQ(counter, 40000);
+}
+
+TEST(actor, ManyIdleActors)
+{
+    astl::actor_system system{2};
+    std::vector<std::unique_ptr<astl::actor>> actors{};
+    std::atomic<int> received{0};
+    for (int i = 0; i < 100000; ++i) {
+        actors.push_back(std::make_unique<astl::actor>(system));
+        actors.back()->on<AddTag, int>([&received](int const& v){ received += v; });
+    }
+    for (std::size_t i = 0; i < actors.size(); i += 1000) {
+        actors[i]->send<AddTag>(1);
+    }
+    system.wait_idle();
+
+    EXPECT_EQ(received, 100);
+}
+
+TEST(actor, ActorsMessagingEachOther)
+{
+    astl::actor_system system{2};
+    astl::actor ping{system};
+    astl::actor pong{system};
+    int pings{0};
+    int pongs{0};
+    ping.on<AddTag, int>([&](int const& n){
+        ++pings;
+        if (n > 0) {
+            pong.send<AddTag>(n - 1);
+        }
+    });
+    pong.on<AddTag, int>([&](int const& n){
+        ++pongs;
+        if (n > 0) {
+            ping.send<AddTag>(n - 1);
+        }
+    });
+
+    ping.send<AddTag>(99);
+    system.wait_idle();
+
+    EXPECT_EQ(pings, 50);
+    EXPECT_EQ(pongs, 50);
+}
+
+TEST(actor, ShutdownProcessesQueuedMessages)
+{
+    int sum{0};
+    auto system = std::make_unique<astl::actor_system>(1);
+    astl::actor a{*system};
+    a.on<AddTag, int>([&sum](int const& v){ sum += v; });
+    for (int i = 0; i < 100; ++i) {
+        a.send<AddTag>(1);
+    }
+    system->shutdown();
+
+    EXPECT_EQ(sum, 100);
+    EXPECT_EQ(system->threads(), 0u);
+}
+
+TEST(actor, PendingMessagesAreDestroyed)
+{
+    auto value = std::make_shared<int>(1);
+    {
+        astl::actor_system system{1};
+        system.shutdown();
+        astl::actor a{system};
+        a.send<AddTag>(value);  // no worker left, stays queued
+        EXPECT_EQ(value.use_count(), 2);
+    }
+    EXPECT_EQ(value.use_count(), 1);
+}
+TEST(actor, ExecutorForContinuations)
+{
+    astl::actor_system system{2};
+    astl::actor a{system};
+    int value{0};
+    a.on<AddTag, int>([&value](int const& v){ value += v; });
+
+    astl::promise<int> p{};
+    auto f = p.get_future().then(a, [&value](int v){ value += v; return value; });
+    a.send<AddTag>(1);
+    p.set_value(10);
+    system.wait_idle();
+    ASSERT_TRUE(f.ready());
+    EXPECT_EQ(value, 11);
+}
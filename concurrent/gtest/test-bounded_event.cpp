@@ -0,0 +1,195 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/bounded_event.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct SampleTag{};
+    using SampleEvent = astl::bounded_event<SampleTag, int>;
+}
+
+TEST(bounded_event, DeliversToEveryConsumer)
+{
+    SampleEvent ev{};
+    SampleEvent::consumer c1{ev, 8, astl::overflow_policy::drop_newest};
+    SampleEvent::consumer c2{ev, 8, astl::overflow_policy::drop_newest};
+    ASSERT_EQ(ev.consumers(), 2u);
+    std::vector<int> r1{};
+    std::vector<int> r2{};
+    SampleEvent::slot_type s1{[&r1](int const& v){ r1.push_back(v); }};
+    SampleEvent::slot_type s2{[&r2](int const& v){ r2.push_back(v); }};
+    c1.sig().connect(s1);
+    c2.sig().connect(s2);
+
+    ASSERT_TRUE(ev.invoke(1));
+    ASSERT_TRUE(ev.invoke(2));
+    ASSERT_EQ(c1.metrics().depth, 2u);
+    ASSERT_EQ(c1.dispatch(1), 1u);
+    ASSERT_EQ(c1.dispatch(), 1u);
+    ASSERT_EQ(c2.dispatch(), 2u);
+    ASSERT_EQ(r1, (std::vector<int>{1, 2}));
+    ASSERT_EQ(r2, (std::vector<int>{1, 2}));
+    ASSERT_EQ(c1.metrics().delivered, 2u);
+    ASSERT_EQ(c1.metrics().depth, 0u);
+}
+
+TEST(bounded_event, DropNewest)
+{
+    SampleEvent ev{};
+    SampleEvent::consumer c{ev, 2, astl::overflow_policy::drop_newest};
+    std::vector<int> received{};
+    SampleEvent::slot_type s{[&received](int const& v){ received.push_back(v); }};
+    c.sig().connect(s);
+    ASSERT_TRUE(ev.invoke(1));
+    ASSERT_TRUE(ev.invoke(2));
+    ASSERT_FALSE(ev.invoke(3));
+    c.dispatch();
+    ASSERT_EQ(received, (std::vector<int>{1, 2}));
+    ASSERT_EQ(c.metrics().dropped, 1u);
+}
+
+TEST(bounded_event, DropOldest)
+{
+    SampleEvent ev{};
+    SampleEvent::consumer c{ev, 2, astl::overflow_policy::drop_oldest};
+    std::vector<int> received{};
+    SampleEvent::slot_type s{[&received](int const& v){ received.push_back(v); }};
+    c.sig().connect(s);
+    for (int i = 1; i <= 5; ++i) {
+        ASSERT_TRUE(ev.invoke(i));
+    }
+    c.dispatch();
+    ASSERT_EQ(received, (std::vector<int>{4, 5}));
+    ASSERT_EQ(c.metrics().dropped, 3u);
+}
+
+TEST(bounded_event, Conflate)
+{
+    struct QuoteTag{};
+    using QuoteEvent = astl::bounded_event<QuoteTag, std::string, int>;
+    QuoteEvent ev{};
+    QuoteEvent::consumer c{ev, 2, astl::overflow_policy::conflate,
+                           [](std::string const& symbol, int){ return std::hash<std::string>{}(symbol); }};
+    std::vector<std::pair<std::string, int>> received{};
+    QuoteEvent::slot_type s{[&received](std::string const& symbol, int const& v){ received.emplace_back(symbol, v); }};
+    c.sig().connect(s);
+
+    ev.invoke("a", 1);
+    ev.invoke("b", 1);
+    ev.invoke("a", 2);      // replaces a/1 in place
+    ASSERT_EQ(c.metrics().conflated, 1u);
+    ev.invoke("c", 1);      // full with other keys, drops the oldest
+    ASSERT_EQ(c.metrics().dropped, 1u);
+    c.dispatch();
+    ASSERT_EQ(received, (std::vector<std::pair<std::string, int>>{{"b", 1}, {"c", 1}}));
+
+    received.clear();
+    QuoteEvent::consumer latest{ev, 4, astl::overflow_policy::conflate};
+    latest.sig().connect(s);
+    ev.invoke("x", 1);
+    ev.invoke("y", 2);
+    latest.dispatch();
+    ASSERT_EQ(received, (std::vector<std::pair<std::string, int>>{{"y", 2}}));
+}
+
+TEST(bounded_event, BlockProducer)
+{
+    SampleEvent ev{};
+    SampleEvent::consumer c{ev, 4, astl::overflow_policy::block};
+    std::vector<int> received{};
+    SampleEvent::slot_type s{[&received](int const& v){ received.push_back(v); }};
+    c.sig().connect(s);
+
+    std::thread producer{[&ev](){
+        for (int i = 0; i < 1000; ++i) {
+            ev.invoke(i);
+        }
+    }};
+    while (received.size() < 1000) {
+        ASSERT_LE(c.metrics().depth, 4u);
+        c.wait(std::chrono::milliseconds{10});
+        c.dispatch();
+    }
+    producer.join();
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(received[i], i);
+    }
+    ASSERT_EQ(c.metrics().dropped, 0u);
+}
+
+TEST(bounded_event, DestroyingConsumerReleasesBlockedProducer)
+{
+    SampleEvent ev{};
+    auto c = std::make_unique<SampleEvent::consumer>(ev, 1, astl::overflow_policy::block);
+    ev.invoke(1);
+    std::atomic<bool> returned{false};
+    std::thread producer{[&](){
+        ev.invoke(2);   // blocks on the full queue
+        returned = true;
+    }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    ASSERT_FALSE(returned);
+    c.reset();
+    producer.join();
+    ASSERT_TRUE(returned);
+    ASSERT_EQ(ev.consumers(), 0u);
+}
+
+TEST(bounded_event, ConsumersComeAndGoWhileProducerBlocks)
+{
+    SampleEvent ev{};
+    SampleEvent::consumer c{ev, 1, astl::overflow_policy::block};
+    std::vector<int> received{};
+    SampleEvent::slot_type s{[&received](int const& v){ received.push_back(v); }};
+    c.sig().connect(s);
+    ev.invoke(1);
+    std::atomic<bool> returned{false};
+    std::thread producer{[&](){
+        ev.invoke(2);   // blocks on the full queue
+        returned = true;
+    }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    ASSERT_FALSE(returned);
+
+    // the consumer thread itself creates and destroys a consumer while the producer waits for it
+    {
+        SampleEvent::consumer other{ev, 1, astl::overflow_policy::drop_newest};
+        ASSERT_EQ(ev.consumers(), 2u);
+    }
+    ASSERT_FALSE(returned);
+    while (received.size() < 2) {
+        c.wait(std::chrono::milliseconds{10});
+        c.dispatch();
+    }
+    producer.join();
+    ASSERT_TRUE(returned);
+    ASSERT_EQ(received, (std::vector<int>{1, 2}));
+}
+
+TEST(bounded_event, OldestAge)
+{
+    SampleEvent ev{};
+    SampleEvent::consumer c{ev, 4, astl::overflow_policy::drop_newest};
+    ASSERT_EQ(c.metrics().oldest_age.count(), 0);
+    ev.invoke(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    ev.invoke(2);
+    auto first = c.metrics().oldest_age;
+    ASSERT_GE(first, std::chrono::milliseconds{5});
+    c.dispatch(1);
+    ASSERT_LT(c.metrics().oldest_age, first);    // now the age of the second invocation
+}
@@ -0,0 +1,170 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/sharded_event.h>
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST(sharded_event, SingleThread)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::sharded_event<MyEventTag, int>;
+    MyEvent myEvent{2, 4};
+    std::vector<int> values;
+    MyEvent::slot_type slot{[&values](int const& v){ values.push_back(v); }};
+    myEvent.sig().connect(slot);
+
+    ASSERT_EQ(myEvent.dispatch(), 0u);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(myEvent.invoke(i));
+    }
+    ASSERT_FALSE(myEvent.invoke(4));    // shard full
+    ASSERT_EQ(values.size(), 0u);
+
+    ASSERT_EQ(myEvent.dispatch(3), 3u);
+    ASSERT_EQ(myEvent.dispatch(), 1u);
+    ASSERT_EQ(values, (std::vector<int>{0, 1, 2, 3}));
+    ASSERT_TRUE(myEvent.invoke(5));
+    ASSERT_EQ(myEvent.dispatch(), 1u);
+    ASSERT_EQ(values.back(), 5);
+}
+
+TEST(sharded_event, ManyProducers)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::sharded_event<MyEventTag, int, int>;
+    constexpr int producers{4};
+    constexpr int events{20000};
+    MyEvent myEvent{producers, 256};
+
+    std::vector<int> last(producers, -1);
+    int received{0};
+    bool ordered{true};
+    MyEvent::slot_type slot{[&](int const& producer, int const& seq){
+        ordered = ordered && seq == last[static_cast<std::size_t>(producer)] + 1;
+        last[static_cast<std::size_t>(producer)] = seq;
+        ++received;
+    }};
+    myEvent.sig().connect(slot);
+
+    std::atomic<int> finished{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&myEvent, &finished, p](){
+            for (int i = 0; i < events; ++i) {
+                while (!myEvent.invoke(p, i)) {
+                    std::this_thread::yield();
+                }
+            }
+            ++finished;
+        });
+    }
+    while (finished < producers) {
+        myEvent.dispatch(64);
+    }
+    while (myEvent.dispatch() != 0) {}
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(received, producers * events);
+    ASSERT_TRUE(ordered);
+}
+
+TEST(sharded_event, TimestampOrdering)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::sharded_event<MyEventTag, int>;
+    MyEvent myEvent{4, 16, astl::shard_ordering::timestamp};
+    std::vector<int> values;
+    MyEvent::slot_type slot{[&values](int const& v){ values.push_back(v); }};
+    myEvent.sig().connect(slot);
+
+    // alternate between the main thread and helper threads, each on its own shard
+    for (int i = 0; i < 6; i += 2) {
+        ASSERT_TRUE(myEvent.invoke(i));
+        std::thread{[&myEvent, i](){ myEvent.invoke(i + 1); }}.join();
+    }
+    ASSERT_EQ(myEvent.dispatch(), 6u);
+    ASSERT_EQ(values, (std::vector<int>{0, 1, 2, 3, 4, 5}));
+}
+
+TEST(sharded_event, ProducerKeepsWritingDuringDispatch)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::sharded_event<MyEventTag, int>;
+    for (auto ordering : {astl::shard_ordering::per_shard, astl::shard_ordering::timestamp}) {
+        MyEvent myEvent{2, 4, ordering};
+        std::vector<int> values;
+        // every dispatched event invokes the next one, the dispatcher must still return
+        MyEvent::slot_type slot{[&values, &myEvent](int const& v){
+            values.push_back(v);
+            myEvent.invoke(v + 1);
+        }};
+        myEvent.sig().connect(slot);
+
+        ASSERT_TRUE(myEvent.invoke(0));
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_EQ(myEvent.dispatch(), 1u);
+        }
+        ASSERT_EQ(values.size(), 100u);
+        ASSERT_EQ(values.back(), 99);
+
+        // a producer thread that keeps writing while the dispatcher runs
+        std::atomic<bool> stop{false};
+        std::thread producer{[&myEvent, &stop](){
+            while (!stop.load(std::memory_order_relaxed)) {
+                myEvent.invoke(0);
+            }
+        }};
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_LE(myEvent.dispatch(), 8u);
+        }
+        stop = true;
+        producer.join();
+    }
+}
+
+TEST(sharded_event, ThreadsBeyondShardsShareOne)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::sharded_event<MyEventTag, int, int>;
+    MyEvent myEvent{2, 16};
+    ASSERT_EQ(myEvent.shards(), 2u);
+    std::vector<std::pair<int, int>> received;
+    MyEvent::slot_type slot{[&received](int const& producer, int const& seq){ received.emplace_back(producer, seq); }};
+    myEvent.sig().connect(slot);
+
+    // producers 0 and 1 invoke first and own a shard each, 2 and 3 append to the shared shard
+    std::vector<int> const turns{0, 1, 2, 3, 3, 2, 1, 0};
+    std::atomic<std::size_t> turn{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 4; ++p) {
+        threads.emplace_back([&, p](){
+            for (int seq = 0; seq < 2; ++seq) {
+                while (turns[turn.load()] != p) {
+                    std::this_thread::yield();
+                }
+                myEvent.invoke(p, seq);
+                ++turn;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(myEvent.dispatch(), 8u);
+    ASSERT_EQ(received, (std::vector<std::pair<int, int>>{{0, 0}, {0, 1}, {1, 0}, {1, 1},
+                                                         {2, 0}, {3, 0}, {3, 1}, {2, 1}}));
+}
@@ -0,0 +1,428 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/event.h>
+#include <astl/size_class_pool.h>
+#include <astl/slot_holder.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace astl {
+
+    class actor_system;
+    class actor;
+
+    namespace detail {
+
+        //! Message in the mailbox of an actor, allocated with size_class_pool.
+        struct actor_message
+        {
+            actor_message* next{nullptr};
+            void (*dispatch)(actor& target, actor_message* message) noexcept;     // dispatches and destroys
+            void (*destroy)(actor_message* message) noexcept;
+        };
+
+        //! Handler table entry of an actor.
+        struct actor_inbox_base
+        {
+            virtual ~actor_inbox_base() = default;
+        };
+
+        template<typename TAG, typename...Ts>
+        struct actor_inbox : actor_inbox_base
+        {
+            static char const key;
+            event<TAG, Ts...> event_{};
+        };
+
+        template<typename TAG, typename...Ts>
+        char const actor_inbox<TAG, Ts...>::key{};
+
+        template<typename TAG, typename...Ts>
+        struct typed_actor_message : actor_message
+        {
+            template<typename...Args>
+            explicit typed_actor_message(Args&&...args);
+
+            static void dispatch_message(actor& target, actor_message* message) noexcept;
+            static void destroy_message(actor_message* message) noexcept;
+
+            std::tuple<Ts...> values;
+        };
+
+        template<typename F>
+        struct closure_actor_message : actor_message
+        {
+            explicit closure_actor_message(F f);
+
+            static void dispatch_message(actor& target, actor_message* message) noexcept;
+            static void destroy_message(actor_message* message) noexcept;
+
+            F function;
+        };
+
+    } // namespace detail
+
+    //! Object processing the messages of its mailbox sequentially on one of the worker threads of an actor_system.
+    //! Messages are routed by TAG and data types as with event<TAG, Ts...>: every (TAG, Ts...) combination has an inbox
+    //! signal to which handlers connect like to the signal of an event. Handlers of an actor never run concurrently,
+    //! so the actor's state needs no locking. Handlers have to be connected before messages are sent to the actor.
+    //! An idle actor costs a few pointers and its handler table; memory for messages is only taken while they are
+    //! queued, one node per message from astl::size_class_pool.
+    //! An actor must not be destroyed while it has queued messages or is running; call actor_system::wait_idle() or
+    //! actor_system::shutdown() first.
+    //! \code
+    //! #include <astl/actor.h>
+    //!
+    //! astl::actor_system system{4};
+    //! astl::actor counter{system};
+    //! int count{0};
+    //! counter.on<IncrementTag, int>([&count](int const& n){ count += n; });
+    //! counter.send<IncrementTag>(2);
+    //! system.wait_idle();
+    //! \endcode
+    class actor
+    {
+    public:
+        explicit actor(actor_system& system) noexcept;
+        ~actor() noexcept;
+
+        actor(actor const&) = delete;
+        actor& operator=(actor const&) = delete;
+
+        //! Returns the signal on which messages with TAG and data of types Ts are dispatched.
+        template<typename TAG, typename...Ts>
+        signal<TAG, Ts...>& inbox();
+
+        //! Connects handler f to the inbox of TAG and Ts..., see slot_holder::connect.
+        template<typename TAG, typename...Ts, typename F>
+        bool on(F f, bool replace = false);
+
+        //! Queues a message with TAG and the decayed types of args. May be called by any thread.
+        template<typename TAG, typename...Args>
+        void send(Args&&...args);
+
+        //! Queues f to be run like a handler of the actor, which makes the actor an executor for future::then().
+        template<typename F>
+        void execute(F f);
+
+    private:
+        friend class actor_system;
+        template<typename TAG, typename...Ts> friend struct detail::typed_actor_message;
+
+        void post(detail::actor_message* message) noexcept;
+
+        //! Processes up to quantum messages. \returns true if more messages are queued.
+        bool run(std::size_t quantum) noexcept;
+
+        template<typename TAG, typename...Ts>
+        detail::actor_inbox<TAG, Ts...>* find_inbox() noexcept;
+
+    private:
+        actor_system& system_;
+        std::atomic<detail::actor_message*> mailbox_{nullptr};  // LIFO stack pushed by senders
+        detail::actor_message* queue_{nullptr};                 // FIFO list taken from the mailbox by the worker
+        std::atomic<bool> scheduled_{false};
+        std::vector<std::pair<void const*, std::unique_ptr<detail::actor_inbox_base>>> inboxes_{};
+        slot_holder handlers_{};
+    };
+
+    //! Worker threads multiplexing the actors with queued messages.
+    //! An actor with messages is queued in a run queue; a worker takes it, processes up to quantum messages in a row
+    //! (keeping the actor's state in cache) and puts it back to the end of the run queue if it has more messages.
+    class actor_system
+    {
+    public:
+        //! \param threads  Number of worker threads.
+        //! \param quantum  Maximum number of messages an actor processes before other actors are run.
+        explicit actor_system(std::size_t threads = std::thread::hardware_concurrency(), std::size_t quantum = 64);
+        ~actor_system() noexcept;
+
+        actor_system(actor_system const&) = delete;
+        actor_system& operator=(actor_system const&) = delete;
+
+        //! Blocks until no actor has queued messages.
+        void wait_idle() noexcept;
+
+        //! Processes all queued messages and stops the worker threads.
+        void shutdown() noexcept;
+
+        [[nodiscard]] std::size_t threads() const noexcept;
+
+    private:
+        friend class actor;
+
+        void schedule(actor& a) noexcept;
+        void worker() noexcept;
+
+    private:
+        std::size_t quantum_;
+        std::mutex mutex_{};
+        std::condition_variable work_{};
+        std::condition_variable idle_{};
+        std::deque<actor*> run_queue_{};
+        std::size_t active_{0};     // scheduled actors, queued or running
+        bool stop_{false};
+        std::vector<std::thread> workers_{};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl typed_actor_message
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts>
+    template<typename...Args>
+    astl::detail::typed_actor_message<TAG, Ts...>::typed_actor_message(Args&&...args)
+        : actor_message{nullptr, &dispatch_message, &destroy_message}
+        , values{std::forward<Args>(args)...}
+{}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::detail::typed_actor_message<TAG, Ts...>::dispatch_message(actor& target, actor_message* message) noexcept
+{
+    auto m = static_cast<typed_actor_message*>(message);
+    if (auto inbox = target.find_inbox<TAG, Ts...>()) {
+        std::apply([inbox](Ts const&...values){ inbox->event_.invoke(values...); }, m->values);
+    }
+    destroy_message(message);
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::detail::typed_actor_message<TAG, Ts...>::destroy_message(actor_message* message) noexcept
+{
+    auto m = static_cast<typed_actor_message*>(message);
+    m->~typed_actor_message();
+    size_class_pool::deallocate(m, sizeof(typed_actor_message), alignof(typed_actor_message));
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl closure_actor_message
+// ------------------------------------------------------------------------------------------------
+template<typename F>
+    astl::detail::closure_actor_message<F>::closure_actor_message(F f)
+        : actor_message{nullptr, &dispatch_message, &destroy_message}
+        , function{std::move(f)}
+{}
+
+template<typename F>
+    void
+    astl::detail::closure_actor_message<F>::dispatch_message(actor&, actor_message* message) noexcept
+{
+    static_cast<closure_actor_message*>(message)->function();
+    destroy_message(message);
+}
+
+template<typename F>
+    void
+    astl::detail::closure_actor_message<F>::destroy_message(actor_message* message) noexcept
+{
+    auto m = static_cast<closure_actor_message*>(message);
+    m->~closure_actor_message();
+    size_class_pool::deallocate(m, sizeof(closure_actor_message), alignof(closure_actor_message));
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl actor
+// ------------------------------------------------------------------------------------------------
+inline astl::actor::actor(actor_system& system) noexcept
+    : system_{system}
+{}
+
+inline astl::actor::~actor() noexcept
+{
+    auto destroy = [](detail::actor_message* m){
+        while (m) {
+            auto next = m->next;
+            m->destroy(m);
+            m = next;
+        }
+    };
+    destroy(queue_);
+    destroy(mailbox_.exchange(nullptr, std::memory_order_acquire));
+}
+
+template<typename TAG, typename...Ts>
+    astl::signal<TAG, Ts...>&
+    astl::actor::inbox()
+{
+    if (auto inbox = find_inbox<TAG, Ts...>()) {
+        return inbox->event_.sig();
+    }
+    auto inbox = std::make_unique<detail::actor_inbox<TAG, Ts...>>();
+    auto& sig = inbox->event_.sig();
+    inboxes_.emplace_back(&detail::actor_inbox<TAG, Ts...>::key, std::move(inbox));
+    return sig;
+}
+
+template<typename TAG, typename...Ts, typename F>
+    bool
+    astl::actor::on(F f, bool replace)
+{
+    return handlers_.connect(inbox<TAG, Ts...>(), std::move(f), replace);
+}
+
+template<typename TAG, typename...Args>
+    void
+    astl::actor::send(Args&&...args)
+{
+    using message_type = detail::typed_actor_message<TAG, std::decay_t<Args>...>;
+    auto p = size_class_pool::allocate(sizeof(message_type), alignof(message_type));
+    post(new (p) message_type{std::forward<Args>(args)...});
+}
+
+template<typename F>
+    void
+    astl::actor::execute(F f)
+{
+    using message_type = detail::closure_actor_message<F>;
+    auto p = size_class_pool::allocate(sizeof(message_type), alignof(message_type));
+    post(new (p) message_type{std::move(f)});
+}
+
+inline void astl::actor::post(detail::actor_message* message) noexcept
+{
+    auto head = mailbox_.load(std::memory_order_relaxed);
+    do {
+        message->next = head;
+    } while (!mailbox_.compare_exchange_weak(head, message, std::memory_order_release, std::memory_order_relaxed));
+    if (!scheduled_.exchange(true, std::memory_order_acq_rel)) {
+        system_.schedule(*this);
+    }
+}
+
+inline bool astl::actor::run(std::size_t quantum) noexcept
+{
+    for (std::size_t n = 0; n < quantum; ++n) {
+        if (!queue_) {
+            // the mailbox is a LIFO stack, reverse it into the FIFO queue
+            auto m = mailbox_.exchange(nullptr, std::memory_order_acquire);
+            while (m) {
+                auto next = m->next;
+                m->next = queue_;
+                queue_ = m;
+                m = next;
+            }
+            if (!queue_) {
+                break;
+            }
+        }
+        auto m = queue_;
+        queue_ = m->next;
+        m->dispatch(*this, m);
+    }
+    return queue_ || mailbox_.load(std::memory_order_acquire);
+}
+
+template<typename TAG, typename...Ts>
+    astl::detail::actor_inbox<TAG, Ts...>*
+    astl::actor::find_inbox() noexcept
+{
+    for (auto& [key, inbox] : inboxes_) {
+        if (key == &detail::actor_inbox<TAG, Ts...>::key) {
+            return static_cast<detail::actor_inbox<TAG, Ts...>*>(inbox.get());
+        }
+    }
+    return nullptr;
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl actor_system
+// ------------------------------------------------------------------------------------------------
+inline astl::actor_system::actor_system(std::size_t threads, std::size_t quantum)
+    : quantum_{quantum ? quantum : 1}
+{
+    for (std::size_t i = 0; i < (threads ? threads : 1); ++i) {
+        workers_.emplace_back([this](){ worker(); });
+    }
+}
+
+inline astl::actor_system::~actor_system() noexcept
+{
+    shutdown();
+}
+
+inline void astl::actor_system::wait_idle() noexcept
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+    idle_.wait(lock, [this](){ return active_ == 0; });
+}
+
+inline void astl::actor_system::shutdown() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stop_ = true;
+    }
+    work_.notify_all();
+    for (auto& w : workers_) {
+        w.join();
+    }
+    workers_.clear();
+}
+
+inline std::size_t astl::actor_system::threads() const noexcept
+{
+    return workers_.size();
+}
+
+inline void astl::actor_system::schedule(actor& a) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        run_queue_.push_back(&a);
+        ++active_;
+    }
+    work_.notify_one();
+}
+
+inline void astl::actor_system::worker() noexcept
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (true) {
+        work_.wait(lock, [this](){ return stop_ || !run_queue_.empty(); });
+        if (run_queue_.empty()) {
+            return; // stopped and drained
+        }
+        auto a = run_queue_.front();
+        run_queue_.pop_front();
+        lock.unlock();
+
+        auto more = a->run(quantum_);
+        if (!more) {
+            a->scheduled_.store(false, std::memory_order_seq_cst);
+            // a sender may have pushed after run() looked at the mailbox but before scheduled_ was cleared
+            more = a->mailbox_.load(std::memory_order_seq_cst) && !a->scheduled_.exchange(true);
+        }
+
+        lock.lock();
+        if (more) {
+            run_queue_.push_back(a);
+        }
+        else if (--active_ == 0) {
+            idle_.notify_all();
+        }
+    }
+}
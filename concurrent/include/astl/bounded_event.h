@@ -0,0 +1,406 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/event.h>
+#include <astl/small_vector.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
+#include <vector>
+
+namespace astl {
+
+    //! What a bounded_event consumer does with an invocation when its queue is full.
+    enum class overflow_policy {
+        block,          //!< the producer waits until the consumer has made room
+        drop_oldest,    //!< the oldest queued invocation is dropped
+        drop_newest,    //!< the new invocation is dropped
+        conflate,       //!< a queued invocation with the same key is replaced, otherwise the oldest is dropped
+    };
+
+    //! Lag of a bounded_event consumer.
+    struct consumer_metrics
+    {
+        std::size_t depth{0};                       //!< queued invocations
+        std::uint64_t delivered{0};                 //!< invocations dispatched to the slots
+        std::uint64_t dropped{0};                   //!< invocations dropped because the queue was full
+        std::uint64_t conflated{0};                 //!< queued invocations replaced by one with the same key
+        std::chrono::nanoseconds oldest_age{0};     //!< time the oldest queued invocation has been waiting
+    };
+
+    //! Event delivering its invocations to consumers on other threads through bounded queues.
+    //! Every consumer owns a queue of fixed capacity, allocated when the consumer is created, and its own signal. An
+    //! invocation is queued to all consumers; a full queue applies the overflow_policy of its consumer, so memory stays
+    //! flat however far a consumer falls behind. The consumer thread calls consumer::dispatch() to deliver the queued
+    //! invocations to the slots of the consumer's signal. consumer::metrics() reads the lag without taking a lock.
+    //! \code
+    //! #include <astl/bounded_event.h>
+    //!
+    //! astl::bounded_event<QuoteTag, std::string, double> quotes{};
+    //! // consumer thread, keeps only the latest quote per symbol
+    //! decltype(quotes)::consumer gui{quotes, 256, astl::overflow_policy::conflate,
+    //!                                [](std::string const& symbol, double){ return std::hash<std::string>{}(symbol); }};
+    //! gui.sig().connect(slot);
+    //! while (running) {
+    //!     gui.wait(std::chrono::milliseconds{100});
+    //!     gui.dispatch();
+    //! }
+    //! // producer threads
+    //! quotes.invoke("ACME", 12.5);
+    //! \endcode
+    //!
+    //! \tparam Ts      Types of data associated with an event. Must be default constructible and move assignable.
+    //! \tparam TAG     Tagging type to distinguish events using the same data type T.
+    template<typename TAG, typename...Ts>
+    class bounded_event
+    {
+    public:
+        using value_type = std::tuple<Ts...>;
+        using signal_type = signal<TAG, Ts...>;
+        using slot_type = slot<TAG, Ts...>;
+        using key_function = std::function<std::size_t(Ts const&...)>;
+
+        class consumer;
+
+        explicit bounded_event() = default;
+        ~bounded_event() noexcept;
+
+        bounded_event(bounded_event const&) = delete;
+        bounded_event& operator=(bounded_event const&) = delete;
+
+        //! Queues the invocation to all consumers. May be called by any thread.
+        //! \returns false if a consumer dropped this invocation.
+        template<typename...Args>
+        bool invoke(Args&&...args) noexcept;
+
+        //! Returns the number of consumers.
+        [[nodiscard]] std::size_t consumers() const noexcept;
+
+    private:
+        mutable std::shared_mutex mutex_{};
+        std::vector<consumer*> consumers_{};
+    };
+
+    //! Consumer of a bounded_event. Created, dispatched and destroyed by the consumer thread.
+    template<typename TAG, typename...Ts>
+    class bounded_event<TAG, Ts...>::consumer
+    {
+    public:
+        //! \param ev       The event to consume.
+        //! \param capacity Number of invocations the queue holds.
+        //! \param policy   What to do with invocations when the queue is full.
+        //! \param key      Key of an invocation for overflow_policy::conflate. Without a key function all invocations
+        //!                 have the same key, i.e. only the latest one is kept.
+        consumer(bounded_event& ev, std::size_t capacity, overflow_policy policy, key_function key = {});
+        ~consumer() noexcept;
+
+        consumer(consumer const&) = delete;
+        consumer& operator=(consumer const&) = delete;
+
+        //! Returns the signal on which the queued invocations are dispatched.
+        signal_type& sig() noexcept;
+
+        //! Dispatches up to max queued invocations to the slots. \returns the number of dispatched invocations.
+        std::size_t dispatch(std::size_t max = std::numeric_limits<std::size_t>::max()) noexcept;
+
+        //! Waits until an invocation is queued or timeout has passed. \returns true if the queue is not empty.
+        bool wait(std::chrono::nanoseconds timeout) noexcept;
+
+        //! Returns the lag of the consumer, may be called by any thread.
+        [[nodiscard]] consumer_metrics metrics() const noexcept;
+
+    private:
+        friend class bounded_event;
+
+        struct entry
+        {
+            value_type value{};
+            std::int64_t timestamp{0};
+            std::size_t key{0};
+        };
+
+        //! \returns false if value has been dropped.
+        bool push(value_type const& value, std::int64_t timestamp) noexcept;
+        void pin() noexcept;
+        void unpin() noexcept;
+        void close() noexcept;
+        void drop_front() noexcept;
+        void update_oldest() noexcept;
+        static std::int64_t now() noexcept;
+
+    private:
+        bounded_event& event_owner_;
+        event<TAG, Ts...> event_{};
+        overflow_policy policy_;
+        key_function key_;
+        std::unique_ptr<entry[]> ring_;
+        std::size_t capacity_;
+        std::size_t head_{0};
+        std::size_t size_{0};
+        bool closed_{false};
+        std::size_t pins_{0};                       // producers pushing without the event lock
+        std::mutex mutex_{};
+        std::condition_variable not_empty_{};
+        std::condition_variable not_full_{};
+        std::condition_variable unpinned_{};
+
+        std::atomic<std::size_t> depth_{0};
+        std::atomic<std::uint64_t> delivered_{0};
+        std::atomic<std::uint64_t> dropped_{0};
+        std::atomic<std::uint64_t> conflated_{0};
+        std::atomic<std::int64_t> oldest_{0};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl bounded_event
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts>
+    astl::bounded_event<TAG, Ts...>::~bounded_event() noexcept
+{
+    assert(consumers_.empty());
+}
+
+template<typename TAG, typename...Ts>
+    template<typename...Args>
+    bool
+    astl::bounded_event<TAG, Ts...>::invoke(Args&&...args) noexcept
+{
+    value_type value{std::forward<Args>(args)...};
+    auto timestamp = consumer::now();
+    auto queued = true;
+    // a producer may block in push(), it must not hold the event lock that consumers take to come and go
+    small_vector<consumer*, 8> consumers{};
+    {
+        std::shared_lock<std::shared_mutex> lock{mutex_};
+        for (auto c : consumers_) {
+            c->pin();
+            consumers.push_back(c);
+        }
+    }
+    for (auto c : consumers) {
+        queued = c->push(value, timestamp) && queued;
+        c->unpin();
+    }
+    return queued;
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::bounded_event<TAG, Ts...>::consumers() const noexcept
+{
+    std::shared_lock<std::shared_mutex> lock{mutex_};
+    return consumers_.size();
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl bounded_event::consumer
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts>
+    astl::bounded_event<TAG, Ts...>::consumer::consumer(bounded_event& ev, std::size_t capacity,
+                                                         overflow_policy policy, key_function key)
+        : event_owner_{ev}
+        , policy_{policy}
+        , key_{std::move(key)}
+        , ring_{std::make_unique<entry[]>(capacity ? capacity : 1)}
+        , capacity_{capacity ? capacity : 1}
+{
+    std::unique_lock<std::shared_mutex> lock{ev.mutex_};
+    ev.consumers_.push_back(this);
+}
+
+template<typename TAG, typename...Ts>
+    astl::bounded_event<TAG, Ts...>::consumer::~consumer() noexcept
+{
+    // release producers blocked on this consumer before waiting for them
+    close();
+    {
+        std::unique_lock<std::shared_mutex> lock{event_owner_.mutex_};
+        auto& consumers = event_owner_.consumers_;
+        consumers.erase(std::remove(consumers.begin(), consumers.end(), this), consumers.end());
+    }
+    std::unique_lock<std::mutex> lock{mutex_};
+    unpinned_.wait(lock, [this](){ return pins_ == 0; });
+}
+
+template<typename TAG, typename...Ts>
+    typename astl::bounded_event<TAG, Ts...>::signal_type&
+    astl::bounded_event<TAG, Ts...>::consumer::sig() noexcept
+{
+    return event_.sig();
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::bounded_event<TAG, Ts...>::consumer::dispatch(std::size_t max) noexcept
+{
+    std::size_t count{0};
+    value_type value{};
+    while (count < max) {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (size_ == 0) {
+                break;
+            }
+            value = std::move(ring_[head_].value);
+            drop_front();
+        }
+        if (policy_ == overflow_policy::block) {
+            not_full_.notify_one();
+        }
+        std::apply([this](Ts const&...args){ this->event_.invoke(args...); }, value);
+        delivered_.fetch_add(1, std::memory_order_relaxed);
+        ++count;
+    }
+    return count;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::bounded_event<TAG, Ts...>::consumer::wait(std::chrono::nanoseconds timeout) noexcept
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+    return not_empty_.wait_for(lock, timeout, [this](){ return size_ > 0; });
+}
+
+template<typename TAG, typename...Ts>
+    astl::consumer_metrics
+    astl::bounded_event<TAG, Ts...>::consumer::metrics() const noexcept
+{
+    consumer_metrics m{};
+    m.depth = depth_.load(std::memory_order_relaxed);
+    m.delivered = delivered_.load(std::memory_order_relaxed);
+    m.dropped = dropped_.load(std::memory_order_relaxed);
+    m.conflated = conflated_.load(std::memory_order_relaxed);
+    if (m.depth > 0) {
+        auto oldest = oldest_.load(std::memory_order_relaxed);
+        m.oldest_age = std::chrono::nanoseconds{std::max<std::int64_t>(now() - oldest, 0)};
+    }
+    return m;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::bounded_event<TAG, Ts...>::consumer::push(value_type const& value, std::int64_t timestamp) noexcept
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+    std::size_t key{0};
+    if (policy_ == overflow_policy::conflate) {
+        key = key_ ? std::apply(key_, value) : 0;
+        // newest first, a key is queued at most once
+        for (std::size_t n = size_; n > 0; --n) {
+            auto& e = ring_[(head_ + n - 1) % capacity_];
+            if (e.key == key) {
+                e.value = value;
+                conflated_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    if (size_ == capacity_) {
+        switch (policy_) {
+            case overflow_policy::block:
+                not_full_.wait(lock, [this](){ return size_ < capacity_ || closed_; });
+                if (closed_) {
+                    return false;
+                }
+                break;
+            case overflow_policy::drop_newest:
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            case overflow_policy::drop_oldest:
+            case overflow_policy::conflate:
+                drop_front();
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                break;
+        }
+    }
+    auto& e = ring_[(head_ + size_) % capacity_];
+    e.value = value;
+    e.timestamp = timestamp;
+    e.key = key;
+    ++size_;
+    depth_.store(size_, std::memory_order_relaxed);
+    update_oldest();
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::bounded_event<TAG, Ts...>::consumer::pin() noexcept
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    ++pins_;
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::bounded_event<TAG, Ts...>::consumer::unpin() noexcept
+{
+    // notified under the lock, the destructor may return as soon as it is released
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (--pins_ == 0 && closed_) {
+        unpinned_.notify_all();
+    }
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::bounded_event<TAG, Ts...>::consumer::close() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        closed_ = true;
+    }
+    not_full_.notify_all();
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::bounded_event<TAG, Ts...>::consumer::drop_front() noexcept
+{
+    head_ = (head_ + 1) % capacity_;
+    --size_;
+    depth_.store(size_, std::memory_order_relaxed);
+    update_oldest();
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::bounded_event<TAG, Ts...>::consumer::update_oldest() noexcept
+{
+    if (size_ > 0) {
+        oldest_.store(ring_[head_].timestamp, std::memory_order_relaxed);
+    }
+}
+
+template<typename TAG, typename...Ts>
+    std::int64_t
+    astl::bounded_event<TAG, Ts...>::consumer::now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,319 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/event.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <tuple>
+
+namespace astl {
+
+    //! Order in which sharded_event::dispatch delivers the events of different shards.
+    enum class shard_ordering {
+        per_shard,  //!< events of one shard in their order, shards one after another
+        timestamp,  //!< events of all shards merged by the time of their invocation
+    };
+
+    //! Event that can be invoked by many threads concurrently and is dispatched on one thread.
+    //! Each producer thread appends to its own shard - a ring buffer on its own cache lines - so producers do not
+    //! contend with each other. A single dispatcher thread drains the shards in batches and dispatches the events to
+    //! the slots of the signal as astl::event does.
+    //! The first threads invoking the event own a shard each and append to it without any lock or read-modify-write
+    //! (single producer, single consumer). Threads beyond the number of shards share one additional shard and
+    //! serialize on its spin lock. A thread keeps its shard for the lifetime of the event.
+    //! Events of one producer thread are always dispatched in their invocation order.
+    //! \code
+    //! #include <astl/sharded_event.h>
+    //!
+    //! astl::sharded_event<SampleTag, int> ev{8, 4096};
+    //! // producer threads
+    //! ev.invoke(42);
+    //! // dispatcher thread
+    //! while (running) {
+    //!     ev.dispatch();
+    //! }
+    //! \endcode
+    //!
+    //! \tparam Ts      Types of data associated with an event. Must be default constructible and move assignable.
+    //! \tparam TAG     Tagging type to distinguish events using the same data type T.
+    template<typename TAG, typename...Ts>
+    class sharded_event
+    {
+    public:
+        using value_type = std::tuple<Ts...>;
+        using signal_type = signal<TAG, Ts...>;
+        using slot_type = slot<TAG, Ts...>;
+
+        //! \param shards           Number of shards owned by a producer thread, should be the number of producer threads.
+        //! \param shard_capacity   Number of events a shard can buffer, rounded up to a power of two.
+        //! \param ordering         Order of the dispatched events across shards.
+        explicit sharded_event(std::size_t shards = std::thread::hardware_concurrency(),
+                               std::size_t shard_capacity = 1024,
+                               shard_ordering ordering = shard_ordering::per_shard);
+        ~sharded_event() = default;
+
+        sharded_event(sharded_event const&) = delete;
+        sharded_event& operator=(sharded_event const&) = delete;
+
+        //! Returns a reference to the signal associated with the event.
+        signal_type& sig() noexcept;
+
+        //! Appends an event to the shard of the calling thread. May be called by any thread.
+        //! \returns false if the shard is full and the event has been dropped.
+        template<typename...Args>
+        bool invoke(Args&&...args) noexcept;
+
+        //! Dispatches the events buffered when it is called to the slots, events invoked meanwhile are left to the
+        //! next call. Must only be called by one thread at a time.
+        //! \param batch    Maximum number of events taken from one shard in one pass over the shards.
+        //! \returns the number of dispatched events.
+        std::size_t dispatch(std::size_t batch = std::numeric_limits<std::size_t>::max()) noexcept;
+
+        //! Returns the number of shards owned by a producer thread, without the shared one.
+        [[nodiscard]] std::size_t shards() const noexcept;
+
+    private:
+        struct entry
+        {
+            value_type value{};
+            std::int64_t timestamp{0};
+        };
+
+        struct alignas(64) shard
+        {
+            alignas(64) std::atomic<std::size_t> tail{0};   // written by producers
+            std::atomic<std::size_t> owner{0};              // 1 + thread_index() of the owning producer, 0 if free
+            std::atomic_flag lock = ATOMIC_FLAG_INIT;       // taken by the producers of the shared shard only
+            std::size_t head_cache{0};
+            alignas(64) std::atomic<std::size_t> head{0};   // written by the dispatcher
+            std::size_t tail_cache{0};                      // tail when dispatch() started
+            std::unique_ptr<entry[]> ring{};
+        };
+
+        static std::size_t thread_index() noexcept;
+        static std::uint64_t next_id() noexcept;
+        static std::int64_t now() noexcept;
+
+        std::size_t producer_shard() noexcept;
+
+        std::size_t dispatch_per_shard(std::size_t batch) noexcept;
+        std::size_t dispatch_by_timestamp(std::size_t batch) noexcept;
+        bool available(shard& s) noexcept;
+        void dispatch_front(shard& s) noexcept;
+
+    private:
+        event<TAG, Ts...> event_{};
+        std::unique_ptr<shard[]> shards_;               // shard_count_ owned shards followed by the shared one
+        std::size_t shard_count_;
+        std::uint64_t id_;                              // distinguishes events in the shard cache of a thread
+        std::size_t mask_{0};
+        shard_ordering ordering_;
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl sharded_event
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts>
+    astl::sharded_event<TAG, Ts...>::sharded_event(std::size_t shards, std::size_t shard_capacity,
+                                                   shard_ordering ordering)
+        : shards_{std::make_unique<shard[]>((shards ? shards : 1) + 1)}
+        , shard_count_{shards ? shards : 1}
+        , id_{next_id()}
+        , ordering_{ordering}
+{
+    std::size_t capacity{1};
+    while (capacity < shard_capacity) {
+        capacity <<= 1u;
+    }
+    mask_ = capacity - 1;
+    for (std::size_t i = 0; i <= shard_count_; ++i) {
+        shards_[i].ring = std::make_unique<entry[]>(capacity);
+    }
+}
+
+template<typename TAG, typename...Ts>
+    typename astl::sharded_event<TAG, Ts...>::signal_type&
+    astl::sharded_event<TAG, Ts...>::sig() noexcept
+{
+    return event_.sig();
+}
+
+template<typename TAG, typename...Ts>
+    template<typename...Args>
+    bool
+    astl::sharded_event<TAG, Ts...>::invoke(Args&&...args) noexcept
+{
+    auto const index = producer_shard();
+    auto& s = shards_[index];
+    auto const shared = index == shard_count_;
+    while (shared && s.lock.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    auto tail = s.tail.load(std::memory_order_relaxed);
+    if (tail - s.head_cache > mask_) {
+        s.head_cache = s.head.load(std::memory_order_acquire);
+        if (tail - s.head_cache > mask_) {
+            if (shared) {
+                s.lock.clear(std::memory_order_release);
+            }
+            return false;
+        }
+    }
+    auto& e = s.ring[tail & mask_];
+    e.value = value_type{std::forward<Args>(args)...};
+    if (ordering_ == shard_ordering::timestamp) {
+        e.timestamp = now();
+    }
+    s.tail.store(tail + 1, std::memory_order_release);
+    if (shared) {
+        s.lock.clear(std::memory_order_release);
+    }
+    return true;
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::sharded_event<TAG, Ts...>::dispatch(std::size_t batch) noexcept
+{
+    if (batch == 0) {
+        return 0;
+    }
+    // only the events buffered now, a producer that keeps invoking must not keep the dispatcher in here
+    for (std::size_t i = 0; i <= shard_count_; ++i) {
+        shards_[i].tail_cache = shards_[i].tail.load(std::memory_order_acquire);
+    }
+    return ordering_ == shard_ordering::per_shard ? dispatch_per_shard(batch) : dispatch_by_timestamp(batch);
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::sharded_event<TAG, Ts...>::shards() const noexcept
+{
+    return shard_count_;
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::sharded_event<TAG, Ts...>::thread_index() noexcept
+{
+    static std::atomic<std::size_t> next{0};
+    static thread_local std::size_t const index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+template<typename TAG, typename...Ts>
+    std::uint64_t
+    astl::sharded_event<TAG, Ts...>::next_id() noexcept
+{
+    static std::atomic<std::uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::sharded_event<TAG, Ts...>::producer_shard() noexcept
+{
+    struct cached_shard
+    {
+        std::uint64_t event{0};
+        std::size_t index{0};
+    };
+    static thread_local cached_shard cache{};
+    if (cache.event == id_) {
+        return cache.index;
+    }
+    // the shard owned by this thread, else a free one to own, else the shared one
+    auto const self = thread_index() + 1;
+    auto index = shard_count_;
+    for (std::size_t i = 0; i < shard_count_ && index == shard_count_; ++i) {
+        if (shards_[i].owner.load(std::memory_order_relaxed) == self) {
+            index = i;
+        }
+    }
+    for (std::size_t i = 0; i < shard_count_ && index == shard_count_; ++i) {
+        std::size_t free{0};
+        if (shards_[i].owner.compare_exchange_strong(free, self, std::memory_order_relaxed)) {
+            index = i;
+        }
+    }
+    cache = cached_shard{id_, index};
+    return index;
+}
+
+template<typename TAG, typename...Ts>
+    std::int64_t
+    astl::sharded_event<TAG, Ts...>::now() noexcept
+{
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::sharded_event<TAG, Ts...>::dispatch_per_shard(std::size_t batch) noexcept
+{
+    std::size_t count{0};
+    for (std::size_t i = 0; i <= shard_count_; ++i) {
+        auto& s = shards_[i];
+        for (std::size_t n = 0; n < batch && available(s); ++n, ++count) {
+            dispatch_front(s);
+        }
+    }
+    return count;
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::sharded_event<TAG, Ts...>::dispatch_by_timestamp(std::size_t batch) noexcept
+{
+    std::size_t count{0};
+    while (count < batch) {
+        shard* oldest{nullptr};
+        for (std::size_t i = 0; i <= shard_count_; ++i) {
+            auto& s = shards_[i];
+            if (available(s) && (!oldest || s.ring[s.head.load(std::memory_order_relaxed) & mask_].timestamp
+                                            < oldest->ring[oldest->head.load(std::memory_order_relaxed) & mask_].timestamp)) {
+                oldest = &s;
+            }
+        }
+        if (!oldest) {
+            break;
+        }
+        dispatch_front(*oldest);
+        ++count;
+    }
+    return count;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::sharded_event<TAG, Ts...>::available(shard& s) noexcept
+{
+    return s.head.load(std::memory_order_relaxed) != s.tail_cache;
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::sharded_event<TAG, Ts...>::dispatch_front(shard& s) noexcept
+{
+    auto head = s.head.load(std::memory_order_relaxed);
+    auto& e = s.ring[head & mask_];
+    std::apply([this](Ts const&...args){ this->event_.invoke(args...); }, e.value);
+    s.head.store(head + 1, std::memory_order_release);
+}
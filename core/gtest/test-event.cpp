@@ -11,8 +11,10 @@
 // If not, see <http://www.gnu.org/licenses/>.
 #include <gtest/gtest.h>
 #include <astl/event.h>
+#include <astl/testsupport/alloc_counter.h>
 
 #include <string>
+#include <vector>
 
 TEST(event, NoSlot)
 {
@@ -219,3 +221,246 @@ TEST(event, VoidData)
     myEvent.invoke();
     ASSERT_EQ(count, 2);
 }
+
+TEST(event, CompactFootprint)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::event<MyEventTag, int>;
+    static_assert(sizeof(MyEvent) == sizeof(void*));
+
+    int sum{0};
+    MyEvent myEvent;
+    MyEvent::slot_type slot1([&sum](int const& v){sum += v;});
+    MyEvent::slot_type slot2([&sum](int const& v){sum += 10 * v;});
+    MyEvent::slot_type slot3([&sum](int const& v){sum += 100 * v;});
+
+    // single slot -> slot table -> single slot -> no slot
+    myEvent.sig().connect(slot1);
+    myEvent.sig().connect(slot2);
+    myEvent.sig().connect(slot3);
+    myEvent.invoke(1);
+    ASSERT_EQ(sum, 111);
+
+    slot1.disconnect();
+    slot3.disconnect();
+    myEvent.invoke(1);
+    ASSERT_EQ(sum, 121);
+
+    myEvent.sig().connect(slot1);
+    myEvent.invoke(1);
+    ASSERT_EQ(sum, 132);
+
+    slot1.disconnect();
+    slot2.disconnect();
+    myEvent.invoke(1);
+    ASSERT_EQ(sum, 132);
+    ASSERT_FALSE(slot2.is_connected());
+}
+
+TEST(event, DisconnectOthersWhileDispatching)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::event<MyEventTag>;
+    int count{0};
+
+    MyEvent myEvent;
+    MyEvent::slot_type slot2([&count](){++count;});
+    MyEvent::slot_type slot3([&count](){++count;});
+    MyEvent::slot_type slot1([&count, &slot1, &slot2, &slot3](){
+        ++count;
+        slot1.disconnect();
+        slot2.disconnect();
+        slot3.disconnect();
+    });
+    myEvent.sig().connect(slot1);
+    myEvent.sig().connect(slot2);
+    myEvent.sig().connect(slot3);
+
+    myEvent.invoke();
+    ASSERT_EQ(count, 1);
+    ASSERT_FALSE(slot2.is_connected());
+
+    myEvent.sig().connect(slot3);
+    myEvent.invoke();
+    ASSERT_EQ(count, 2);
+}
+
+TEST(event, NoAllocationHotPaths)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::event<MyEventTag, int>;
+    int sum{0};
+    MyEvent myEvent;
+    MyEvent::slot_type slot1([&sum](int const& v){sum += v;});
+    MyEvent::slot_type slot2([&sum](int const& v){sum += v;});
+
+    ASTL_EXPECT_NO_ALLOC {
+        myEvent.invoke(1);
+        myEvent.sig().connect(slot1);
+        myEvent.invoke(1);
+    }
+    ASTL_EXPECT_ALLOCS(1) { myEvent.sig().connect(slot2); }  // slot table with inline storage
+    ASTL_EXPECT_NO_ALLOC {
+        myEvent.invoke(1);
+        slot2.disconnect();
+        slot1.disconnect();
+        myEvent.invoke(1);
+    }
+    ASSERT_EQ(sum, 3);
+}
+
+TEST(event, PriorityOrder)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::event<MyEventTag, int>;
+    MyEvent myEvent;
+    std::vector<int> order{};
+    MyEvent::slot_type low([&order](int const&){ order.push_back(0); });
+    MyEvent::slot_type high([&order](int const&){ order.push_back(10); });
+    MyEvent::slot_type mid1([&order](int const&){ order.push_back(5); });
+    MyEvent::slot_type mid2([&order](int const&){ order.push_back(6); });
+    myEvent.sig().connect(low);
+    myEvent.sig().connect(mid1, 5);
+    myEvent.sig().connect(high, 10);
+    myEvent.sig().connect(mid2, 5);     // equal priorities keep connection order
+
+    myEvent.invoke(0);
+    ASSERT_EQ(order, (std::vector<int>{10, 5, 6, 0}));
+
+    order.clear();
+    myEvent.sig().connect(low, 20);     // reconnecting changes the priority
+    myEvent.invoke(0);
+    ASSERT_EQ(order, (std::vector<int>{0, 10, 5, 6}));
+}
+
+TEST(event, ConsumedStopsDispatch)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::event<MyEventTag, int>;
+    MyEvent myEvent;
+    int fallbacks{0};
+    MyEvent::slot_type filter([](int const& key){
+        return key < 0 ? astl::slot_result::consumed : astl::slot_result::proceed;
+    });
+    MyEvent::slot_type fallback([&fallbacks](int const&){ ++fallbacks; });
+    myEvent.sig().connect(fallback);
+    myEvent.sig().connect(filter, 1);
+
+    ASSERT_TRUE(myEvent.invoke(-1));
+    ASSERT_EQ(fallbacks, 0);
+    ASSERT_FALSE(myEvent.invoke(1));
+    ASSERT_EQ(fallbacks, 1);
+
+    filter.disconnect();
+    ASSERT_FALSE(myEvent.invoke(-1));
+    ASSERT_EQ(fallbacks, 2);
+}
+
+TEST(event, VoidFunctorAndEmptyHandlers)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::event<MyEventTag, int>;
+    MyEvent myEvent;
+    int sum{0};
+    MyEvent::slot_type::functor_type f{[&sum](int const& v){ sum += v; }};
+    MyEvent::slot_type slot1{f};
+    MyEvent::slot_type slot2{nullptr};
+    MyEvent::slot_type slot3{MyEvent::slot_type::functor_type{}};
+    myEvent.sig().connect(slot1);
+    myEvent.sig().connect(slot2);
+    myEvent.sig().connect(slot3);
+
+    ASSERT_FALSE(myEvent.invoke(2));
+    ASSERT_EQ(sum, 2);
+    slot1.set_functor(nullptr);
+    ASSERT_FALSE(myEvent.invoke(2));
+    ASSERT_EQ(sum, 2);
+}
+
+TEST(event, ConnectWithPriorityWhileDispatching)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::event<MyEventTag, int>;
+    MyEvent myEvent;
+    std::vector<int> order{};
+    MyEvent::slot_type late([&order](int const&){ order.push_back(2); });
+    MyEvent::slot_type other([&order](int const&){ order.push_back(1); });
+    MyEvent::slot_type first([&](int const&){
+        order.push_back(0);
+        myEvent.sig().connect(late, 100);
+    });
+    myEvent.sig().connect(first, 1);
+    myEvent.sig().connect(other);
+
+    myEvent.invoke(0);
+    ASSERT_EQ(order, (std::vector<int>{0, 1}));    // not dispatched before the next invocation
+    order.clear();
+    myEvent.invoke(0);
+    ASSERT_EQ(order, (std::vector<int>{2, 0, 1}));
+    late.disconnect();
+    order.clear();
+    myEvent.invoke(0);
+    ASSERT_EQ(order, (std::vector<int>{0, 1}));
+}
+
+TEST(event, InvokeLazy)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::event<MyEventTag, std::string>;
+    MyEvent myEvent;
+    int built{0};
+    auto factory = [&built](){ ++built; return std::string{"snapshot"}; };
+    ASSERT_FALSE(myEvent.has_subscribers());
+    ASSERT_FALSE(myEvent.invoke_lazy(factory));
+    ASSERT_EQ(built, 0);
+
+    std::string received{};
+    MyEvent::slot_type slot([&received](std::string const& v){ received = v; });
+    myEvent.sig().connect(slot);
+    ASSERT_TRUE(myEvent.has_subscribers());
+    myEvent.invoke_lazy(factory);
+    ASSERT_EQ(built, 1);
+    ASSERT_EQ(received, "snapshot");
+
+    using PairEvent = ::astl::event<MyEventTag, int, std::string>;
+    PairEvent pairEvent;
+    int sum{0};
+    PairEvent::slot_type pairSlot([&sum](int const& v, std::string const& s){ sum += v + int(s.size()); });
+    pairEvent.sig().connect(pairSlot);
+    pairEvent.invoke_lazy([](){ return std::make_tuple(1, std::string{"ab"}); });
+    ASSERT_EQ(sum, 3);
+}
+
+TEST(event, PresenceHandler)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::event<MyEventTag, int>;
+    MyEvent myEvent;
+    std::vector<bool> presence{};
+    myEvent.on_presence([&presence](bool present){ presence.push_back(present); });
+
+    MyEvent::slot_type slot1([](int const&){});
+    MyEvent::slot_type slot2([](int const&){});
+    myEvent.sig().connect(slot1);
+    myEvent.sig().connect(slot2);
+    myEvent.sig().connect(slot1, 3);    // priority change is no presence change
+    ASSERT_EQ(presence, (std::vector<bool>{true}));
+    slot1.disconnect();
+    ASSERT_EQ(presence, (std::vector<bool>{true}));
+    {
+        MyEvent other;
+        other.sig().connect(slot2);     // moving the last slot to another signal
+    }
+    ASSERT_EQ(presence, (std::vector<bool>{true, false}));
+    ASSERT_FALSE(myEvent.has_subscribers());
+
+    // a slot disconnecting itself while dispatching
+    MyEvent::slot_type once([&once](int const&){ once.disconnect(); });
+    myEvent.sig().connect(once);
+    myEvent.invoke(0);
+    ASSERT_EQ(presence, (std::vector<bool>{true, false, true, false}));
+
+    myEvent.on_presence(std::function<void(bool)>{});
+    myEvent.sig().connect(slot1);
+    ASSERT_EQ(presence.size(), 4u);
+}
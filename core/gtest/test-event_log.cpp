@@ -0,0 +1,157 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/event_log.h>
+#include <astl/event.h>
+
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    std::string log_path(char const* name)
+    {
+        return ::testing::TempDir() + "astl-event_log-" + std::to_string(::getpid()) + "-" + name;
+    }
+}
+
+TEST(event_log, RecordAndReplay)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::event<MyEventTag, int, std::string>;
+    auto path = log_path("replay");
+    {
+        MyEvent myEvent{};
+        astl::event_recorder<MyEventTag, int, std::string> recorder{};
+        ASSERT_TRUE(recorder.open(path, 256));  // forces the log to grow
+        recorder.attach(myEvent.sig());
+        for (int i = 0; i < 100; ++i) {
+            myEvent.invoke(i, std::string(static_cast<std::size_t>(i), 'x'));
+        }
+        recorder.detach();
+        myEvent.invoke(100, "not recorded");
+        ASSERT_EQ(recorder.recorded(), 100u);
+        ASSERT_EQ(recorder.failed(), 0u);
+    }
+
+    astl::event_replayer<MyEventTag, int, std::string> replayer{};
+    ASSERT_TRUE(replayer.open(path));
+
+    MyEvent target{};
+    std::vector<int> ints;
+    MyEvent::slot_type slot{[&ints](int const& i, std::string const& s){
+        ASSERT_EQ(s.size(), static_cast<std::size_t>(i));
+        ints.push_back(i);
+    }};
+    target.sig().connect(slot);
+
+    auto stats = replayer.replay(target);
+    ASSERT_EQ(stats.events, 100u);
+    ASSERT_EQ(stats.errors, 0u);
+    ASSERT_GT(stats.throughput(), 0.0);
+    ASSERT_LE(stats.latency_min, stats.latency_mean());
+    ASSERT_LE(stats.latency_mean(), stats.latency_max);
+    ASSERT_EQ(ints.size(), 100u);
+    ASSERT_EQ(ints.back(), 99);
+    ::unlink(path.c_str());
+}
+
+TEST(event_log, ScaledTiming)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::event<MyEventTag, int>;
+    auto path = log_path("scaled");
+    {
+        astl::event_log_writer writer{};
+        ASSERT_TRUE(writer.open(path, typeid(MyEventTag).name()));
+        for (int i = 0; i < 3; ++i) {
+            // 20ms between two events
+            writer.append(static_cast<std::uint64_t>(i) * 20'000'000u, sizeof(int), [i](std::byte* out){
+                astl::serialize(out, i);
+            });
+        }
+    }
+    astl::event_replayer<MyEventTag, int> replayer{};
+    ASSERT_TRUE(replayer.open(path));
+    MyEvent target{};
+
+    auto stats = replayer.replay(target, {astl::replay_mode::scaled, 4.0});
+    ASSERT_EQ(stats.events, 3u);
+    ASSERT_GE(stats.elapsed, std::chrono::milliseconds{10});
+
+    stats = replayer.replay(target, {astl::replay_mode::original});
+    ASSERT_GE(stats.elapsed, std::chrono::milliseconds{40});
+    ::unlink(path.c_str());
+}
+
+TEST(event_log, WrongTag)
+{
+    struct MyEventTag{};
+    struct OtherTag{};
+    auto path = log_path("tag");
+    {
+        astl::event_recorder<MyEventTag, int> recorder{};
+        ASSERT_TRUE(recorder.open(path));
+    }
+    astl::event_replayer<OtherTag, int> other{};
+    ASSERT_FALSE(other.open(path));
+    astl::event_replayer<MyEventTag, int> mine{};
+    ASSERT_TRUE(mine.open(path));
+    ::unlink(path.c_str());
+}
+
+TEST(event_log, ReaderIsZeroCopy)
+{
+    auto path = log_path("reader");
+    {
+        astl::event_log_writer writer{};
+        ASSERT_TRUE(writer.open(path, "tag"));
+        writer.append(1, 3, [](std::byte* out){ std::memcpy(out, "abc", 3); });
+        writer.append(2, 0, [](std::byte*){});
+        writer.append(3, 9, [](std::byte* out){ std::memcpy(out, "123456789", 9); });
+    }
+    astl::event_log_reader reader{};
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_STREQ(reader.tag(), "tag");
+    std::vector<std::string> payloads;
+    for (auto const& e : reader) {
+        payloads.emplace_back(reinterpret_cast<char const*>(e.data), e.size);
+    }
+    ASSERT_EQ(payloads, (std::vector<std::string>{"abc", "", "123456789"}));
+    ::unlink(path.c_str());
+}
+
+TEST(event_log, ReaderStopsAtTruncatedPadding)
+{
+    auto path = log_path("truncated");
+    {
+        astl::event_log_writer writer{};
+        ASSERT_TRUE(writer.open(path, "tag"));
+        writer.append(1, 3, [](std::byte* out){ std::memcpy(out, "abc", 3); });
+        writer.append(2, 9, [](std::byte* out){ std::memcpy(out, "123456789", 9); });
+    }
+    // cuts off the padding behind the last payload only
+    struct stat st{};
+    ASSERT_EQ(::stat(path.c_str(), &st), 0);
+    ASSERT_EQ(::truncate(path.c_str(), st.st_size - 7), 0);
+
+    astl::event_log_reader reader{};
+    ASSERT_TRUE(reader.open(path));
+    std::vector<std::string> payloads;
+    for (auto it = reader.begin(); it != reader.end() && payloads.size() < 3; ++it) {
+        payloads.emplace_back(reinterpret_cast<char const*>(it->data), it->size);
+    }
+    ASSERT_EQ(payloads, (std::vector<std::string>{"abc", "123456789"}));
+    ::unlink(path.c_str());
+}
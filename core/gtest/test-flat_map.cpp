@@ -0,0 +1,89 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/flat_map.h>
+#include <astl/small_vector.h>
+#include <astl/testsupport/alloc_counter.h>
+
+#include <map>
+#include <string>
+
+TEST(flat_map, SortedInsertAndLookup)
+{
+    astl::flat_map<int, std::string> m{};
+    ASSERT_TRUE(m.insert_or_assign(3, "three").second);
+    ASSERT_TRUE(m.try_emplace(1, "one").second);
+    ASSERT_FALSE(m.try_emplace(1, "uno").second);
+    ASSERT_FALSE(m.insert_or_assign(3, "drei").second);
+    m[2] = "two";
+
+    ASSERT_EQ(m.size(), 3u);
+    int expected{1};
+    for (auto const& [key, value] : m) {
+        ASSERT_EQ(key, expected++);
+    }
+    ASSERT_EQ(m.find(1)->second, "one");
+    ASSERT_EQ(m.find(3)->second, "drei");
+    ASSERT_EQ(m.find(4), m.end());
+    ASSERT_TRUE(m.contains(2));
+    ASSERT_EQ(m.lower_bound(2)->first, 2);
+
+    ASSERT_EQ(m.erase(2), 1u);
+    ASSERT_EQ(m.erase(2), 0u);
+    m.erase(m.begin());
+    ASSERT_EQ(m.size(), 1u);
+    ASSERT_EQ(m.begin()->first, 3);
+}
+
+TEST(flat_map, CustomCompare)
+{
+    astl::flat_map<int, int, std::greater<int>> m{};
+    for (int i = 0; i < 5; ++i) {
+        m.try_emplace(i, i * i);
+    }
+    ASSERT_EQ(m.begin()->first, 4);
+    ASSERT_EQ(m.find(3)->second, 9);
+}
+
+TEST(flat_map, SmallVectorStorage)
+{
+    using entry = std::pair<int, int>;
+    astl::flat_map<int, int, std::less<int>, astl::small_vector<entry, 4>> m{};
+    ASTL_EXPECT_NO_ALLOC {
+        for (int i = 4; i > 0; --i) {
+            m.insert_or_assign(i, i);
+        }
+        m.erase(2);
+    }
+    ASSERT_EQ(m.size(), 3u);
+    ASSERT_EQ(m.container().front().first, 1);
+}
+
+TEST(flat_map, MatchesMap)
+{
+    astl::flat_map<int, int> m{};
+    std::map<int, int> reference{};
+    unsigned seed{7};
+    for (int step = 0; step < 2000; ++step) {
+        seed = seed * 1103515245u + 12345u;
+        auto key = static_cast<int>((seed >> 8) % 64);
+        if ((seed >> 16) % 3) {
+            m.insert_or_assign(key, step);
+            reference.insert_or_assign(key, step);
+        }
+        else {
+            ASSERT_EQ(m.erase(key), reference.erase(key));
+        }
+        ASSERT_TRUE(std::equal(m.begin(), m.end(), reference.begin(), reference.end(),
+                               [](auto const& a, auto const& b){ return a.first == b.first && a.second == b.second; }));
+    }
+}
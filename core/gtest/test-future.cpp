@@ -0,0 +1,224 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/future.h>
+#include <astl/event.h>
+#include <astl/testsupport/alloc_counter.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+    //! Executor queueing functions until run() is called.
+    struct manual_executor
+    {
+        template<typename F>
+        void execute(F f)
+        {
+            queue.emplace_back(std::move(f));
+        }
+
+        std::size_t run()
+        {
+            std::size_t count{0};
+            while (!queue.empty()) {
+                auto f = std::move(queue.front());
+                queue.pop_front();
+                f();
+                ++count;
+            }
+            return count;
+        }
+
+        std::deque<std::function<void()>> queue{};
+    };
+}
+
+TEST(future, SetValueThenPoll)
+{
+    astl::promise<int> p{};
+    auto f = p.get_future();
+    ASSERT_TRUE(f.valid());
+    EXPECT_FALSE(f.ready());
+    p.set_value(42);
+    ASSERT_TRUE(f.ready());
+    EXPECT_FALSE(f.broken());
+    EXPECT_EQ(f.get(), 42);
+}
+
+TEST(future, ContinuationChain)
+{
+    astl::promise<int> p{};
+    std::string result{};
+    auto last = p.get_future()
+        .then([](int v){ return std::to_string(v * 2); })
+        .then([&result](std::string s){ result = std::move(s); });
+    EXPECT_TRUE(result.empty());
+    p.set_value(21);
+    EXPECT_EQ(result, "42");
+    EXPECT_TRUE(last.ready());
+}
+
+TEST(future, ContinuationAttachedAfterValue)
+{
+    astl::promise<int> p{};
+    auto f = p.get_future();
+    p.set_value(1);
+    auto g = std::move(f).then([](int v){ return v + 1; });
+    EXPECT_FALSE(f.valid());
+    ASSERT_TRUE(g.ready());
+    EXPECT_EQ(g.get(), 2);
+}
+
+TEST(future, ContinuationRunsOnExecutor)
+{
+    manual_executor ex{};
+    astl::promise<int> p{};
+    int seen{0};
+    auto f = p.get_future().then(ex, [&seen](int v){ seen = v; return v; });
+    p.set_value(7);
+    EXPECT_EQ(seen, 0);
+    EXPECT_FALSE(f.ready());
+    EXPECT_EQ(ex.run(), 1u);
+    EXPECT_EQ(seen, 7);
+    EXPECT_TRUE(f.ready());
+}
+
+TEST(future, BrokenPromise)
+{
+    bool ran{false};
+    astl::future<std::monostate> f{};
+    {
+        astl::promise<int> p{};
+        f = p.get_future().then([&ran](int){ ran = true; });
+    }
+    EXPECT_FALSE(ran);
+    EXPECT_TRUE(f.broken());
+    EXPECT_FALSE(f.ready());
+}
+
+TEST(future, MoveOnlyValue)
+{
+    astl::promise<std::unique_ptr<int>> p{};
+    auto f = p.get_future().then([](std::unique_ptr<int> v){ return *v; });
+    p.set_value(std::make_unique<int>(5));
+    EXPECT_EQ(f.get(), 5);
+}
+
+TEST(future, InlineStateDoesNotAllocate)
+{
+    struct operation
+    {
+        astl::future_state<int> state{};
+    };
+    operation op{};
+    int value{0};
+    ASTL_EXPECT_NO_ALLOC {
+        astl::promise<int> p{op.state};
+        auto f = p.get_future();
+        p.set_value(3);
+        value = f.get();
+    }
+    EXPECT_EQ(value, 3);
+    op.state.reset();
+    astl::promise<int> p{op.state};
+    auto f = p.get_future();
+    p.set_value(4);
+    EXPECT_EQ(f.get(), 4);
+}
+
+TEST(future, PooledStatesAreReused)
+{
+    auto roundtrip = [](){
+        astl::promise<int> p{};
+        auto f = p.get_future().then([](int v){ return v + 1; });
+        p.set_value(1);
+        return f.get();
+    };
+    EXPECT_EQ(roundtrip(), 2);    // warms up the pool of this thread
+    ASTL_EXPECT_NO_ALLOC {
+        EXPECT_EQ(roundtrip(), 2);
+    }
+}
+
+TEST(future, WhenAll)
+{
+    astl::promise<int> p1{};
+    astl::promise<std::string> p2{};
+    auto all = astl::when_all(p1.get_future(), p2.get_future());
+    p2.set_value("two");
+    EXPECT_FALSE(all.ready());
+    p1.set_value(1);
+    ASSERT_TRUE(all.ready());
+    EXPECT_EQ(std::get<0>(all.get()), 1);
+    EXPECT_EQ(std::get<1>(all.get()), "two");
+
+    astl::promise<int> p3{};
+    auto broken = astl::when_all(p3.get_future(), astl::promise<int>{}.get_future());
+    p3.set_value(3);
+    EXPECT_TRUE(broken.broken());
+}
+
+TEST(future, WhenAny)
+{
+    astl::promise<int> p1{};
+    astl::promise<int> p2{};
+    auto any = astl::when_any(p1.get_future(), p2.get_future());
+    p2.set_value(2);
+    ASSERT_TRUE(any.ready());
+    EXPECT_EQ(any.get().index(), 1u);
+    EXPECT_EQ(std::get<1>(any.get()), 2);
+    p1.set_value(1);
+    EXPECT_EQ(any.get().index(), 1u);
+
+    auto none = astl::when_any(astl::promise<int>{}.get_future(), astl::promise<int>{}.get_future());
+    EXPECT_TRUE(none.broken());
+}
+
+TEST(future, NextInvocation)
+{
+    struct MyEventTag{};
+    astl::event<MyEventTag, int> myEvent{};
+    int received{0};
+    auto f = astl::next_invocation(myEvent.sig()).then([&received](int v){ received = v; });
+    myEvent.invoke(1);
+    myEvent.invoke(2);
+    EXPECT_EQ(received, 1);
+    EXPECT_TRUE(myEvent.sig().empty());
+
+    astl::event<MyEventTag, int, std::string> pairEvent{};
+    auto g = astl::next_invocation(pairEvent.sig());
+    pairEvent.invoke(3, std::string{"three"});
+    ASSERT_TRUE(g.ready());
+    EXPECT_EQ(std::get<1>(g.get()), "three");
+
+    {
+        auto dropped = astl::next_invocation(myEvent.sig());
+        EXPECT_FALSE(myEvent.sig().empty());
+    }
+    EXPECT_TRUE(myEvent.sig().empty());
+}
+
+TEST(future, CrossThread)
+{
+    for (int i = 0; i < 1000; ++i) {
+        astl::promise<int> p{};
+        std::atomic<int> seen{0};
+        std::thread producer{[&p, i](){ p.set_value(i); }};
+        auto f = p.get_future().then([&seen](int v){ seen = v + 1; });
+        producer.join();
+        EXPECT_EQ(seen, i + 1);
+    }
+}
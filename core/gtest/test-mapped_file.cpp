@@ -0,0 +1,51 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/mapped_file.h>
+
+#include <string>
+
+TEST(mapped_file, CreateResizeReopen)
+{
+    auto path = ::testing::TempDir() + "astl-mapped_file-" + std::to_string(::getpid());
+    {
+        astl::mapped_file mf{};
+        ASSERT_FALSE(mf.is_open());
+        ASSERT_TRUE(mf.open(path, 16));
+        ASSERT_TRUE(mf.is_writable());
+        ASSERT_EQ(mf.size(), 16u);
+        mf.data()[15] = std::byte{42};
+        ASSERT_TRUE(mf.resize(4096));
+        ASSERT_EQ(mf.size(), 4096u);
+        ASSERT_EQ(mf.data()[15], std::byte{42});
+        mf.data()[4095] = std::byte{7};
+    }
+    astl::mapped_file mf{};
+    ASSERT_TRUE(mf.open_read_only(path));
+    ASSERT_FALSE(mf.is_writable());
+    ASSERT_EQ(mf.size(), 4096u);
+    ASSERT_EQ(mf.data()[15], std::byte{42});
+    ASSERT_EQ(mf.data()[4095], std::byte{7});
+    ASSERT_FALSE(mf.resize(8192));
+
+    astl::mapped_file moved{std::move(mf)};
+    ASSERT_FALSE(mf.is_open());
+    ASSERT_TRUE(moved.is_open());
+    ::unlink(path.c_str());
+}
+
+TEST(mapped_file, MissingFile)
+{
+    astl::mapped_file mf{};
+    ASSERT_FALSE(mf.open_read_only("/nonexistent/astl/mapped_file"));
+    ASSERT_FALSE(mf.is_open());
+}
@@ -11,6 +11,7 @@
 // If not, see <http://www.gnu.org/licenses/>.
 #include <gtest/gtest.h>
 #include <astl/multi_final.h>
+#include <astl/testsupport/alloc_counter.h>
 
 TEST(multi_final, Empty)
 {
@@ -59,3 +60,25 @@ TEST(multi_final, Resetted)
     ASSERT_FALSE(exec1);
     ASSERT_FALSE(exec2);
 }
+
+TEST(multi_final, Allocations)
+{
+    int count{0};
+    {
+        astl::multi_final mf{};
+        ASTL_EXPECT_NO_ALLOC {  // two small functors are stored inline
+            mf.append([&count](){++count;});
+            mf.append([&count](){++count;});
+        }
+        astl::testsupport::alloc_counter counter{};
+        mf.append([&count](){++count;});
+        counter.stop();
+        RecordProperty("append_allocations", static_cast<int>(counter.allocations()));
+        RecordProperty("append_bytes", static_cast<int>(counter.bytes()));
+    }
+    ASSERT_EQ(count, 3);
+    ASTL_EXPECT_NO_ALLOC {
+        astl::multi_final mf{};
+        mf.reset();
+    }
+}
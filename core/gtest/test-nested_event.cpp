@@ -0,0 +1,213 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/nested_event.h>
+#include <astl/testsupport/alloc_counter.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST(nested_event, NoSlot)
+{
+    struct MyEventTag{};
+    ::astl::nested_event<MyEventTag, int> myEvent;
+    ASSERT_FALSE(myEvent.invoke(1));
+    ASSERT_EQ(myEvent.depth(), 0u);
+}
+
+TEST(nested_event, DepthFirst)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::nested_event<MyEventTag, int>;
+    MyEvent myEvent;
+
+    std::vector<std::string> log;
+    MyEvent::slot_type first([&](int const& v){
+        log.push_back("first " + std::to_string(v) + " depth " + std::to_string(myEvent.depth()));
+        if (v > 0) {
+            myEvent.invoke(v - 1);
+        }
+    });
+    MyEvent::slot_type second([&](int const& v){ log.push_back("second " + std::to_string(v)); });
+    myEvent.sig().connect(first);
+    myEvent.sig().connect(second);
+
+    myEvent.invoke(2);
+    ASSERT_EQ(myEvent.depth(), 0u);
+    ASSERT_EQ(log, (std::vector<std::string>{"first 2 depth 1", "first 1 depth 2", "first 0 depth 3", "second 0",
+                                             "second 1", "second 2"}));
+}
+
+TEST(nested_event, DisconnectedSkippedAtAllLevels)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::nested_event<MyEventTag, int>;
+    MyEvent myEvent;
+
+    std::vector<int> received;
+    auto victim = std::make_unique<MyEvent::slot_type>([&received](int const& v){ received.push_back(v); });
+    MyEvent::slot_type trigger([&](int const& v){
+        if (v == 0) {
+            myEvent.invoke(1);
+        }
+        else {
+            // two levels deep, the outer level has not reached the victim yet
+            victim.reset();
+        }
+    });
+    myEvent.sig().connect(trigger, 1);
+    myEvent.sig().connect(*victim);
+
+    myEvent.invoke(0);
+    ASSERT_TRUE(received.empty());
+    ASSERT_FALSE(myEvent.sig().empty());
+    myEvent.invoke(2);
+    ASSERT_TRUE(received.empty());
+}
+
+TEST(nested_event, ConnectedDuringDispatch)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::nested_event<MyEventTag, int>;
+    MyEvent myEvent;
+
+    std::vector<int> late_received;
+    MyEvent::slot_type late([&late_received](int const& v){ late_received.push_back(v); });
+    MyEvent::slot_type trigger([&](int const& v){
+        if (v == 0) {
+            myEvent.sig().connect(late);
+            myEvent.invoke(1);
+        }
+    });
+    MyEvent::slot_type other([](int const&){});
+    myEvent.sig().connect(trigger);
+    myEvent.sig().connect(other);
+
+    myEvent.invoke(0);
+    ASSERT_TRUE(late_received.empty());
+    myEvent.invoke(2);
+    ASSERT_EQ(late_received, (std::vector<int>{2}));
+}
+
+TEST(nested_event, ConnectedDuringDispatchOfSingleSlot)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::nested_event<MyEventTag, int>;
+    MyEvent myEvent;
+
+    std::vector<std::string> log;
+    MyEvent::slot_type late([&log](int const& v){ log.push_back("B got " + std::to_string(v)); });
+    MyEvent::slot_type single([&](int const& v){
+        log.push_back("A got " + std::to_string(v));
+        if (v == 0) {
+            myEvent.sig().connect(late, 1);
+            myEvent.invoke(1);
+        }
+    });
+    myEvent.sig().connect(single);
+
+    myEvent.invoke(0);
+    ASSERT_EQ(log, (std::vector<std::string>{"A got 0", "A got 1"}));
+    myEvent.invoke(2);
+    ASSERT_EQ(log, (std::vector<std::string>{"A got 0", "A got 1", "B got 2", "A got 2"}));
+}
+
+TEST(nested_event, ConnectedDuringDispatchAfterSingleSlotDetached)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::nested_event<MyEventTag, int>;
+    MyEvent myEvent;
+
+    std::vector<std::string> log;
+    MyEvent::slot_type late([&log](int const& v){ log.push_back("B got " + std::to_string(v)); });
+    MyEvent::slot_type single([&](int const& v){
+        log.push_back("A got " + std::to_string(v));
+        single.disconnect();
+        myEvent.sig().connect(late);
+        myEvent.invoke(1);
+    });
+    myEvent.sig().connect(single);
+
+    myEvent.invoke(0);
+    ASSERT_EQ(log, (std::vector<std::string>{"A got 0"}));
+    myEvent.invoke(2);
+    ASSERT_EQ(log, (std::vector<std::string>{"A got 0", "B got 2"}));
+}
+
+TEST(nested_event, Consumed)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::nested_event<MyEventTag, int>;
+    MyEvent myEvent;
+
+    std::vector<int> received;
+    bool inner_consumed{false};
+    MyEvent::slot_type consumer([&](int const& v){
+        if (v == 0) {
+            inner_consumed = myEvent.invoke(1);
+            return astl::slot_result::proceed;
+        }
+        return astl::slot_result::consumed;
+    });
+    MyEvent::slot_type tail([&received](int const& v){ received.push_back(v); });
+    myEvent.sig().connect(consumer, 1);
+    myEvent.sig().connect(tail);
+
+    ASSERT_FALSE(myEvent.invoke(0));
+    ASSERT_TRUE(inner_consumed);
+    ASSERT_EQ(received, (std::vector<int>{0}));
+}
+
+TEST(nested_event, QueuedBeyondMaxDepth)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::nested_event<MyEventTag, int>;
+    MyEvent myEvent{2};
+
+    std::vector<std::pair<int, std::size_t>> received;
+    MyEvent::slot_type slot([&](int const& v){
+        received.emplace_back(v, myEvent.depth());
+        if (v > 0) {
+            myEvent.invoke(v - 1);
+        }
+    });
+    myEvent.sig().connect(slot);
+
+    ASSERT_FALSE(myEvent.invoke(3));
+    ASSERT_EQ(received, (std::vector<std::pair<int, std::size_t>>{{3, 1}, {2, 2}, {1, 2}, {0, 2}}));
+    ASSERT_EQ(myEvent.depth(), 0u);
+}
+
+TEST(nested_event, NoAllocationForNesting)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::nested_event<MyEventTag, int>;
+    MyEvent myEvent;
+    std::vector<int> received{};
+    received.reserve(16);
+    MyEvent::slot_type slot([&](int const& v){
+        received.push_back(v);
+        if (v > 0) {
+            myEvent.invoke(v - 1);
+        }
+    });
+    MyEvent::slot_type other([](int const&){});
+    myEvent.sig().connect(slot);
+    myEvent.sig().connect(other);
+
+    ASTL_EXPECT_NO_ALLOC {
+        myEvent.invoke(10);
+    }
+    ASSERT_EQ(received.size(), 11u);
+}
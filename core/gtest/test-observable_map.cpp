@@ -0,0 +1,75 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/observable_map.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+    using Model = astl::observable_map<std::string, int>;
+    using Changes = Model::changes_type;
+    using Change = astl::map_change<std::string>;
+}
+
+TEST(observable_map, SingleChanges)
+{
+    Model model{};
+    std::vector<Changes> received;
+    Model::slot_type slot{[&received](Changes const& c){ received.push_back(c); }};
+    model.sig().connect(slot);
+
+    ASSERT_TRUE(model.insert_or_assign("a", 1));
+    ASSERT_FALSE(model.insert_or_assign("a", 2));
+    ASSERT_TRUE(model.modify("a", [](int& v){ ++v; }));
+    ASSERT_FALSE(model.modify("b", [](int& v){ ++v; }));
+    ASSERT_TRUE(model.erase("a"));
+    ASSERT_FALSE(model.erase("a"));
+    ASSERT_EQ(received, (std::vector<Changes>{
+            {Change{astl::change_kind::insert, "a"}},
+            {Change{astl::change_kind::update, "a"}},
+            {Change{astl::change_kind::update, "a"}},
+            {Change{astl::change_kind::erase, "a"}}}));
+}
+
+TEST(observable_map, BatchNetEffect)
+{
+    Model model{Model::map_type{{"x", 1}, {"y", 2}}};
+    std::vector<Changes> received;
+    Model::slot_type slot{[&received](Changes const& c){ received.push_back(c); }};
+    model.sig().connect(slot);
+    {
+        astl::change_batch batch{model};
+        model.insert_or_assign("a", 1);     // insert
+        model.insert_or_assign("a", 2);     //   + update = insert
+        model.insert_or_assign("b", 1);     // insert
+        model.erase("b");                   //   + erase = nothing
+        model.erase("x");                   // erase
+        model.insert_or_assign("x", 3);     //   + insert = update
+        model.modify("y", [](int& v){ v = 0; });
+        model.erase("y");                   // update + erase = erase
+    }
+    ASSERT_EQ(received, (std::vector<Changes>{{
+            Change{astl::change_kind::insert, "a"},
+            Change{astl::change_kind::update, "x"},
+            Change{astl::change_kind::erase, "y"}}}));
+
+    received.clear();
+    {
+        astl::change_batch batch{model};
+        model.insert_or_assign("c", 1);
+        model.clear();
+        model.insert_or_assign("d", 1);
+    }
+    ASSERT_EQ(received, (std::vector<Changes>{{Change{astl::change_kind::reset, ""}}}));
+    ASSERT_EQ(model.size(), 1u);
+}
@@ -0,0 +1,186 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/observable_vector.h>
+
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+    using Model = astl::observable_vector<int>;
+    using Changes = std::vector<astl::vector_change>;
+
+    // applies the change records to mirror, reading new values from the model
+    void apply(std::vector<int>& mirror, Model const& model, Changes const& changes)
+    {
+        for (auto const& c : changes) {
+            switch (c.kind) {
+                case astl::change_kind::insert:
+                    mirror.insert(mirror.begin() + c.first, model.begin() + c.first, model.begin() + c.first + c.count);
+                    break;
+                case astl::change_kind::erase:
+                    mirror.erase(mirror.begin() + c.first, mirror.begin() + c.first + c.count);
+                    break;
+                case astl::change_kind::update:
+                    std::copy(model.begin() + c.first, model.begin() + c.first + c.count, mirror.begin() + c.first);
+                    break;
+                case astl::change_kind::reset:
+                    mirror = model.get();
+                    break;
+            }
+        }
+    }
+}
+
+TEST(observable_vector, SingleChanges)
+{
+    Model model{};
+    std::vector<Changes> received;
+    Model::slot_type slot{[&received](Changes const& c){ received.push_back(c); }};
+    model.sig().connect(slot);
+
+    model.push_back(1);
+    model.push_back(2);
+    model.insert(0, 0);
+    model.set(2, 5);
+    model.erase(1);
+    ASSERT_EQ(model.get(), (std::vector<int>{0, 5}));
+    ASSERT_EQ(received, (std::vector<Changes>{
+            {{astl::change_kind::insert, 0, 1}},
+            {{astl::change_kind::insert, 1, 1}},
+            {{astl::change_kind::insert, 0, 1}},
+            {{astl::change_kind::update, 2, 1}},
+            {{astl::change_kind::erase, 1, 1}}}));
+}
+
+TEST(observable_vector, BatchMergesRanges)
+{
+    Model model{std::vector<int>(10, 0)};
+    std::vector<Changes> received;
+    Model::slot_type slot{[&received](Changes const& c){ received.push_back(c); }};
+    model.sig().connect(slot);
+
+    {
+        astl::change_batch batch{model};
+        for (int i = 0; i < 10000; ++i) {
+            model.push_back(i);
+        }
+        for (std::size_t i = 2; i < 6; ++i) {
+            model.set(i, 1);
+        }
+        ASSERT_TRUE(received.empty());
+    }
+    ASSERT_EQ(received, (std::vector<Changes>{{
+            {astl::change_kind::insert, 10, 10000},
+            {astl::change_kind::update, 2, 4}}}));
+
+    received.clear();
+    {
+        astl::change_batch batch{model};
+        model.erase(0, 5000);
+        model.set(0, 7);        // former index 5000, inserted in the previous batch
+        model.insert(0, 3);
+        model.erase(0);         // the insert vanishes
+    }
+    ASSERT_EQ(received, (std::vector<Changes>{{
+            {astl::change_kind::erase, 0, 5000},
+            {astl::change_kind::update, 0, 1}}}));
+
+    received.clear();
+    {
+        astl::change_batch batch{model};
+        model.set(0, 1);
+        model.set(0, 2);
+    }
+    ASSERT_EQ(received.size(), 1u);
+    {
+        astl::change_batch batch{model};
+    }
+    ASSERT_EQ(received.size(), 1u);
+}
+
+TEST(observable_vector, Reset)
+{
+    Model model{std::vector<int>{1, 2, 3}};
+    std::vector<Changes> received;
+    Model::slot_type slot{[&received](Changes const& c){ received.push_back(c); }};
+    model.sig().connect(slot);
+    {
+        astl::change_batch batch{model};
+        model.push_back(4);
+        model.assign({5, 6});
+        model.push_back(7);
+    }
+    ASSERT_EQ(received, (std::vector<Changes>{{{astl::change_kind::reset, 0, 3}}}));
+}
+
+TEST(observable_vector, MirrorRandomBatches)
+{
+    std::mt19937 random{42};
+    Model model{std::vector<int>{1, 2, 3, 4, 5}};
+    std::vector<int> mirror = model.get();
+    Model::slot_type slot{[&mirror, &model](Changes const& c){ apply(mirror, model, c); }};
+    model.sig().connect(slot);
+
+    int next{100};
+    for (int round = 0; round < 200; ++round) {
+        astl::change_batch batch{model};
+        for (int op = 0; op < 20; ++op) {
+            auto size = model.size();
+            switch (random() % 4) {
+                case 0:
+                    model.insert(random() % (size + 1), next++);
+                    break;
+                case 1:
+                    if (size) {
+                        auto first = random() % size;
+                        model.erase(first, first + 1 + random() % std::min<std::size_t>(3, size - first));
+                    }
+                    break;
+                case 2:
+                    if (size) {
+                        model.set(random() % size, next++);
+                    }
+                    break;
+                case 3:
+                    model.push_back(next++);
+                    break;
+            }
+        }
+    }
+    ASSERT_EQ(mirror, model.get());
+}
+
+TEST(observable_vector, MirrorScatteredChanges)
+{
+    std::vector<int> values(10000);
+    std::iota(values.begin(), values.end(), 0);
+    Model model{values};
+    std::vector<int> mirror = model.get();
+    Model::slot_type slot{[&mirror, &model](Changes const& c){ apply(mirror, model, c); }};
+    model.sig().connect(slot);
+    {
+        // every change splits a segment, a batch of thousands of segments
+        astl::change_batch batch{model};
+        for (std::size_t i = 0; i < model.size(); i += 3) {
+            model.set(i, -1);
+        }
+        for (std::size_t i = 1; i < model.size(); i += 4) {
+            model.erase(i);
+        }
+        for (std::size_t i = 0; i < model.size(); i += 5) {
+            model.insert(i, -2);
+        }
+    }
+    ASSERT_EQ(mirror, model.get());
+}
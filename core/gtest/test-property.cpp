@@ -0,0 +1,206 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/property.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST(property, ChangeEventOnlyOnRealChange)
+{
+    astl::property<int> p{1};
+    std::vector<int> values;
+    astl::property<int>::slot_type slot{[&values](int const& v){ values.push_back(v); }};
+    p.sig().connect(slot);
+
+    p.set(1);
+    p.set(2);
+    p.set(2);
+    p.set(3);
+    ASSERT_EQ(p.get(), 3);
+    ASSERT_EQ(values, (std::vector<int>{2, 3}));
+}
+
+TEST(property, TransactionCoalescesWrites)
+{
+    astl::property<int> p{1};
+    std::vector<int> values;
+    astl::property<int>::slot_type slot{[&values](int const& v){ values.push_back(v); }};
+    p.sig().connect(slot);
+
+    {
+        astl::transaction t{};
+        p.set(2);
+        p.set(3);
+        ASSERT_TRUE(values.empty());
+    }
+    ASSERT_EQ(values, (std::vector<int>{3}));
+
+    {
+        astl::transaction t{};
+        p.set(4);
+        p.set(3);
+    }
+    ASSERT_EQ(values, (std::vector<int>{3}));
+}
+
+TEST(computed, LazyEvaluation)
+{
+    int evaluations{0};
+    astl::property<int> a{1};
+    astl::property<int> b{2};
+    astl::computed<int> sum{[&]{ ++evaluations; return a.get() + b.get(); }};
+    ASSERT_EQ(evaluations, 0);
+
+    ASSERT_EQ(sum.get(), 3);
+    ASSERT_EQ(sum.get(), 3);
+    ASSERT_EQ(evaluations, 1);
+
+    a.set(10);
+    b.set(20);
+    ASSERT_EQ(evaluations, 1);
+    ASSERT_EQ(sum.get(), 30);
+    ASSERT_EQ(evaluations, 2);
+}
+
+TEST(computed, DiamondRecomputesOnce)
+{
+    int evaluations{0};
+    astl::property<int> a{1};
+    astl::computed<int> left{[&]{ return a.get() + 1; }};
+    astl::computed<int> right{[&]{ return a.get() * 2; }};
+    astl::computed<int> bottom{[&]{ ++evaluations; return left.get() + right.get(); }};
+
+    std::vector<int> values;
+    astl::computed<int>::slot_type slot{[&values, &left, &right](int const& v){
+        // no glitch: both inputs are up to date when the change event fires
+        ASSERT_EQ(v, left.get() + right.get());
+        values.push_back(v);
+    }};
+    bottom.sig().connect(slot);
+    ASSERT_EQ(bottom.get(), 4);
+    ASSERT_EQ(evaluations, 1);
+
+    a.set(2);
+    ASSERT_EQ(evaluations, 2);
+    ASSERT_EQ(values, (std::vector<int>{7}));
+
+    {
+        astl::transaction t{};
+        a.set(3);
+        a.set(4);
+    }
+    ASSERT_EQ(evaluations, 3);
+    ASSERT_EQ(values, (std::vector<int>{7, 13}));
+}
+
+TEST(computed, UnchangedIntermediateStopsPropagation)
+{
+    int evaluations{0};
+    astl::property<int> a{1};
+    astl::computed<bool> positive{[&]{ return a.get() > 0; }};
+    astl::computed<std::string> text{[&]{ ++evaluations; return std::string{positive.get() ? "+" : "-"}; }};
+    ASSERT_EQ(text.get(), "+");
+
+    a.set(5);
+    ASSERT_EQ(text.get(), "+");
+    ASSERT_EQ(evaluations, 1);
+
+    a.set(-1);
+    ASSERT_EQ(text.get(), "-");
+    ASSERT_EQ(evaluations, 2);
+}
+
+TEST(computed, DynamicDependencies)
+{
+    int evaluations{0};
+    astl::property<bool> useA{true};
+    astl::property<int> a{1};
+    astl::property<int> b{2};
+    astl::computed<int> value{[&]{ ++evaluations; return useA.get() ? a.get() : b.get(); }};
+    ASSERT_EQ(value.get(), 1);
+
+    b.set(3);
+    ASSERT_EQ(value.get(), 1);
+    ASSERT_EQ(evaluations, 1);
+
+    useA.set(false);
+    ASSERT_EQ(value.get(), 3);
+    a.set(5);
+    ASSERT_EQ(value.get(), 3);
+    ASSERT_EQ(evaluations, 2);
+}
+
+TEST(computed, ObservedNodesFireInTopologicalOrder)
+{
+    astl::property<int> a{1};
+    astl::computed<int> first{[&]{ return a.get() + 1; }};
+    astl::computed<int> second{[&]{ return first.get() + 1; }};
+    std::vector<std::string> order;
+    astl::computed<int>::slot_type slot2{[&order](int const&){ order.emplace_back("second"); }};
+    astl::computed<int>::slot_type slot1{[&order](int const&){ order.emplace_back("first"); }};
+    second.sig().connect(slot2);
+    first.sig().connect(slot1);
+    ASSERT_EQ(second.get(), 3);
+
+    a.set(2);
+    ASSERT_EQ(order, (std::vector<std::string>{"first", "second"}));
+}
+
+TEST(computed, SourceDestroyed)
+{
+    auto a = std::make_unique<astl::property<int>>(1);
+    astl::computed<int> value{[&]{ return a ? a->get() : 0; }};
+    ASSERT_EQ(value.get(), 1);
+    a.reset();
+    ASSERT_EQ(value.get(), 0);
+}
+
+TEST(computed, ConnectedWhileDirty)
+{
+    astl::property<int> a{1};
+    astl::computed<int> c{[&]{ return a.get() * 2; }};
+    ASSERT_EQ(c.get(), 2);
+    a.set(2);   // invalidates c while nobody observes it
+
+    std::vector<int> values;
+    astl::computed<int>::slot_type slot{[&values](int const& v){ values.push_back(v); }};
+    c.sig().connect(slot);
+    a.set(3);
+    ASSERT_EQ(values, (std::vector<int>{6}));
+    a.set(4);
+    ASSERT_EQ(values, (std::vector<int>{6, 8}));
+}
+
+TEST(computed, ObserversFollowGrownHeight)
+{
+    astl::property<bool> deep{false};
+    astl::property<int> a{1};
+    astl::computed<int> d1{[&]{ return a.get() + 1; }};
+    astl::computed<int> d2{[&]{ return d1.get() + 1; }};
+    astl::computed<int> first{[&]{ return deep.get() ? d2.get() - 2 : a.get(); }};
+    astl::computed<int> second{[&]{ return first.get() * 10; }};
+    ASSERT_EQ(second.get(), 10);
+
+    std::vector<std::string> order;
+    astl::computed<int>::slot_type slot2{[&order](int const&){ order.emplace_back("second"); }};
+    astl::computed<int>::slot_type slot1{[&order](int const&){ order.emplace_back("first"); }};
+    second.sig().connect(slot2);
+    first.sig().connect(slot1);
+
+    deep.set(true);     // first keeps its value but now depends on d2, second is not recomputed
+    ASSERT_TRUE(order.empty());
+    a.set(5);
+    ASSERT_EQ(second.get(), 50);
+    ASSERT_EQ(order, (std::vector<std::string>{"first", "second"}));
+}
@@ -11,6 +11,9 @@
 // If not, see <http://www.gnu.org/licenses/>.
 #include <gtest/gtest.h>
 #include <astl/recursive_event.h>
+#include <astl/testsupport/alloc_counter.h>
+
+#include <vector>
 
 TEST(recursive_event, NoSlot)
 {
@@ -59,3 +62,68 @@ TEST(recursive_event, VoidEvents) {
 
     ASSERT_EQ(count, 1);
 }
+
+TEST(recursive_event, NoAllocationForShortChains)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::recursive_event<MyEventTag, int>;
+    MyEvent myEvent;
+    std::vector<int> received{};
+    received.reserve(4);
+    MyEvent::slot_type slot([&](int const& v){
+        received.push_back(v);
+        if (v > 0) {
+            myEvent.invoke(v - 1);
+        }
+    });
+    myEvent.sig().connect(slot);
+
+    ASTL_EXPECT_NO_ALLOC {
+        myEvent.invoke(1);
+    }
+    ASSERT_EQ(received, (std::vector<int>{1, 0}));
+
+    received.clear();
+    myEvent.invoke(3);
+    ASSERT_EQ(received, (std::vector<int>{3, 2, 1, 0}));
+}
+
+TEST(recursive_event, NoAllocationForDeepChains)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::recursive_event<MyEventTag, int>;
+    MyEvent myEvent;
+    int count{0};
+    MyEvent::slot_type slot([&](int const& v){
+        ++count;
+        if (v > 0) {
+            myEvent.invoke(v - 1);
+        }
+    });
+    myEvent.sig().connect(slot);
+
+    // the queue starts over at its front for each link of the chain and keeps its inline capacity
+    ASTL_EXPECT_NO_ALLOC {
+        myEvent.invoke(10000);
+    }
+    ASSERT_EQ(count, 10001);
+}
+
+TEST(recursive_event, FanOutKeepsOrder)
+{
+    struct MyEventTag{};
+    using MyEvent = ::astl::recursive_event<MyEventTag, int>;
+    MyEvent myEvent;
+    std::vector<int> received{};
+    MyEvent::slot_type slot([&](int const& v){
+        received.push_back(v);
+        if (v < 7) {
+            myEvent.invoke(2 * v);
+            myEvent.invoke(2 * v + 1);
+        }
+    });
+    myEvent.sig().connect(slot);
+
+    myEvent.invoke(1);
+    ASSERT_EQ(received, (std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13}));
+}
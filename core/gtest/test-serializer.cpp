@@ -0,0 +1,88 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/serializer.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+    struct Point {
+        std::string name;
+        int x;
+    };
+}
+
+template<>
+struct astl::serializer<Point>
+{
+    static std::size_t size(Point const& p) noexcept
+    {
+        return serialized_size(p.name, p.x);
+    }
+
+    static std::byte* write(std::byte* out, Point const& p) noexcept
+    {
+        return serialize(out, p.name, p.x);
+    }
+
+    static std::byte const* read(std::byte const* in, std::byte const* end, Point& p) noexcept
+    {
+        in = serializer<std::string>::read(in, end, p.name);
+        return in ? serializer<int>::read(in, end, p.x) : nullptr;
+    }
+};
+
+TEST(serializer, RoundTrip)
+{
+    std::vector<Point> points{{"a", 1}, {"bc", 2}};
+    std::string text{"hello"};
+    double d{2.5};
+
+    std::vector<std::byte> buffer(astl::serialized_size(text, d, points));
+    auto end = astl::serialize(buffer.data(), text, d, points);
+    ASSERT_EQ(end, buffer.data() + buffer.size());
+
+    std::tuple<std::string, double, std::vector<Point>> values{};
+    ASSERT_TRUE(astl::deserialize(buffer.data(), buffer.data() + buffer.size(), values));
+    ASSERT_EQ(std::get<0>(values), "hello");
+    ASSERT_DOUBLE_EQ(std::get<1>(values), 2.5);
+    ASSERT_EQ(std::get<2>(values).size(), 2u);
+    ASSERT_EQ(std::get<2>(values)[1].name, "bc");
+    ASSERT_EQ(std::get<2>(values)[1].x, 2);
+}
+
+TEST(serializer, StringViewIsNotCopied)
+{
+    std::string text{"zero-copy"};
+    std::vector<std::byte> buffer(astl::serialized_size(text));
+    astl::serialize(buffer.data(), text);
+
+    std::tuple<std::string_view> values{};
+    ASSERT_TRUE(astl::deserialize(buffer.data(), buffer.data() + buffer.size(), values));
+    ASSERT_EQ(std::get<0>(values), "zero-copy");
+    ASSERT_EQ(reinterpret_cast<std::byte const*>(std::get<0>(values).data()), buffer.data() + sizeof(std::uint32_t));
+}
+
+TEST(serializer, MalformedInput)
+{
+    std::string text{"truncated"};
+    std::vector<std::byte> buffer(astl::serialized_size(text, 1));
+    astl::serialize(buffer.data(), text, 1);
+
+    std::tuple<std::string, int> values{};
+    ASSERT_FALSE(astl::deserialize(buffer.data(), buffer.data() + buffer.size() - 1, values));
+    std::tuple<std::string> tooShort{};
+    ASSERT_FALSE(astl::deserialize(buffer.data(), buffer.data() + buffer.size(), tooShort));
+    std::tuple<> empty{};
+    ASSERT_TRUE(astl::deserialize(buffer.data(), buffer.data(), empty));
+}
@@ -0,0 +1,178 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/signal_operators.h>
+#include <astl/event.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+    struct manual_clock
+    {
+        using duration = std::chrono::milliseconds;
+        using rep = duration::rep;
+        using period = duration::period;
+        using time_point = std::chrono::time_point<manual_clock>;
+        static constexpr bool is_steady = true;
+
+        static time_point now() noexcept { return current; }
+
+        static inline time_point current{};
+    };
+}
+
+TEST(signal_operators, FilterMap)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::event<MyEventTag, int>;
+    MyEvent myEvent{};
+    MyEvent::slot_type slot{};
+    std::vector<std::string> values;
+
+    (myEvent.sig() | astl::filter([](int const& v){ return v % 2 == 0; })
+                   | astl::map([](int const& v){ return std::to_string(v * 10); }))
+            .connect(slot, [&values](std::string const& s){ values.push_back(s); });
+    ASSERT_TRUE(slot.is_connected());
+
+    for (int i = 0; i < 5; ++i) {
+        myEvent.invoke(i);
+    }
+    ASSERT_EQ(values, (std::vector<std::string>{"0", "20", "40"}));
+}
+
+TEST(signal_operators, MapChangesArity)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::event<MyEventTag, int, int>;
+    MyEvent myEvent{};
+    astl::slot_holder sh{};
+    int sum{0};
+
+    ASSERT_TRUE((myEvent.sig() | astl::map([](int const& a, int const& b){ return a + b; }))
+            .connect(sh, [&sum](int const& v){ sum += v; }));
+    myEvent.invoke(1, 2);
+    myEvent.invoke(3, 4);
+    ASSERT_EQ(sum, 10);
+}
+
+TEST(signal_operators, Distinct)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::event<MyEventTag, int, std::string>;
+    MyEvent myEvent{};
+    MyEvent::slot_type slot{};
+    int count{0};
+
+    (myEvent.sig() | astl::distinct()).connect(slot, [&count](int const&, std::string const&){ ++count; });
+    myEvent.invoke(1, "a");
+    myEvent.invoke(1, "a");
+    myEvent.invoke(1, "b");
+    myEvent.invoke(1, "a");
+    myEvent.invoke(1, "a");
+    ASSERT_EQ(count, 3);
+}
+
+TEST(signal_operators, DistinctByKey)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::event<MyEventTag, int, std::string>;
+    MyEvent myEvent{};
+    MyEvent::slot_type slot{};
+    std::vector<std::string> values;
+
+    (myEvent.sig() | astl::distinct([](int const& i, std::string const&){ return i; }))
+            .connect(slot, [&values](int const&, std::string const& s){ values.push_back(s); });
+    myEvent.invoke(1, "a");
+    myEvent.invoke(1, "b");
+    myEvent.invoke(2, "c");
+    ASSERT_EQ(values, (std::vector<std::string>{"a", "c"}));
+}
+
+TEST(signal_operators, Throttle)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::event<MyEventTag, int>;
+    MyEvent myEvent{};
+    MyEvent::slot_type slot{};
+    std::vector<int> values;
+    manual_clock::current = manual_clock::time_point{};
+
+    (myEvent.sig() | astl::throttle<manual_clock>(std::chrono::milliseconds{10}))
+            .connect(slot, [&values](int const& v){ values.push_back(v); });
+    for (int i = 0; i < 6; ++i) {
+        myEvent.invoke(i);
+        manual_clock::current += std::chrono::milliseconds{4};
+    }
+    // events at 0ms, 4ms, ..., 20ms: only those at 0ms and 12ms are at least 10ms after the last passed one
+    ASSERT_EQ(values, (std::vector<int>{0, 3}));
+}
+
+TEST(signal_operators, Debounce)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::event<MyEventTag, int>;
+    MyEvent myEvent{};
+    MyEvent::slot_type slot{};
+    std::vector<int> values;
+    manual_clock::current = manual_clock::time_point{};
+
+    (myEvent.sig() | astl::debounce<manual_clock>(std::chrono::milliseconds{10}))
+            .connect(slot, [&values](int const& v){ values.push_back(v); });
+    for (int i = 0; i < 5; ++i) {
+        myEvent.invoke(i);
+        manual_clock::current += std::chrono::milliseconds{4};
+    }
+    manual_clock::current += std::chrono::milliseconds{10};
+    myEvent.invoke(5);
+    ASSERT_EQ(values, (std::vector<int>{0, 5}));
+}
+
+TEST(signal_operators, ForwardToEvent)
+{
+    struct MyEventTag{};
+    struct OtherEventTag{};
+    using MyEvent = astl::event<MyEventTag, int>;
+    using OtherEvent = astl::event<OtherEventTag, double>;
+    MyEvent myEvent{};
+    OtherEvent otherEvent{};
+    MyEvent::slot_type slot{};
+    double value{0.};
+    OtherEvent::slot_type otherSlot{[&value](double const& v){ value = v; }};
+    otherEvent.sig().connect(otherSlot);
+
+    (myEvent.sig() | astl::map([](int const& v){ return v / 2.; })
+                   | astl::filter([](double const& v){ return v > 1.; })
+                   | astl::distinct()
+                   | astl::throttle(std::chrono::hours{1})
+                   | astl::debounce(std::chrono::nanoseconds{0}))
+            .connect(slot, astl::forward_to(otherEvent));
+    myEvent.invoke(1);
+    ASSERT_DOUBLE_EQ(value, 0.);
+    myEvent.invoke(5);
+    ASSERT_DOUBLE_EQ(value, 2.5);
+    myEvent.invoke(7);
+    ASSERT_DOUBLE_EQ(value, 2.5);
+}
+
+TEST(signal_operators, FusedIntoSingleFunctor)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::event<MyEventTag, int>;
+    MyEvent myEvent{};
+    int result{0};
+    auto fused = (myEvent.sig() | astl::map([](int const& v){ return v + 1; })
+                                | astl::map([](int const& v){ return v * 2; }))
+            .fuse([&result](int const& v){ result = v; });
+    fused(3);
+    ASSERT_EQ(result, 8);
+}
@@ -0,0 +1,66 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/size_class_pool.h>
+#include <astl/testsupport/alloc_counter.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST(size_class_pool, ReusesFreedBlocks)
+{
+    auto p = astl::size_class_pool::allocate(48);
+    astl::size_class_pool::deallocate(p, 48);
+    void* q{nullptr};
+    ASTL_EXPECT_NO_ALLOC { q = astl::size_class_pool::allocate(60); }     // same size class
+    ASSERT_EQ(q, p);
+    astl::size_class_pool::deallocate(q, 60);
+    ASTL_EXPECT_ALLOCS(1) {
+        auto large = astl::size_class_pool::allocate(1000);
+        astl::size_class_pool::deallocate(large, 1000);
+    }
+}
+
+TEST(size_class_pool, OverAlignedBlocks)
+{
+    for (std::size_t alignment : {std::size_t{64}, std::size_t{256}, std::size_t{4096}}) {
+        auto p = astl::size_class_pool::allocate(48, alignment);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(p) % alignment, 0u);
+        astl::size_class_pool::deallocate(p, 48, alignment);
+    }
+}
+
+TEST(size_class_pool, BlocksFreedByOtherThreadReturn)
+{
+    constexpr std::size_t count = 1000;
+    std::vector<void*> blocks(count);
+    for (auto& b : blocks) {
+        b = astl::size_class_pool::allocate(200);
+    }
+    std::thread{[&blocks](){
+        for (auto b : blocks) {
+            astl::size_class_pool::deallocate(b, 200);
+        }
+    }}.join();
+
+    // all but the blocks cached by the consumer thread are taken from the shared list
+    astl::testsupport::alloc_counter counter{};
+    for (auto& b : blocks) {
+        b = astl::size_class_pool::allocate(200);
+    }
+    counter.stop();
+    ASSERT_LT(counter.allocations(), astl::size_class_pool::max_cached);
+    for (auto b : blocks) {
+        astl::size_class_pool::deallocate(b, 200);
+    }
+}
@@ -12,6 +12,7 @@
 #include <gtest/gtest.h>
 #include <astl/slot_holder.h>
 #include <astl/event.h>
+#include <astl/testsupport/alloc_counter.h>
 
 TEST(slot_holder, SingleSlot)
 {
@@ -96,3 +97,20 @@ TEST(slot_holder, ThreeSlots)
     ASSERT_EQ(valueStrb, "b");
     ASSERT_FLOAT_EQ(valueFloat, 1.4);
 }
+
+TEST(slot_holder, Allocations)
+{
+    astl::slot_holder sh;
+    struct MyEventTag{};
+    using MyEvent = astl::event<MyEventTag, int>;
+    MyEvent myEvent;
+    int value{0};
+
+    ASTL_EXPECT_ALLOCS(1) { sh.connect(myEvent.sig(), [&value](int const& v){value = v;}); }  // the slot item
+
+    ASTL_EXPECT_NO_ALLOC { myEvent.invoke(1); }
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(sh.is_connected(myEvent.sig()));
+    ASTL_EXPECT_NO_ALLOC { sh.disconnect(myEvent.sig()); }
+    ASSERT_FALSE(sh.is_connected(myEvent.sig()));
+}
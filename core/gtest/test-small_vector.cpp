@@ -0,0 +1,165 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/small_vector.h>
+#include <astl/testsupport/alloc_counter.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    //! Allocator counting its allocations.
+    template<typename T>
+    struct counting_allocator
+    {
+        using value_type = T;
+
+        counting_allocator(int* count) noexcept : count{count} {}
+
+        template<typename U>
+        counting_allocator(counting_allocator<U> const& other) noexcept : count{other.count} {}
+
+        T* allocate(std::size_t n)
+        {
+            ++*count;
+            return std::allocator<T>{}.allocate(n);
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept
+        {
+            std::allocator<T>{}.deallocate(p, n);
+        }
+
+        bool operator==(counting_allocator const& other) const noexcept { return count == other.count; }
+        bool operator!=(counting_allocator const& other) const noexcept { return count != other.count; }
+
+        int* count;
+    };
+}
+
+TEST(small_vector, InlineUntilCapacity)
+{
+    astl::small_vector<int, 4> v{};
+    ASTL_EXPECT_NO_ALLOC {
+        for (int i = 0; i < 4; ++i) {
+            v.push_back(i);
+        }
+    }
+    ASSERT_TRUE(v.is_inline());
+    ASTL_EXPECT_ALLOCS(1) { v.push_back(4); }
+    ASSERT_FALSE(v.is_inline());
+    ASSERT_EQ(v.size(), 5u);
+    ASSERT_GE(v.capacity(), 5u);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(v[i], i);
+    }
+    ASSERT_EQ(v.data() + 5, v.end());
+
+    v.resize(2);
+    v.shrink_to_fit();
+    ASSERT_TRUE(v.is_inline());
+    ASSERT_EQ(v, (astl::small_vector<int, 4>{0, 1}));
+}
+
+TEST(small_vector, InsertErase)
+{
+    astl::small_vector<std::string, 2> v{"b", "d"};
+    v.insert(v.begin(), "a");
+    v.insert(v.begin() + 2, "c");
+    v.emplace(v.end(), 1, 'e');
+    ASSERT_EQ(v, (astl::small_vector<std::string, 2>{"a", "b", "c", "d", "e"}));
+
+    auto i = v.erase(v.begin() + 1);
+    ASSERT_EQ(*i, "c");
+    v.erase(v.begin(), v.begin() + 2);
+    ASSERT_EQ(v, (astl::small_vector<std::string, 2>{"d", "e"}));
+    v.pop_back();
+    ASSERT_EQ(v.back(), "d");
+    v.clear();
+    ASSERT_TRUE(v.empty());
+}
+
+TEST(small_vector, PushBackOwnElement)
+{
+    astl::small_vector<std::string, 1> v{};
+    v.push_back(std::string(100, 'x'));
+    v.push_back(v.front());     // reallocates while the argument refers into the container
+    ASSERT_EQ(v[1], v[0]);
+}
+
+TEST(small_vector, CopyAndMove)
+{
+    astl::small_vector<std::unique_ptr<int>, 2> inlineValues{};
+    inlineValues.push_back(std::make_unique<int>(1));
+    auto moved = std::move(inlineValues);
+    ASSERT_TRUE(moved.is_inline());
+    ASSERT_EQ(*moved[0], 1);
+    ASSERT_TRUE(inlineValues.empty());
+
+    astl::small_vector<std::unique_ptr<int>, 2> heapValues{};
+    for (int i = 0; i < 3; ++i) {
+        heapValues.push_back(std::make_unique<int>(i));
+    }
+    auto data = heapValues.data();
+    ASTL_EXPECT_NO_ALLOC {
+        moved = std::move(heapValues);  // takes over the heap storage
+    }
+    ASSERT_EQ(moved.data(), data);
+    ASSERT_EQ(*moved[2], 2);
+
+    astl::small_vector<std::string, 2> strings{"a", "b", "c"};
+    auto copy = strings;
+    ASSERT_EQ(copy, strings);
+    copy = astl::small_vector<std::string, 2>{"x"};
+    ASSERT_EQ(copy.size(), 1u);
+}
+
+TEST(small_vector, Allocator)
+{
+    int count{0};
+    using vector_type = astl::small_vector<int, 2, counting_allocator<int>>;
+    vector_type v{counting_allocator<int>{&count}};
+    v.push_back(1);
+    v.push_back(2);
+    ASSERT_EQ(count, 0);
+    v.push_back(3);
+    ASSERT_EQ(count, 1);
+    v.reserve(100);
+    ASSERT_EQ(count, 2);
+    ASSERT_EQ(v.get_allocator().count, &count);
+}
+
+TEST(small_vector, MatchesVector)
+{
+    astl::small_vector<int, 3> v{};
+    std::vector<int> reference{};
+    unsigned seed{1};
+    for (int step = 0; step < 2000; ++step) {
+        seed = seed * 1103515245u + 12345u;
+        auto op = (seed >> 16) % 4;
+        auto pos = reference.empty() ? 0 : (seed >> 8) % reference.size();
+        if (op < 2 || reference.empty()) {
+            v.insert(v.begin() + pos, step);
+            reference.insert(reference.begin() + pos, step);
+        }
+        else if (op == 2) {
+            v.erase(v.begin() + pos);
+            reference.erase(reference.begin() + pos);
+        }
+        else {
+            v.push_back(step);
+            reference.push_back(step);
+        }
+        ASSERT_TRUE(std::equal(v.begin(), v.end(), reference.begin(), reference.end()));
+    }
+}
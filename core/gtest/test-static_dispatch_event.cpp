@@ -0,0 +1,81 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/static_dispatch_event.h>
+
+#include <string>
+#include <vector>
+
+TEST(static_dispatch_event, NoHandler)
+{
+    struct MyEventTag{};
+    astl::static_dispatch_event<MyEventTag> myEvent{};
+    myEvent.invoke(1);
+}
+
+TEST(static_dispatch_event, HandlersInOrder)
+{
+    struct MyEventTag{};
+    std::vector<std::string> calls;
+    auto myEvent = astl::make_static_dispatch_event<MyEventTag>(
+            [&calls](int const& i, std::string const& s){ calls.push_back("a" + std::to_string(i) + s); },
+            [&calls](int const& i, std::string const& s){ calls.push_back("b" + std::to_string(i) + s); });
+
+    myEvent.invoke(1, std::string{"x"});
+    myEvent.invoke(2, "y");
+    ASSERT_EQ(calls, (std::vector<std::string>{"a1x", "b1x", "a2y", "b2y"}));
+}
+
+TEST(static_dispatch_event, StatefulHandler)
+{
+    struct MyEventTag{};
+    struct counter {
+        void operator()() { ++count; }
+        int count{0};
+    };
+    astl::static_dispatch_event<MyEventTag, counter, counter> myEvent{};
+    myEvent.invoke();
+    myEvent.invoke();
+    ASSERT_EQ(myEvent.handler<0>().count, 2);
+    ASSERT_EQ(myEvent.handler<1>().count, 2);
+
+    astl::static_dispatch_event<MyEventTag, counter> single{counter{}};
+    single.invoke();
+    auto copy{single};
+    copy.invoke();
+    ASSERT_EQ(single.handler<0>().count, 1);
+    ASSERT_EQ(copy.handler<0>().count, 2);
+}
+
+TEST(static_dispatch_event, ForwardToDynamicSignal)
+{
+    struct MyEventTag{};
+    using Forwarder = astl::dynamic_forwarder<MyEventTag, int>;
+    int staticValue{0}, dynamicValue{0};
+    auto myEvent = astl::make_static_dispatch_event<MyEventTag>(
+            [&staticValue](int const& v){ staticValue = v; }, Forwarder{});
+
+    myEvent.invoke(1);
+    ASSERT_EQ(staticValue, 1);
+    ASSERT_EQ(dynamicValue, 0);
+
+    Forwarder::slot_type slot{[&dynamicValue](int const& v){ dynamicValue = v; }};
+    myEvent.handler<1>().sig().connect(slot);
+    myEvent.invoke(2);
+    ASSERT_EQ(staticValue, 2);
+    ASSERT_EQ(dynamicValue, 2);
+
+    slot.disconnect();
+    myEvent.invoke(3);
+    ASSERT_EQ(staticValue, 3);
+    ASSERT_EQ(dynamicValue, 2);
+}
@@ -0,0 +1,177 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/trace.h>
+#include <astl/event.h>
+#include <astl/recursive_event.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+    std::string trace_path(char const* name)
+    {
+        return ::testing::TempDir() + "astl-trace-" + std::to_string(::getpid()) + "-" + name;
+    }
+}
+
+TEST(trace, NotAttached)
+{
+    struct MyTag{};
+    ASSERT_EQ(astl::trace::buffer::current(), nullptr);
+    astl::trace::write_record<MyTag>(astl::trace::now(), 1, 2, astl::trace::dispatched);
+}
+
+TEST(trace, WriteAndRead)
+{
+    struct MyTag{};
+    auto path = trace_path("write");
+    {
+        astl::trace::buffer tb{};
+        ASSERT_TRUE(tb.open(path, 8));
+        tb.attach();
+        ASSERT_EQ(astl::trace::buffer::current(), &tb);
+        astl::trace::write_record<MyTag>(100, 3, 7, astl::trace::dispatched);
+        astl::trace::write_record<MyTag>(200, 4, 0, astl::trace::queued);
+    }
+    ASSERT_EQ(astl::trace::buffer::current(), nullptr);
+
+    astl::trace::reader reader{};
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.capacity(), 8u);
+    ASSERT_EQ(reader.written(), 2u);
+    std::vector<astl::trace::record> records;
+    reader.for_each([&records](std::uint64_t, astl::trace::record const& r){ records.push_back(r); });
+    ASSERT_EQ(records.size(), 2u);
+    ASSERT_EQ(records[0].timestamp, 100u);
+    ASSERT_EQ(records[0].slot_count, 3u);
+    ASSERT_EQ(records[0].duration, 7u);
+    ASSERT_EQ(records[1].flags, astl::trace::queued);
+    ASSERT_EQ(records[0].tag_id, astl::trace::tag_info<MyTag>::id());
+    ASSERT_STREQ(reader.tag_name(records[0].tag_id), typeid(MyTag).name());
+    ::unlink(path.c_str());
+}
+
+TEST(trace, RingOverwritesOldest)
+{
+    struct MyTag{};
+    auto path = trace_path("ring");
+    astl::trace::buffer tb{};
+    ASSERT_TRUE(tb.open(path, 3));  // rounded up to 4
+    tb.attach();
+    for (std::uint64_t i = 0; i < 10; ++i) {
+        astl::trace::write_record<MyTag>(i, 0, 0, astl::trace::dispatched);
+    }
+    tb.detach();
+
+    astl::trace::reader reader{};
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.capacity(), 4u);
+    ASSERT_EQ(reader.written(), 10u);
+    std::vector<std::uint64_t> timestamps;
+    reader.for_each([&timestamps](std::uint64_t index, astl::trace::record const& r){
+        ASSERT_EQ(index, r.timestamp);
+        timestamps.push_back(r.timestamp);
+    });
+    ASSERT_EQ(timestamps, (std::vector<std::uint64_t>{6, 7, 8, 9}));
+    ::unlink(path.c_str());
+}
+
+TEST(trace, TagsRegisteredPerBuffer)
+{
+    struct MyTag1{};
+    struct MyTag2{};
+    auto path1 = trace_path("tags1");
+    auto path2 = trace_path("tags2");
+    {
+        astl::trace::buffer tb{};
+        ASSERT_TRUE(tb.open(path1, 4));
+        tb.attach();
+        astl::trace::write_record<MyTag1>(1, 0, 0, astl::trace::dispatched);
+    }
+    {
+        astl::trace::buffer tb{};
+        ASSERT_TRUE(tb.open(path2, 4));
+        tb.attach();
+        astl::trace::write_record<MyTag1>(1, 0, 0, astl::trace::dispatched);
+        astl::trace::write_record<MyTag2>(2, 0, 0, astl::trace::dispatched);
+    }
+    astl::trace::reader reader1{}, reader2{};
+    ASSERT_TRUE(reader1.open(path1));
+    ASSERT_TRUE(reader2.open(path2));
+    ASSERT_NE(reader1.tag_name(astl::trace::tag_info<MyTag1>::id()), nullptr);
+    ASSERT_EQ(reader1.tag_name(astl::trace::tag_info<MyTag2>::id()), nullptr);
+    ASSERT_NE(reader2.tag_name(astl::trace::tag_info<MyTag1>::id()), nullptr);
+    ASSERT_NE(reader2.tag_name(astl::trace::tag_info<MyTag2>::id()), nullptr);
+    ::unlink(path1.c_str());
+    ::unlink(path2.c_str());
+}
+
+TEST(trace, Scope)
+{
+    struct MyTag{};
+    auto path = trace_path("scope");
+    astl::trace::buffer tb{};
+    ASSERT_TRUE(tb.open(path, 4));
+    tb.attach();
+    {
+        astl::trace::scope<MyTag> s{5};
+    }
+    tb.detach();
+    {
+        astl::trace::scope<MyTag> s{6};
+    }
+
+    astl::trace::reader reader{};
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.written(), 1u);
+    reader.for_each([](std::uint64_t, astl::trace::record const& r){
+        ASSERT_EQ(r.slot_count, 5u);
+        ASSERT_EQ(r.flags, astl::trace::dispatched);
+    });
+    ::unlink(path.c_str());
+}
+
+#ifdef ASTL_TRACE
+TEST(trace, EventInvocationsTraced)
+{
+    struct MyEventTag{};
+    using MyEvent = astl::recursive_event<MyEventTag, int>;
+    auto path = trace_path("events");
+    astl::trace::buffer tb{};
+    ASSERT_TRUE(tb.open(path, 16));
+    tb.attach();
+
+    MyEvent myEvent{};
+    MyEvent::slot_type slot{[&myEvent](int const& v){
+        if (v == 0) {
+            myEvent.invoke(1);
+        }
+    }};
+    myEvent.sig().connect(slot);
+    myEvent.invoke(0);
+    tb.detach();
+
+    astl::trace::reader reader{};
+    ASSERT_TRUE(reader.open(path));
+    std::vector<std::uint32_t> flags;
+    reader.for_each([&flags](std::uint64_t, astl::trace::record const& r){
+        ASSERT_EQ(r.tag_id, astl::trace::tag_info<MyEventTag>::id());
+        ASSERT_EQ(r.slot_count, 1u);
+        flags.push_back(r.flags);
+    });
+    // the queued record is written within the first dispatch and therefore comes before it
+    ASSERT_EQ(flags, (std::vector<std::uint32_t>{astl::trace::queued, astl::trace::dispatched,
+                                                 astl::trace::dispatched}));
+    ::unlink(path.c_str());
+}
+#endif
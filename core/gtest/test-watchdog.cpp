@@ -0,0 +1,253 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/watchdog.h>
+#include <astl/event.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct StallTag {};
+    struct OuterTag {};
+
+    using namespace std::chrono_literals;
+
+    struct collector
+    {
+        explicit collector(astl::watchdog::monitor& m)
+        {
+            m.on_stall([this](astl::watchdog::stall_report const& r){
+                std::lock_guard<std::mutex> lock{mutex};
+                reports.push_back(r);
+            });
+        }
+
+        std::vector<astl::watchdog::stall_report> get()
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            return reports;
+        }
+
+        std::vector<astl::watchdog::stall_report> wait(std::size_t count)
+        {
+            auto const deadline = std::chrono::steady_clock::now() + 2s;
+            while (get().size() < count && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(1ms);
+            }
+            return get();
+        }
+
+        std::mutex mutex{};
+        std::vector<astl::watchdog::stall_report> reports{};
+    };
+
+    astl::watchdog::options fast_options()
+    {
+        astl::watchdog::options o{};
+        o.threshold = 20ms;
+        o.report_interval = 0ms;
+        return o;
+    }
+}
+
+TEST(watchdog, NotAttached)
+{
+    ASSERT_EQ(astl::watchdog::heartbeat::current(), nullptr);
+    astl::watchdog::dispatch_scope<StallTag> scope{};
+    scope.enter(nullptr);
+
+    astl::watchdog::monitor monitor{};
+    astl::watchdog::heartbeat hb{monitor, "main"};
+    ASSERT_EQ(astl::watchdog::heartbeat::current(), nullptr);
+    hb.attach();
+    ASSERT_EQ(astl::watchdog::heartbeat::current(), &hb);
+    hb.detach();
+    ASSERT_EQ(astl::watchdog::heartbeat::current(), nullptr);
+}
+
+TEST(watchdog, StalledSlot)
+{
+    astl::watchdog::monitor monitor{fast_options()};
+    collector reports{monitor};
+    ASSERT_TRUE(monitor.start());
+    ASSERT_FALSE(monitor.start());
+    astl::watchdog::heartbeat hb{monitor, "worker"};
+    hb.attach();
+
+    int slot{0};
+    {
+        astl::watchdog::dispatch_scope<StallTag> scope{};
+        scope.enter(&slot);
+        std::this_thread::sleep_for(100ms);
+    }
+    auto result = reports.wait(1);
+    hb.detach();
+    monitor.stop();
+
+    ASSERT_EQ(result.size(), 1u);
+    ASSERT_EQ(result[0].thread, "worker");
+    ASSERT_NE(result[0].tag.find("StallTag"), std::string::npos);
+    ASSERT_EQ(result[0].slot, &slot);
+    ASSERT_GE(result[0].duration, 20ms);
+    ASSERT_TRUE(result[0].stack.empty());
+    ASSERT_EQ(monitor.stalls(), 1u);
+}
+
+TEST(watchdog, FastSlotsNotReported)
+{
+    astl::watchdog::monitor monitor{fast_options()};
+    collector reports{monitor};
+    ASSERT_TRUE(monitor.start());
+    astl::watchdog::heartbeat hb{monitor, "worker"};
+    hb.attach();
+
+    // the same slot invoked over and over is not one long running slot
+    int slot{0};
+    auto const end = std::chrono::steady_clock::now() + 100ms;
+    while (std::chrono::steady_clock::now() < end) {
+        astl::watchdog::dispatch_scope<StallTag> scope{};
+        scope.enter(&slot);
+        std::this_thread::sleep_for(100us);
+    }
+    hb.idle();
+    std::this_thread::sleep_for(50ms);
+    hb.detach();
+    monitor.stop();
+    ASSERT_TRUE(reports.get().empty());
+}
+
+TEST(watchdog, EventLoop)
+{
+    astl::watchdog::monitor monitor{fast_options()};
+    collector reports{monitor};
+    ASSERT_TRUE(monitor.start());
+    astl::watchdog::heartbeat hb{monitor, "loop"};
+    hb.attach();
+
+    hb.beat();
+    std::this_thread::sleep_for(60ms);
+    auto result = reports.wait(1);
+    ASSERT_EQ(result.size(), 1u);
+    ASSERT_EQ(result[0].thread, "loop");
+    ASSERT_TRUE(result[0].tag.empty());
+    ASSERT_EQ(result[0].slot, nullptr);
+
+    // waiting for events is no stall
+    hb.idle();
+    std::this_thread::sleep_for(60ms);
+    hb.detach();
+    monitor.stop();
+    ASSERT_EQ(reports.get().size(), 1u);
+}
+
+TEST(watchdog, NestedDispatchRestoresEnclosingSlot)
+{
+    astl::watchdog::monitor monitor{fast_options()};
+    collector reports{monitor};
+    ASSERT_TRUE(monitor.start());
+    astl::watchdog::heartbeat hb{monitor, "worker"};
+    hb.attach();
+
+    int outer{0};
+    int inner{0};
+    {
+        astl::watchdog::dispatch_scope<OuterTag> outer_scope{};
+        outer_scope.enter(&outer);
+        {
+            astl::watchdog::dispatch_scope<StallTag> inner_scope{};
+            inner_scope.enter(&inner);
+        }
+        std::this_thread::sleep_for(60ms);
+    }
+    auto result = reports.wait(1);
+    hb.detach();
+    monitor.stop();
+    ASSERT_EQ(result.size(), 1u);
+    ASSERT_EQ(result[0].slot, &outer);
+    ASSERT_NE(result[0].tag.find("OuterTag"), std::string::npos);
+}
+
+TEST(watchdog, RateLimited)
+{
+    auto o = fast_options();
+    o.report_interval = std::chrono::hours{1};
+    astl::watchdog::monitor monitor{o};
+    collector reports{monitor};
+    ASSERT_TRUE(monitor.start());
+    astl::watchdog::heartbeat hb{monitor, "worker"};
+    hb.attach();
+
+    int slot{0};
+    for (auto i = 0; i < 2; ++i) {
+        astl::watchdog::dispatch_scope<StallTag> scope{};
+        scope.enter(&slot);
+        std::this_thread::sleep_for(60ms);
+    }
+    hb.detach();
+    monitor.stop();
+    ASSERT_EQ(reports.get().size(), 1u);
+    ASSERT_EQ(monitor.stalls(), 2u);
+}
+
+TEST(watchdog, CaptureStack)
+{
+    auto o = fast_options();
+    o.capture_stack = true;
+    astl::watchdog::monitor monitor{o};
+    collector reports{monitor};
+    ASSERT_TRUE(monitor.start());
+    astl::watchdog::heartbeat hb{monitor, "worker"};
+    hb.attach();
+
+    int slot{0};
+    {
+        astl::watchdog::dispatch_scope<StallTag> scope{};
+        scope.enter(&slot);
+        // sleeping in steps, the stack signal interrupts the sleep
+        auto const end = std::chrono::steady_clock::now() + 100ms;
+        while (std::chrono::steady_clock::now() < end) {
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+    auto result = reports.wait(1);
+    hb.detach();
+    monitor.stop();
+    ASSERT_EQ(result.size(), 1u);
+    ASSERT_FALSE(result[0].stack.empty());
+}
+
+#ifdef ASTL_WATCHDOG
+TEST(watchdog, SignalDispatchReported)
+{
+    astl::watchdog::monitor monitor{fast_options()};
+    collector reports{monitor};
+    ASSERT_TRUE(monitor.start());
+    astl::watchdog::heartbeat hb{monitor, "dispatcher"};
+    hb.attach();
+
+    astl::event<StallTag, int> ev{};
+    astl::slot<StallTag, int> fast{[](int){}};
+    astl::slot<StallTag, int> slow{[](int){ std::this_thread::sleep_for(60ms); }};
+    ev.sig().connect(fast);
+    ev.sig().connect(slow);
+    ev.invoke(1);
+    auto result = reports.wait(1);
+    hb.detach();
+    monitor.stop();
+    ASSERT_EQ(result.size(), 1u);
+    ASSERT_EQ(result[0].slot, &slow);
+    ASSERT_NE(result[0].tag.find("StallTag"), std::string::npos);
+}
+#endif
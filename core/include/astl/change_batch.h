@@ -0,0 +1,66 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstdint>
+
+namespace astl {
+
+    //! Kind of a change record of an observable container.
+    enum class change_kind : std::uint8_t {
+        insert,     //!< elements have been inserted
+        erase,      //!< elements have been erased
+        update,     //!< elements have been assigned new values
+        reset,      //!< the content has been replaced, observers have to re-read the container
+    };
+
+    //! Scope merging all changes of an observable container (astl::observable_vector, astl::observable_map) into a
+    //! single notification dispatched when the outermost scope of the container ends.
+    //! \code
+    //! {
+    //!     astl::change_batch batch{model};
+    //!     for (auto i = 0u; i < 10000; ++i) {
+    //!         model.push_back(i);
+    //!     }
+    //! }   // one notification: insert [0, 10000)
+    //! \endcode
+    template<typename Container>
+    class change_batch
+    {
+    public:
+        explicit change_batch(Container& container);
+        ~change_batch() noexcept;
+
+        change_batch(change_batch const&) = delete;
+        change_batch& operator=(change_batch const&) = delete;
+
+    private:
+        Container& container_;
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl change_batch
+// ------------------------------------------------------------------------------------------------
+template<typename Container>
+    astl::change_batch<Container>::change_batch(Container& container)
+        : container_{container}
+{
+    container_.begin_batch();
+}
+
+template<typename Container>
+    astl::change_batch<Container>::~change_batch() noexcept
+{
+    container_.end_batch();
+}
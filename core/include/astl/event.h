@@ -12,7 +12,7 @@
 #pragma once
 
 #include <astl/signal.h>
-#include <cassert>
+#include <tuple>
 
 namespace astl {
 
@@ -44,16 +44,30 @@ namespace astl {
         //! Returns a reference to the signal associated with the event.
         signal_type& sig() noexcept;
 
-        //! Raises the event and propagates it along with the given data value to all connected slots.
+        //! Raises the event and propagates it along with the given data value to the connected slots in order of their
+        //! priority until one of them consumes it.
         //! Recursively calling invoke will result in undefined behavior and usually terminate the program.
+        //! \returns true if a slot consumed the event.
         template<typename...Args>
-        void invoke(Args&&...args) noexcept;
+        bool invoke(Args&&...args) noexcept;
+
+        //! Invokes the event with the data returned by factory, which is only called if a slot is connected. factory
+        //! returns the data value for a single data type and a std::tuple<Ts...> otherwise.
+        //! \returns true if a slot consumed the event.
+        template<typename F>
+        bool invoke_lazy(F&& factory) noexcept;
+
+        //! Returns whether a slot is connected.
+        [[nodiscard]] bool has_subscribers() const noexcept;
+
+        //! Installs handler void(bool present) called with true when the first slot connects and with false when the
+        //! last slot disconnects. Producers use it to start and stop expensive data sources; it is not called for the
+        //! slots connected when it is installed. An empty handler removes it.
+        template<typename F>
+        void on_presence(F handler) noexcept;
 
     private:
         signal_type signal_{};
-#ifndef NDEBUG
-        bool dispatching_{false};
-#endif
     };
 
 } // namespace astl
@@ -71,15 +85,44 @@ template<typename TAG, typename...Ts>
 
 template<typename TAG, typename...Ts>
     template<typename...Args>
-    void
+    bool
     astl::event<TAG, Ts...>::invoke(Args &&... args) noexcept
 {
-#ifndef NDEBUG
-    assert(!dispatching_);
-    dispatching_ = true;
-#endif
-    signal_.invoke(std::forward<Args>(args)...);
-#ifndef NDEBUG
-    dispatching_ = false;
-#endif
+    return signal_.invoke(std::forward<Args>(args)...);
+}
+
+template<typename TAG, typename...Ts>
+    template<typename F>
+    bool
+    astl::event<TAG, Ts...>::invoke_lazy(F&& factory) noexcept
+{
+    if (signal_.empty()) {
+        return false;
+    }
+    if constexpr (sizeof...(Ts) == 1) {
+        return signal_.invoke(factory());
+    }
+    else {
+        return std::apply([this](auto&&...args){ return signal_.invoke(std::forward<decltype(args)>(args)...); },
+                          factory());
+    }
 }
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::event<TAG, Ts...>::has_subscribers() const noexcept
+{
+    return !signal_.empty();
+}
+
+template<typename TAG, typename...Ts>
+    template<typename F>
+    void
+    astl::event<TAG, Ts...>::on_presence(F handler) noexcept
+{
+    signal_.set_presence_handler(std::move(handler));
+}
+
+#ifdef ASTL_EXTERN_TEMPLATES
+#include <astl/extern_templates.h>
+#endif
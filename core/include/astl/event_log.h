@@ -0,0 +1,532 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/mapped_file.h>
+#include <astl/serializer.h>
+#include <astl/signal.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <typeinfo>
+
+namespace astl {
+
+    //! Header at the start of an event log file.
+    struct event_log_header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+        std::atomic<std::uint64_t> end;     //!< file offset behind the last complete record
+        char tag[104];                      //!< (mangled) type name of the TAG of the recorded event
+    };
+    static_assert(sizeof(event_log_header) == 128);
+
+    //! Header of each record in an event log. The payload follows directly, the next record starts at the next
+    //! 8 byte boundary.
+    struct event_log_record
+    {
+        std::uint32_t size;         //!< payload size in bytes
+        std::uint32_t reserved;
+        std::uint64_t timestamp;    //!< nanoseconds since the log has been opened for writing
+    };
+    static_assert(sizeof(event_log_record) == 16);
+
+    constexpr char event_log_magic[8] = {'A', 'S', 'T', 'L', 'L', 'O', 'G', '\0'};
+    constexpr std::uint32_t event_log_version = 1;
+
+    //! Append-only writer of length-prefixed records into a memory-mapped event log file.
+    //! The end offset in the file header is updated after each complete record, so a log stays readable up to the
+    //! last complete record when the writing process crashes.
+    class event_log_writer
+    {
+    public:
+        explicit event_log_writer() noexcept = default;
+        ~event_log_writer() noexcept;
+
+        event_log_writer(event_log_writer const&) = delete;
+        event_log_writer& operator=(event_log_writer const&) = delete;
+
+        //! Creates (or truncates) the log file at path.
+        //! \param tag          Name of the recorded event's TAG, checked by readers.
+        //! \param capacity     Initial size of the mapping, the file grows when required.
+        bool open(std::string const& path, char const* tag, std::size_t capacity = 1u << 20u) noexcept;
+
+        //! Appends a record with size bytes payload that is written by write(std::byte*).
+        //! \returns false when the file could not be extended.
+        template<typename F>
+        bool append(std::uint64_t timestamp, std::size_t size, F write) noexcept;
+
+        //! Truncates the file to the written records and closes it.
+        void close() noexcept;
+
+        [[nodiscard]] bool is_open() const noexcept;
+
+        //! Returns the number of bytes written including the file header.
+        [[nodiscard]] std::size_t size() const noexcept;
+
+    private:
+        mapped_file file_{};
+        std::size_t end_{0};
+    };
+
+    //! Zero-copy reader of an event log. The payloads of the records are accessed directly in the mapping.
+    class event_log_reader
+    {
+    public:
+        struct entry
+        {
+            std::uint64_t timestamp;
+            std::byte const* data;
+            std::size_t size;
+        };
+
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = entry;
+            using difference_type = std::ptrdiff_t;
+            using pointer = entry const*;
+            using reference = entry const&;
+
+            iterator() noexcept = default;
+            iterator(std::byte const* pos, std::byte const* end) noexcept;
+
+            reference operator*() const noexcept;
+            pointer operator->() const noexcept;
+            iterator& operator++() noexcept;
+            iterator operator++(int) noexcept;
+            bool operator==(iterator const& other) const noexcept;
+            bool operator!=(iterator const& other) const noexcept;
+
+        private:
+            void load() noexcept;
+
+            std::byte const* pos_{nullptr};
+            std::byte const* end_{nullptr};
+            entry entry_{};
+        };
+
+        //! Opens the log at path. Returns false if it is no valid event log.
+        bool open(std::string const& path) noexcept;
+
+        //! Returns the TAG name stored by the writer.
+        [[nodiscard]] char const* tag() const noexcept;
+
+        [[nodiscard]] iterator begin() const noexcept;
+        [[nodiscard]] iterator end() const noexcept;
+
+    private:
+        mapped_file file_{};
+        std::byte const* begin_{nullptr};
+        std::byte const* end_{nullptr};
+    };
+
+    //! Records all invocations of a signal into an event log.
+    //! The data of the events is serialized with astl::serializer<Ts>, which can be specialized for own types.
+    //! \code
+    //! #include <astl/event_log.h>
+    //!
+    //! astl::event_recorder<SpeedEventFlag, float> recorder{};
+    //! recorder.open("/var/tmp/speed.log");
+    //! recorder.attach(speedEvent.sig());
+    //! \endcode
+    template<typename TAG, typename...Ts>
+    class event_recorder
+    {
+    public:
+        using signal_type = signal<TAG, Ts...>;
+
+        explicit event_recorder() noexcept;
+        ~event_recorder() = default;
+
+        event_recorder(event_recorder const&) = delete;
+        event_recorder& operator=(event_recorder const&) = delete;
+
+        //! Creates the log file. The timestamps of the records are relative to this call.
+        bool open(std::string const& path, std::size_t capacity = 1u << 20u) noexcept;
+
+        //! Starts recording the invocations of signal, stops recording any previously attached signal.
+        void attach(signal_type& signal) noexcept;
+
+        //! Stops recording.
+        void detach() noexcept;
+
+        //! Stops recording and truncates the log file to its written size.
+        void close() noexcept;
+
+        //! Number of recorded events.
+        [[nodiscard]] std::uint64_t recorded() const noexcept;
+
+        //! Number of events that could not be recorded because the log file could not grow.
+        [[nodiscard]] std::uint64_t failed() const noexcept;
+
+    private:
+        void record(Ts const&...args) noexcept;
+
+    private:
+        slot<TAG, Ts...> slot_;
+        event_log_writer writer_{};
+        std::chrono::steady_clock::time_point start_{};
+        std::uint64_t recorded_{0};
+        std::uint64_t failed_{0};
+    };
+
+    //! Timing of a replay.
+    enum class replay_mode {
+        original,   //!< invoke the events with the recorded time distances
+        scaled,     //!< invoke the events with the recorded time distances divided by replay_options::speed
+        max_speed,  //!< invoke the events as fast as possible
+    };
+
+    struct replay_options
+    {
+        replay_mode mode{replay_mode::max_speed};
+        double speed{1.0};
+    };
+
+    //! Result of a replay.
+    struct replay_stats
+    {
+        std::uint64_t events{0};
+        std::uint64_t bytes{0};
+        std::uint64_t errors{0};                    //!< records that could not be deserialized
+        std::chrono::nanoseconds elapsed{0};
+        std::chrono::nanoseconds latency_min{0};    //!< shortest time spent in a single invoke
+        std::chrono::nanoseconds latency_max{0};    //!< longest time spent in a single invoke
+        std::chrono::nanoseconds latency_total{0};
+        std::chrono::nanoseconds lateness_max{0};   //!< largest delay of an invoke against its schedule
+
+        //! Events per second.
+        [[nodiscard]] double throughput() const noexcept;
+        [[nodiscard]] std::chrono::nanoseconds latency_mean() const noexcept;
+    };
+
+    //! Replays an event log written by event_recorder<TAG, Ts...> through the invoke method of an event.
+    template<typename TAG, typename...Ts>
+    class event_replayer
+    {
+    public:
+        //! Opens the log at path. Returns false if the log has not been recorded for TAG.
+        bool open(std::string const& path) noexcept;
+
+        //! Invokes ev.invoke(Ts const&...) for every record of the log.
+        template<typename Event>
+        replay_stats replay(Event& ev, replay_options const& options = {}) noexcept;
+
+    private:
+        event_log_reader reader_{};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl event_log_writer
+// ------------------------------------------------------------------------------------------------
+inline astl::event_log_writer::~event_log_writer() noexcept
+{
+    close();
+}
+
+inline bool astl::event_log_writer::open(std::string const& path, char const* tag, std::size_t capacity) noexcept
+{
+    close();
+    if (capacity < sizeof(event_log_header)) {
+        capacity = sizeof(event_log_header);
+    }
+    if (!file_.open(path, 0) || !file_.resize(capacity)) {
+        return false;
+    }
+    std::memset(static_cast<void*>(file_.data()), 0, sizeof(event_log_header));
+    auto header = new (file_.data()) event_log_header{};
+    std::memcpy(header->magic, event_log_magic, sizeof(event_log_magic));
+    header->version = event_log_version;
+    std::strncpy(header->tag, tag, sizeof(header->tag) - 1);
+    end_ = sizeof(event_log_header);
+    header->end.store(end_, std::memory_order_release);
+    return true;
+}
+
+template<typename F>
+bool astl::event_log_writer::append(std::uint64_t timestamp, std::size_t size, F write) noexcept
+{
+    auto required = end_ + ((sizeof(event_log_record) + size + 7u) & ~std::size_t{7u});
+    if (required > file_.size()) {
+        auto capacity = file_.size() * 2;
+        if (!file_.resize(capacity < required ? required : capacity)) {
+            return false;
+        }
+    }
+    auto pos = file_.data() + end_;
+    auto record = new (pos) event_log_record{static_cast<std::uint32_t>(size), 0, timestamp};
+    write(pos + sizeof(*record));
+    end_ = required;
+    reinterpret_cast<event_log_header*>(file_.data())->end.store(end_, std::memory_order_release);
+    return true;
+}
+
+inline void astl::event_log_writer::close() noexcept
+{
+    if (file_.is_open()) {
+        file_.resize(end_);
+        file_.close();
+    }
+    end_ = 0;
+}
+
+inline bool astl::event_log_writer::is_open() const noexcept
+{
+    return file_.is_open();
+}
+
+inline std::size_t astl::event_log_writer::size() const noexcept
+{
+    return end_;
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl event_log_reader
+// ------------------------------------------------------------------------------------------------
+inline bool astl::event_log_reader::open(std::string const& path) noexcept
+{
+    begin_ = end_ = nullptr;
+    if (!file_.open_read_only(path) || file_.size() < sizeof(event_log_header)) {
+        return false;
+    }
+    auto header = reinterpret_cast<event_log_header const*>(file_.data());
+    if (std::memcmp(header->magic, event_log_magic, sizeof(event_log_magic)) != 0
+            || header->version != event_log_version) {
+        return false;
+    }
+    auto end = header->end.load(std::memory_order_acquire);
+    begin_ = file_.data() + sizeof(event_log_header);
+    end_ = file_.data() + (end < file_.size() ? end : file_.size());
+    return true;
+}
+
+inline char const* astl::event_log_reader::tag() const noexcept
+{
+    return reinterpret_cast<event_log_header const*>(file_.data())->tag;
+}
+
+inline astl::event_log_reader::iterator astl::event_log_reader::begin() const noexcept
+{
+    return iterator{begin_, end_};
+}
+
+inline astl::event_log_reader::iterator astl::event_log_reader::end() const noexcept
+{
+    return iterator{end_, end_};
+}
+
+inline astl::event_log_reader::iterator::iterator(std::byte const* pos, std::byte const* end) noexcept
+    : pos_{pos}
+    , end_{end}
+{
+    load();
+}
+
+inline astl::event_log_reader::iterator::reference astl::event_log_reader::iterator::operator*() const noexcept
+{
+    return entry_;
+}
+
+inline astl::event_log_reader::iterator::pointer astl::event_log_reader::iterator::operator->() const noexcept
+{
+    return &entry_;
+}
+
+inline astl::event_log_reader::iterator& astl::event_log_reader::iterator::operator++() noexcept
+{
+    // the padding of the last record may be cut off by a truncated file
+    auto padded = (sizeof(event_log_record) + entry_.size + 7u) & ~std::size_t{7u};
+    auto remaining = static_cast<std::size_t>(end_ - pos_);
+    pos_ += padded < remaining ? padded : remaining;
+    load();
+    return *this;
+}
+
+inline astl::event_log_reader::iterator astl::event_log_reader::iterator::operator++(int) noexcept
+{
+    auto result = *this;
+    ++*this;
+    return result;
+}
+
+inline bool astl::event_log_reader::iterator::operator==(iterator const& other) const noexcept
+{
+    return pos_ == other.pos_;
+}
+
+inline bool astl::event_log_reader::iterator::operator!=(iterator const& other) const noexcept
+{
+    return pos_ != other.pos_;
+}
+
+inline void astl::event_log_reader::iterator::load() noexcept
+{
+    if (static_cast<std::size_t>(end_ - pos_) < sizeof(event_log_record)) {
+        pos_ = end_;
+        return;
+    }
+    auto record = reinterpret_cast<event_log_record const*>(pos_);
+    if (record->size > static_cast<std::size_t>(end_ - pos_) - sizeof(event_log_record)) {
+        // truncated record - treat as end of log
+        pos_ = end_;
+        return;
+    }
+    entry_ = entry{record->timestamp, pos_ + sizeof(event_log_record), record->size};
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl event_recorder
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts>
+    astl::event_recorder<TAG, Ts...>::event_recorder() noexcept
+        : slot_{[this](Ts const&...args){ this->record(args...); }}
+{}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::event_recorder<TAG, Ts...>::open(std::string const& path, std::size_t capacity) noexcept
+{
+    start_ = std::chrono::steady_clock::now();
+    recorded_ = failed_ = 0;
+    return writer_.open(path, typeid(TAG).name(), capacity);
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::event_recorder<TAG, Ts...>::attach(signal_type& signal) noexcept
+{
+    signal.connect(slot_);
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::event_recorder<TAG, Ts...>::detach() noexcept
+{
+    slot_.disconnect();
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::event_recorder<TAG, Ts...>::close() noexcept
+{
+    detach();
+    writer_.close();
+}
+
+template<typename TAG, typename...Ts>
+    std::uint64_t
+    astl::event_recorder<TAG, Ts...>::recorded() const noexcept
+{
+    return recorded_;
+}
+
+template<typename TAG, typename...Ts>
+    std::uint64_t
+    astl::event_recorder<TAG, Ts...>::failed() const noexcept
+{
+    return failed_;
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::event_recorder<TAG, Ts...>::record(Ts const&...args) noexcept
+{
+    if (!writer_.is_open()) {
+        return;
+    }
+    auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+    auto ok = writer_.append(static_cast<std::uint64_t>(timestamp.count()), serialized_size(args...),
+                             [&args...](std::byte* out){ serialize(out, args...); });
+    if (ok) {
+        ++recorded_;
+    }
+    else {
+        ++failed_;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl replay_stats, event_replayer
+// ------------------------------------------------------------------------------------------------
+inline double astl::replay_stats::throughput() const noexcept
+{
+    return elapsed.count() ? static_cast<double>(events) * 1e9 / static_cast<double>(elapsed.count()) : 0.0;
+}
+
+inline std::chrono::nanoseconds astl::replay_stats::latency_mean() const noexcept
+{
+    return events ? latency_total / static_cast<std::chrono::nanoseconds::rep>(events) : std::chrono::nanoseconds{0};
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::event_replayer<TAG, Ts...>::open(std::string const& path) noexcept
+{
+    return reader_.open(path) && std::strncmp(reader_.tag(), typeid(TAG).name(), sizeof(event_log_header::tag) - 1) == 0;
+}
+
+template<typename TAG, typename...Ts>
+    template<typename Event>
+    astl::replay_stats
+    astl::event_replayer<TAG, Ts...>::replay(Event& ev, replay_options const& options) noexcept
+{
+    using clock = std::chrono::steady_clock;
+    replay_stats stats{};
+    stats.latency_min = std::chrono::nanoseconds::max();
+    auto speed = options.mode == replay_mode::scaled && options.speed > 0.0 ? options.speed : 1.0;
+    std::tuple<Ts...> values{};
+
+    auto start = clock::now();
+    for (auto const& e : reader_) {
+        if (!deserialize(e.data, e.data + e.size, values)) {
+            ++stats.errors;
+            continue;
+        }
+        if (options.mode != replay_mode::max_speed) {
+            auto due = start + std::chrono::duration_cast<clock::duration>(
+                    std::chrono::nanoseconds{static_cast<std::int64_t>(static_cast<double>(e.timestamp) / speed)});
+            auto now = clock::now();
+            if (now < due) {
+                std::this_thread::sleep_until(due);
+            }
+            else if (now - due > stats.lateness_max) {
+                stats.lateness_max = now - due;
+            }
+        }
+        auto before = clock::now();
+        std::apply([&ev](Ts const&...args){ ev.invoke(args...); }, values);
+        auto latency = clock::now() - before;
+
+        ++stats.events;
+        stats.bytes += e.size;
+        stats.latency_total += latency;
+        stats.latency_min = latency < stats.latency_min ? latency : stats.latency_min;
+        stats.latency_max = latency > stats.latency_max ? latency : stats.latency_max;
+    }
+    stats.elapsed = clock::now() - start;
+    if (stats.events == 0) {
+        stats.latency_min = std::chrono::nanoseconds{0};
+    }
+    return stats;
+}
@@ -0,0 +1,67 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/event.h>
+#include <string>
+
+//! \file
+//! Explicit instantiations of the event machinery for common payload types.
+//! Every translation unit using event<T, T> otherwise instantiates and compiles signal, slot, the std::function of the
+//! slot handler and the invoke paths itself. The compiled astl library instantiates them once for the types listed
+//! by ASTL_EXTERN_TEMPLATE_TYPES and defines ASTL_EXTERN_TEMPLATES for its users, which makes this header declare
+//! them extern. Other payload types are instantiated implicitly as before. Applications can do the same for their
+//! own types:
+//! \code
+//!     // my_types.h, after the definition of position
+//!     ASTL_DECLARE_EVENT_TEMPLATES(position, position)
+//!     // my_types.cpp
+//!     ASTL_INSTANTIATE_EVENT_TEMPLATES(position, position)
+//! \endcode
+//! Only the invoke overloads for T const&, T& and T&& arguments are covered, invocations with convertible types
+//! still instantiate invoke in the calling translation unit.
+
+//! Payload types instantiated by the astl library, X(TAG, T) for each.
+#define ASTL_EXTERN_TEMPLATE_TYPES(X) \
+    X(bool, bool)                     \
+    X(int, int)                       \
+    X(unsigned, unsigned)             \
+    X(long, long)                     \
+    X(unsigned long, unsigned long)   \
+    X(float, float)                   \
+    X(double, double)                 \
+    X(std::string, std::string)
+
+#define ASTL_EVENT_TEMPLATES_(EXTERN, TAG, T)                                                                     \
+    EXTERN template class std::function<astl::slot_result(T const&)>;                                             \
+    EXTERN template class astl::slot<TAG, T>;                                                                      \
+    EXTERN template class astl::signal<TAG, T>;                                                                    \
+    EXTERN template class astl::event<TAG, T>;                                                                     \
+    EXTERN template astl::slot_result astl::slot<TAG, T>::invoke<T const&>(T const&) noexcept;                     \
+    EXTERN template astl::slot_result astl::slot<TAG, T>::invoke<T&>(T&) noexcept;                                 \
+    EXTERN template astl::slot_result astl::slot<TAG, T>::invoke<T>(T&&) noexcept;                                 \
+    EXTERN template bool astl::signal<TAG, T>::invoke<T const&>(T const&) noexcept;                                \
+    EXTERN template bool astl::signal<TAG, T>::invoke<T&>(T&) noexcept;                                            \
+    EXTERN template bool astl::signal<TAG, T>::invoke<T>(T&&) noexcept;                                            \
+    EXTERN template bool astl::event<TAG, T>::invoke<T const&>(T const&) noexcept;                                 \
+    EXTERN template bool astl::event<TAG, T>::invoke<T&>(T&) noexcept;                                             \
+    EXTERN template bool astl::event<TAG, T>::invoke<T>(T&&) noexcept;
+
+//! Declares the instantiations of event<TAG, T>, its signal, slot and invoke overloads extern.
+#define ASTL_DECLARE_EVENT_TEMPLATES(TAG, T) ASTL_EVENT_TEMPLATES_(extern, TAG, T)
+
+//! Explicitly instantiates event<TAG, T>, its signal, slot and invoke overloads. Use in exactly one translation unit.
+#define ASTL_INSTANTIATE_EVENT_TEMPLATES(TAG, T) ASTL_EVENT_TEMPLATES_(, TAG, T)
+
+#ifdef ASTL_EXTERN_TEMPLATES
+ASTL_EXTERN_TEMPLATE_TYPES(ASTL_DECLARE_EVENT_TEMPLATES)
+#endif
@@ -0,0 +1,276 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace astl {
+
+    //! Associative container keeping its key-value pairs sorted by key in a contiguous sequence container.
+    //! Lookup is a binary search and iteration is contiguous; insertion and erasure move the elements behind the
+    //! position, which is cheap for the small maps it is meant for. With an astl::small_vector as Container small maps
+    //! do not allocate at all. Iterators are invalidated by insertion and erasure. The keys must not be modified
+    //! through iterators.
+    //! \code
+    //! #include <astl/flat_map.h>
+    //! #include <astl/small_vector.h>
+    //!
+    //! using entry = std::pair<int, std::string>;
+    //! astl::flat_map<int, std::string, std::less<int>, astl::small_vector<entry, 4>> names{};
+    //! names.insert_or_assign(2, "two");
+    //! names.try_emplace(1, "one");
+    //! for (auto const& [key, name] : names) { ... }   // 1, 2
+    //! \endcode
+    //!
+    //! \tparam K           Type of the keys.
+    //! \tparam V           Type of the mapped values.
+    //! \tparam Compare     Strict weak ordering of the keys.
+    //! \tparam Container   Sequence container of std::pair<K, V> with random access iterators.
+    template<typename K, typename V, typename Compare = std::less<K>,
+             typename Container = std::vector<std::pair<K, V>>>
+    class flat_map
+    {
+    public:
+        using key_type = K;
+        using mapped_type = V;
+        using value_type = std::pair<K, V>;
+        using key_compare = Compare;
+        using container_type = Container;
+        using size_type = std::size_t;
+        using iterator = typename Container::iterator;
+        using const_iterator = typename Container::const_iterator;
+
+        flat_map() = default;
+        explicit flat_map(Compare compare);
+
+        iterator begin() noexcept;
+        iterator end() noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator end() const noexcept;
+
+        [[nodiscard]] bool empty() const noexcept;
+        [[nodiscard]] size_type size() const noexcept;
+        void reserve(size_type capacity);
+        void clear() noexcept;
+
+        iterator find(K const& key);
+        const_iterator find(K const& key) const;
+        [[nodiscard]] bool contains(K const& key) const;
+
+        //! Returns the first element whose key is not less than key.
+        iterator lower_bound(K const& key);
+        const_iterator lower_bound(K const& key) const;
+
+        //! Returns the mapped value of key, inserts a default constructed one if there is none.
+        V& operator[](K const& key);
+
+        //! Inserts V(args...) for key unless key exists. \returns the element and whether it has been inserted.
+        template<typename...Args>
+        std::pair<iterator, bool> try_emplace(K const& key, Args&&...args);
+
+        //! Inserts or assigns value for key. \returns the element and whether it has been inserted.
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(K const& key, M&& value);
+
+        iterator erase(const_iterator pos);
+
+        //! Erases the element of key. \returns the number of erased elements.
+        size_type erase(K const& key);
+
+        //! Returns the underlying container.
+        Container const& container() const noexcept;
+
+    private:
+        bool equal(K const& lhs, K const& rhs) const;
+
+    private:
+        Container values_{};
+        Compare compare_{};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl flat_map
+// ------------------------------------------------------------------------------------------------
+template<typename K, typename V, typename Compare, typename Container>
+    astl::flat_map<K, V, Compare, Container>::flat_map(Compare compare)
+        : compare_{std::move(compare)}
+{}
+
+template<typename K, typename V, typename Compare, typename Container>
+    typename astl::flat_map<K, V, Compare, Container>::iterator
+    astl::flat_map<K, V, Compare, Container>::begin() noexcept
+{
+    return values_.begin();
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    typename astl::flat_map<K, V, Compare, Container>::iterator
+    astl::flat_map<K, V, Compare, Container>::end() noexcept
+{
+    return values_.end();
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    typename astl::flat_map<K, V, Compare, Container>::const_iterator
+    astl::flat_map<K, V, Compare, Container>::begin() const noexcept
+{
+    return values_.begin();
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    typename astl::flat_map<K, V, Compare, Container>::const_iterator
+    astl::flat_map<K, V, Compare, Container>::end() const noexcept
+{
+    return values_.end();
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    bool
+    astl::flat_map<K, V, Compare, Container>::empty() const noexcept
+{
+    return values_.empty();
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    std::size_t
+    astl::flat_map<K, V, Compare, Container>::size() const noexcept
+{
+    return values_.size();
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    void
+    astl::flat_map<K, V, Compare, Container>::reserve(size_type capacity)
+{
+    values_.reserve(capacity);
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    void
+    astl::flat_map<K, V, Compare, Container>::clear() noexcept
+{
+    values_.clear();
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    typename astl::flat_map<K, V, Compare, Container>::iterator
+    astl::flat_map<K, V, Compare, Container>::find(K const& key)
+{
+    auto i = lower_bound(key);
+    return i != end() && equal(i->first, key) ? i : end();
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    typename astl::flat_map<K, V, Compare, Container>::const_iterator
+    astl::flat_map<K, V, Compare, Container>::find(K const& key) const
+{
+    auto i = lower_bound(key);
+    return i != end() && equal(i->first, key) ? i : end();
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    bool
+    astl::flat_map<K, V, Compare, Container>::contains(K const& key) const
+{
+    return find(key) != end();
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    typename astl::flat_map<K, V, Compare, Container>::iterator
+    astl::flat_map<K, V, Compare, Container>::lower_bound(K const& key)
+{
+    return std::lower_bound(values_.begin(), values_.end(), key,
+                            [this](value_type const& v, K const& k){ return compare_(v.first, k); });
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    typename astl::flat_map<K, V, Compare, Container>::const_iterator
+    astl::flat_map<K, V, Compare, Container>::lower_bound(K const& key) const
+{
+    return std::lower_bound(values_.begin(), values_.end(), key,
+                            [this](value_type const& v, K const& k){ return compare_(v.first, k); });
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    V&
+    astl::flat_map<K, V, Compare, Container>::operator[](K const& key)
+{
+    return try_emplace(key).first->second;
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    template<typename...Args>
+    std::pair<typename astl::flat_map<K, V, Compare, Container>::iterator, bool>
+    astl::flat_map<K, V, Compare, Container>::try_emplace(K const& key, Args&&...args)
+{
+    auto i = lower_bound(key);
+    if (i != end() && equal(i->first, key)) {
+        return {i, false};
+    }
+    i = values_.insert(i, value_type(std::piecewise_construct, std::forward_as_tuple(key),
+                                     std::forward_as_tuple(std::forward<Args>(args)...)));
+    return {i, true};
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    template<typename M>
+    std::pair<typename astl::flat_map<K, V, Compare, Container>::iterator, bool>
+    astl::flat_map<K, V, Compare, Container>::insert_or_assign(K const& key, M&& value)
+{
+    auto i = lower_bound(key);
+    if (i != end() && equal(i->first, key)) {
+        i->second = std::forward<M>(value);
+        return {i, false};
+    }
+    i = values_.insert(i, value_type(key, std::forward<M>(value)));
+    return {i, true};
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    typename astl::flat_map<K, V, Compare, Container>::iterator
+    astl::flat_map<K, V, Compare, Container>::erase(const_iterator pos)
+{
+    return values_.erase(pos);
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    std::size_t
+    astl::flat_map<K, V, Compare, Container>::erase(K const& key)
+{
+    auto i = find(key);
+    if (i == end()) {
+        return 0;
+    }
+    values_.erase(i);
+    return 1;
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    Container const&
+    astl::flat_map<K, V, Compare, Container>::container() const noexcept
+{
+    return values_;
+}
+
+template<typename K, typename V, typename Compare, typename Container>
+    bool
+    astl::flat_map<K, V, Compare, Container>::equal(K const& lhs, K const& rhs) const
+{
+    return !compare_(lhs, rhs) && !compare_(rhs, lhs);
+}
@@ -0,0 +1,810 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/signal.h>
+#include <astl/size_class_pool.h>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace astl {
+
+    template<typename T> class future;
+    template<typename T> class promise;
+
+    namespace detail {
+        struct future_access;
+
+        template<typename T, typename F>
+        decltype(auto) invoke_continuation(F& f, T&& value);
+
+        template<typename T, typename F>
+        using continuation_result_t = std::conditional_t<
+            std::is_void_v<decltype(invoke_continuation(std::declval<F&>(), std::declval<T&&>()))>,
+            std::monostate,
+            std::decay_t<decltype(invoke_continuation(std::declval<F&>(), std::declval<T&&>()))>>;
+
+        template<typename...Ts>
+        struct signal_value { using type = std::tuple<Ts...>; };
+
+        template<typename T>
+        struct signal_value<T> { using type = T; };
+
+        template<>
+        struct signal_value<> { using type = std::monostate; };
+    }
+
+    //! Executor running functions immediately on the calling thread.
+    //! Executors passed to future::then() provide execute(F) taking a function void() that has to be called exactly
+    //! once, e.g. astl::actor runs it as a message of the actor.
+    struct inline_executor
+    {
+        template<typename F>
+        void execute(F&& f) const;
+    };
+
+    //! Shared state of a promise and its future.
+    //! A default constructed future_state can be embedded in an operation object and passed to the promise constructor,
+    //! so that a request/response round-trip needs no allocation. The operation object has to outlive the promise and
+    //! the future; reset() prepares the state for the next round-trip once both are gone.
+    //! Promises without state argument and the combinators take their states from astl::size_class_pool.
+    //! \tparam T   Type of the value.
+    template<typename T>
+    class future_state
+    {
+    public:
+        explicit future_state() noexcept = default;
+        ~future_state() noexcept;
+
+        future_state(future_state const&) = delete;
+        future_state& operator=(future_state const&) = delete;
+
+        //! Destroys the value and clears the state. Must not be called while a promise or future refers to the state.
+        void reset() noexcept;
+
+    protected:
+        using release_function = void (*)(future_state* state) noexcept;
+        using continuation_function = void (*)(void* context) noexcept;
+
+        //! Creates a reference counted state, release is called when the last reference is gone.
+        future_state(release_function release, unsigned references) noexcept;
+
+        template<typename...Args>
+        void set_value(Args&&...args);
+
+        void set_broken() noexcept;
+
+        void retain() noexcept;
+        void release() noexcept;
+
+    private:
+        friend class promise<T>;
+        friend class future<T>;
+        friend struct detail::future_access;
+
+        //! Sets the continuation, called by the completing thread or immediately if already complete.
+        void attach(continuation_function continuation, void* context) noexcept;
+        void complete(unsigned bit) noexcept;
+        T& value() noexcept;
+        [[nodiscard]] unsigned status() const noexcept;
+
+    private:
+        static constexpr unsigned value_bit = 1;
+        static constexpr unsigned broken_bit = 2;
+        static constexpr unsigned continuation_bit = 4;
+
+        std::atomic<unsigned> status_{0};
+        std::atomic<unsigned> references_{0};
+        release_function release_{nullptr};
+        continuation_function continuation_{nullptr};
+        void* context_{nullptr};
+        alignas(T) unsigned char storage_[sizeof(T)];
+    };
+
+    //! Result of an asynchronous operation that never blocks: the value is either polled by ready() and get() or passed
+    //! to a continuation attached by then(). Operations do not throw, a future becomes broken instead when its promise
+    //! is destroyed without setting a value.
+    //! \code
+    //! #include <astl/future.h>
+    //!
+    //! astl::promise<int> p{};
+    //! p.get_future()
+    //!     .then(actor, [](int v){ return std::to_string(v); })
+    //!     .then([](std::string s){ ... });
+    //! p.set_value(42);
+    //! \endcode
+    //! \tparam T   Type of the value. Continuations returning void produce a future<std::monostate>.
+    template<typename T>
+    class future
+    {
+    public:
+        using value_type = T;
+
+        explicit future() noexcept = default;
+        ~future() noexcept;
+
+        future(future&& other) noexcept;
+        future& operator=(future&& other) noexcept;
+
+        //! Returns whether the future refers to a state, i.e. has not been moved from or consumed by then().
+        [[nodiscard]] bool valid() const noexcept;
+
+        //! Returns whether the value has been set.
+        [[nodiscard]] bool ready() const noexcept;
+
+        //! Returns whether the promise has been destroyed without setting a value.
+        [[nodiscard]] bool broken() const noexcept;
+
+        //! Returns the value. Precondition: ready().
+        T& get() noexcept;
+
+        //! Returns a future of f(T&&) with f run by executor ex once the value is set; f() is called for a
+        //! future<std::monostate> if it takes no argument. A broken future skips f and breaks the returned future.
+        //! The state of the returned future is allocated from astl::size_class_pool. This future becomes invalid.
+        template<typename Executor, typename F>
+        future<detail::continuation_result_t<T, F>> then(Executor& ex, F f);
+
+        //! Like then(ex, f) with f run by the thread setting the value.
+        template<typename F>
+        future<detail::continuation_result_t<T, F>> then(F f);
+
+    private:
+        friend class promise<T>;
+        friend struct detail::future_access;
+
+        explicit future(future_state<T>* state) noexcept;
+
+    private:
+        future_state<T>* state_{nullptr};
+    };
+
+    //! Producer side of a future.
+    template<typename T>
+    class promise
+    {
+    public:
+        //! Creates a promise with a state from astl::size_class_pool.
+        explicit promise();
+
+        //! Creates a promise using the caller owned state, see astl::future_state.
+        explicit promise(future_state<T>& state) noexcept;
+
+        //! Breaks the future unless a value has been set.
+        ~promise() noexcept;
+
+        promise(promise&& other) noexcept;
+        promise& operator=(promise&& other) noexcept;
+
+        //! Returns the future. May be called once.
+        future<T> get_future() noexcept;
+
+        //! Sets the value constructed from args and runs the continuation. May be called once.
+        template<typename...Args>
+        void set_value(Args&&...args);
+
+    private:
+        future_state<T>* state_{nullptr};
+        bool retrieved_{false};
+    };
+
+    //! Returns a future of all values, complete when all futures are. Broken if one of the futures is broken.
+    template<typename...Ts>
+    future<std::tuple<Ts...>> when_all(future<Ts>...futures);
+
+    //! Returns a future of the first value set; the variant index tells which future. Broken if all are broken.
+    template<typename...Ts>
+    future<std::variant<Ts...>> when_any(future<Ts>...futures);
+
+    //! Returns a future of the data of the next invocation of signal: T for a signal<TAG, T>, std::tuple<Ts...> for
+    //! several and std::monostate for no data types. The future must be released by the thread invoking signal.
+    //! A future for a signal that is destroyed before its next invocation never becomes ready.
+    template<typename TAG, typename...Ts>
+    future<typename detail::signal_value<Ts...>::type> next_invocation(signal<TAG, Ts...>& signal);
+
+    namespace detail {
+
+        struct future_access
+        {
+            template<typename T>
+            static future<T> make(future_state<T>* state) noexcept;
+
+            template<typename T>
+            static void attach(future<T>& f, void (*continuation)(void*) noexcept, void* context) noexcept;
+        };
+
+        //! State allocated from size_class_pool, destroyed when the last reference is released.
+        template<typename Derived, typename T>
+        class pooled_future_state : public future_state<T>
+        {
+        public:
+            template<typename...Args>
+            static Derived* create(Args&&...args);
+
+        protected:
+            explicit pooled_future_state(unsigned references) noexcept;
+
+        private:
+            static void destroy(future_state<T>* state) noexcept;
+        };
+
+        template<typename T>
+        class promise_state : public pooled_future_state<promise_state<T>, T>
+        {
+        public:
+            promise_state() noexcept;
+        };
+
+        //! State of a future returned by future::then(); holds one reference for the future and one for itself
+        //! until the continuation has run.
+        template<typename T, typename Executor, typename F>
+        class then_state : public pooled_future_state<then_state<T, Executor, F>, continuation_result_t<T, F>>
+        {
+        public:
+            then_state(future<T> upstream, Executor& ex, F f) noexcept;
+            void start() noexcept;
+
+        private:
+            static void arrived(void* context) noexcept;
+            void run() noexcept;
+
+        private:
+            future<T> upstream_;
+            Executor* executor_;
+            F f_;
+        };
+
+        template<typename...Ts>
+        class when_all_state : public pooled_future_state<when_all_state<Ts...>, std::tuple<Ts...>>
+        {
+        public:
+            explicit when_all_state(future<Ts>...futures) noexcept;
+            void start() noexcept;
+
+        private:
+            static void arrived(void* context) noexcept;
+
+        private:
+            std::tuple<future<Ts>...> inputs_;
+            std::atomic<std::size_t> remaining_{sizeof...(Ts)};
+        };
+
+        template<typename...Ts>
+        class when_any_state : public pooled_future_state<when_any_state<Ts...>, std::variant<Ts...>>
+        {
+        public:
+            explicit when_any_state(future<Ts>...futures) noexcept;
+            void start() noexcept;
+
+        private:
+            template<std::size_t...Is>
+            void start(std::index_sequence<Is...>) noexcept;
+
+            template<std::size_t I>
+            static void arrived(void* context) noexcept;
+
+        private:
+            std::tuple<future<Ts>...> inputs_;
+            std::atomic<std::size_t> remaining_{sizeof...(Ts)};
+            std::atomic<bool> done_{false};
+        };
+
+        //! State connected to a signal until its next invocation. Only referenced by the future, the slot disconnects
+        //! when the future is released before.
+        template<typename TAG, typename...Ts>
+        class signal_state : public pooled_future_state<signal_state<TAG, Ts...>, typename signal_value<Ts...>::type>
+        {
+        public:
+            explicit signal_state(signal<TAG, Ts...>& sig) noexcept;
+
+        private:
+            void invoked(Ts const&...values) noexcept;
+
+        private:
+            slot<TAG, Ts...> slot_;
+        };
+
+    } // namespace detail
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl inline_executor
+// ------------------------------------------------------------------------------------------------
+template<typename F>
+    void
+    astl::inline_executor::execute(F&& f) const
+{
+    f();
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl future_state
+// ------------------------------------------------------------------------------------------------
+template<typename T>
+    astl::future_state<T>::future_state(release_function release, unsigned references) noexcept
+        : references_{references}
+        , release_{release}
+{}
+
+template<typename T>
+    astl::future_state<T>::~future_state() noexcept
+{
+    if (status() & value_bit) {
+        value().~T();
+    }
+}
+
+template<typename T>
+    void
+    astl::future_state<T>::reset() noexcept
+{
+    assert(references_.load() == 0);
+    if (status() & value_bit) {
+        value().~T();
+    }
+    status_.store(0, std::memory_order_relaxed);
+    continuation_ = nullptr;
+    context_ = nullptr;
+}
+
+template<typename T>
+    template<typename...Args>
+    void
+    astl::future_state<T>::set_value(Args&&...args)
+{
+    assert(!(status() & (value_bit | broken_bit)));
+    if constexpr (std::is_constructible_v<T, Args&&...>) {
+        new (storage_) T(std::forward<Args>(args)...);
+    }
+    else {
+        new (storage_) T{std::forward<Args>(args)...};
+    }
+    complete(value_bit);
+}
+
+template<typename T>
+    void
+    astl::future_state<T>::set_broken() noexcept
+{
+    complete(broken_bit);
+}
+
+template<typename T>
+    void
+    astl::future_state<T>::retain() noexcept
+{
+    references_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename T>
+    void
+    astl::future_state<T>::release() noexcept
+{
+    if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1 && release_) {
+        release_(this);
+    }
+}
+
+template<typename T>
+    void
+    astl::future_state<T>::attach(continuation_function continuation, void* context) noexcept
+{
+    assert(!continuation_);
+    continuation_ = continuation;
+    context_ = context;
+    if (status_.fetch_or(continuation_bit, std::memory_order_acq_rel) & (value_bit | broken_bit)) {
+        continuation(context);
+    }
+}
+
+template<typename T>
+    void
+    astl::future_state<T>::complete(unsigned bit) noexcept
+{
+    // whoever comes second of the completing and the attaching thread runs the continuation
+    if (status_.fetch_or(bit, std::memory_order_acq_rel) & continuation_bit) {
+        continuation_(context_);
+    }
+}
+
+template<typename T>
+    T&
+    astl::future_state<T>::value() noexcept
+{
+    return *std::launder(reinterpret_cast<T*>(storage_));
+}
+
+template<typename T>
+    unsigned
+    astl::future_state<T>::status() const noexcept
+{
+    return status_.load(std::memory_order_acquire);
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl future
+// ------------------------------------------------------------------------------------------------
+template<typename T>
+    astl::future<T>::future(future_state<T>* state) noexcept
+        : state_{state}
+{}
+
+template<typename T>
+    astl::future<T>::~future() noexcept
+{
+    if (state_) {
+        state_->release();
+    }
+}
+
+template<typename T>
+    astl::future<T>::future(future&& other) noexcept
+        : state_{std::exchange(other.state_, nullptr)}
+{}
+
+template<typename T>
+    astl::future<T>&
+    astl::future<T>::operator=(future&& other) noexcept
+{
+    if (this != &other) {
+        if (state_) {
+            state_->release();
+        }
+        state_ = std::exchange(other.state_, nullptr);
+    }
+    return *this;
+}
+
+template<typename T>
+    bool
+    astl::future<T>::valid() const noexcept
+{
+    return state_;
+}
+
+template<typename T>
+    bool
+    astl::future<T>::ready() const noexcept
+{
+    return state_ && (state_->status() & future_state<T>::value_bit);
+}
+
+template<typename T>
+    bool
+    astl::future<T>::broken() const noexcept
+{
+    return state_ && (state_->status() & future_state<T>::broken_bit);
+}
+
+template<typename T>
+    T&
+    astl::future<T>::get() noexcept
+{
+    assert(ready());
+    return state_->value();
+}
+
+template<typename T>
+    template<typename Executor, typename F>
+    astl::future<astl::detail::continuation_result_t<T, F>>
+    astl::future<T>::then(Executor& ex, F f)
+{
+    assert(valid());
+    auto state = detail::then_state<T, Executor, F>::create(std::move(*this), ex, std::move(f));
+    auto result = detail::future_access::make<detail::continuation_result_t<T, F>>(state);
+    state->start();
+    return result;
+}
+
+template<typename T>
+    template<typename F>
+    astl::future<astl::detail::continuation_result_t<T, F>>
+    astl::future<T>::then(F f)
+{
+    static inline_executor ex{};
+    return then(ex, std::move(f));
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl promise
+// ------------------------------------------------------------------------------------------------
+template<typename T>
+    astl::promise<T>::promise()
+        : state_{detail::promise_state<T>::create()}
+{}
+
+template<typename T>
+    astl::promise<T>::promise(future_state<T>& state) noexcept
+        : state_{&state}
+{
+    state.retain();
+}
+
+template<typename T>
+    astl::promise<T>::~promise() noexcept
+{
+    if (state_) {
+        if (!(state_->status() & future_state<T>::value_bit)) {
+            state_->set_broken();
+        }
+        state_->release();
+    }
+}
+
+template<typename T>
+    astl::promise<T>::promise(promise&& other) noexcept
+        : state_{std::exchange(other.state_, nullptr)}
+        , retrieved_{other.retrieved_}
+{}
+
+template<typename T>
+    astl::promise<T>&
+    astl::promise<T>::operator=(promise&& other) noexcept
+{
+    if (this != &other) {
+        promise discarded{std::move(*this)};
+        state_ = std::exchange(other.state_, nullptr);
+        retrieved_ = other.retrieved_;
+    }
+    return *this;
+}
+
+template<typename T>
+    astl::future<T>
+    astl::promise<T>::get_future() noexcept
+{
+    assert(state_ && !retrieved_);
+    retrieved_ = true;
+    state_->retain();
+    return future<T>{state_};
+}
+
+template<typename T>
+    template<typename...Args>
+    void
+    astl::promise<T>::set_value(Args&&...args)
+{
+    assert(state_);
+    state_->set_value(std::forward<Args>(args)...);
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl combinators
+// ------------------------------------------------------------------------------------------------
+template<typename...Ts>
+    astl::future<std::tuple<Ts...>>
+    astl::when_all(future<Ts>...futures)
+{
+    static_assert(sizeof...(Ts) > 0);
+    auto state = detail::when_all_state<Ts...>::create(std::move(futures)...);
+    auto result = detail::future_access::make<std::tuple<Ts...>>(state);
+    state->start();
+    return result;
+}
+
+template<typename...Ts>
+    astl::future<std::variant<Ts...>>
+    astl::when_any(future<Ts>...futures)
+{
+    static_assert(sizeof...(Ts) > 0);
+    auto state = detail::when_any_state<Ts...>::create(std::move(futures)...);
+    auto result = detail::future_access::make<std::variant<Ts...>>(state);
+    state->start();
+    return result;
+}
+
+template<typename TAG, typename...Ts>
+    astl::future<typename astl::detail::signal_value<Ts...>::type>
+    astl::next_invocation(signal<TAG, Ts...>& signal)
+{
+    auto state = detail::signal_state<TAG, Ts...>::create(signal);
+    return detail::future_access::make<typename detail::signal_value<Ts...>::type>(state);
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl detail
+// ------------------------------------------------------------------------------------------------
+template<typename T, typename F>
+    decltype(auto)
+    astl::detail::invoke_continuation(F& f, T&& value)
+{
+    if constexpr (std::is_same_v<std::decay_t<T>, std::monostate> && std::is_invocable_v<F&>) {
+        return f();
+    }
+    else {
+        return f(std::move(value));
+    }
+}
+
+template<typename T>
+    astl::future<T>
+    astl::detail::future_access::make(future_state<T>* state) noexcept
+{
+    return future<T>{state};
+}
+
+template<typename T>
+    void
+    astl::detail::future_access::attach(future<T>& f, void (*continuation)(void*) noexcept, void* context) noexcept
+{
+    f.state_->attach(continuation, context);
+}
+
+template<typename Derived, typename T>
+    template<typename...Args>
+    Derived*
+    astl::detail::pooled_future_state<Derived, T>::create(Args&&...args)
+{
+    auto p = size_class_pool::allocate(sizeof(Derived), alignof(Derived));
+    return new (p) Derived(std::forward<Args>(args)...);
+}
+
+template<typename Derived, typename T>
+    astl::detail::pooled_future_state<Derived, T>::pooled_future_state(unsigned references) noexcept
+        : future_state<T>{&destroy, references}
+{}
+
+template<typename Derived, typename T>
+    void
+    astl::detail::pooled_future_state<Derived, T>::destroy(future_state<T>* state) noexcept
+{
+    auto derived = static_cast<Derived*>(state);
+    derived->~Derived();
+    size_class_pool::deallocate(derived, sizeof(Derived), alignof(Derived));
+}
+
+template<typename T>
+    astl::detail::promise_state<T>::promise_state() noexcept
+        : pooled_future_state<promise_state<T>, T>{1}
+{}
+
+template<typename T, typename Executor, typename F>
+    astl::detail::then_state<T, Executor, F>::then_state(future<T> upstream, Executor& ex, F f) noexcept
+        : pooled_future_state<then_state<T, Executor, F>, continuation_result_t<T, F>>{2}
+        , upstream_{std::move(upstream)}
+        , executor_{&ex}
+        , f_{std::move(f)}
+{}
+
+template<typename T, typename Executor, typename F>
+    void
+    astl::detail::then_state<T, Executor, F>::start() noexcept
+{
+    future_access::attach(upstream_, &arrived, this);
+}
+
+template<typename T, typename Executor, typename F>
+    void
+    astl::detail::then_state<T, Executor, F>::arrived(void* context) noexcept
+{
+    auto self = static_cast<then_state*>(context);
+    self->executor_->execute([self](){ self->run(); });
+}
+
+template<typename T, typename Executor, typename F>
+    void
+    astl::detail::then_state<T, Executor, F>::run() noexcept
+{
+    using result_type = decltype(invoke_continuation(f_, std::move(upstream_.get())));
+    if (upstream_.broken()) {
+        this->set_broken();
+    }
+    else if constexpr (std::is_void_v<result_type>) {
+        invoke_continuation(f_, std::move(upstream_.get()));
+        this->set_value();
+    }
+    else {
+        this->set_value(invoke_continuation(f_, std::move(upstream_.get())));
+    }
+    upstream_ = future<T>{};
+    this->release();
+}
+
+template<typename...Ts>
+    astl::detail::when_all_state<Ts...>::when_all_state(future<Ts>...futures) noexcept
+        : pooled_future_state<when_all_state<Ts...>, std::tuple<Ts...>>{2}
+        , inputs_{std::move(futures)...}
+{}
+
+template<typename...Ts>
+    void
+    astl::detail::when_all_state<Ts...>::start() noexcept
+{
+    std::apply([this](future<Ts>&...inputs){ (future_access::attach(inputs, &arrived, this), ...); }, inputs_);
+}
+
+template<typename...Ts>
+    void
+    astl::detail::when_all_state<Ts...>::arrived(void* context) noexcept
+{
+    auto self = static_cast<when_all_state*>(context);
+    if (self->remaining_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    std::apply([self](future<Ts>&...inputs){
+        if ((inputs.broken() || ...)) {
+            self->set_broken();
+        }
+        else {
+            self->set_value(std::move(inputs.get())...);
+        }
+        ((inputs = future<Ts>{}), ...);
+    }, self->inputs_);
+    self->release();
+}
+
+template<typename...Ts>
+    astl::detail::when_any_state<Ts...>::when_any_state(future<Ts>...futures) noexcept
+        : pooled_future_state<when_any_state<Ts...>, std::variant<Ts...>>{2}
+        , inputs_{std::move(futures)...}
+{}
+
+template<typename...Ts>
+    void
+    astl::detail::when_any_state<Ts...>::start() noexcept
+{
+    start(std::index_sequence_for<Ts...>{});
+}
+
+template<typename...Ts>
+    template<std::size_t...Is>
+    void
+    astl::detail::when_any_state<Ts...>::start(std::index_sequence<Is...>) noexcept
+{
+    (future_access::attach(std::get<Is>(inputs_), &arrived<Is>, this), ...);
+}
+
+template<typename...Ts>
+    template<std::size_t I>
+    void
+    astl::detail::when_any_state<Ts...>::arrived(void* context) noexcept
+{
+    auto self = static_cast<when_any_state*>(context);
+    auto& input = std::get<I>(self->inputs_);
+    if (!input.broken() && !self->done_.exchange(true, std::memory_order_acq_rel)) {
+        self->set_value(std::in_place_index<I>, std::move(input.get()));
+    }
+    // the last arriving input releases all of them, the others are done with their input by then
+    if (self->remaining_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    if (!self->done_.load(std::memory_order_acquire)) {
+        self->set_broken();
+    }
+    std::apply([](future<Ts>&...inputs){ ((inputs = future<Ts>{}), ...); }, self->inputs_);
+    self->release();
+}
+
+template<typename TAG, typename...Ts>
+    astl::detail::signal_state<TAG, Ts...>::signal_state(signal<TAG, Ts...>& sig) noexcept
+        : pooled_future_state<signal_state<TAG, Ts...>, typename signal_value<Ts...>::type>{1}
+        , slot_{[this](Ts const&...values){ invoked(values...); }}
+{
+    sig.connect(slot_);
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::detail::signal_state<TAG, Ts...>::invoked(Ts const&...values) noexcept
+{
+    // the continuation may release the future and with it this state
+    slot_.disconnect();
+    this->retain();
+    this->set_value(values...);
+    this->release();
+}
@@ -0,0 +1,217 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace astl {
+
+    //! A mapped_file object maps a whole file into memory (MAP_SHARED).
+    //! Writes to a read-write mapping land in the page cache of the file and therefore survive a crash of the
+    //! writing process. All methods report failures by their return value and leave errno as set by the failing
+    //! system call.
+    //! \code
+    //! #include <astl/mapped_file.h>
+    //!
+    //! astl::mapped_file mf{};
+    //! if (mf.open("/tmp/data.bin", 4096)) {
+    //!     mf.data()[0] = std::byte{1};
+    //! }
+    //! \endcode
+    class mapped_file
+    {
+    public:
+        explicit mapped_file() noexcept = default;
+        ~mapped_file() noexcept;
+
+        mapped_file(mapped_file const&) = delete;
+        mapped_file& operator=(mapped_file const&) = delete;
+
+        mapped_file(mapped_file&& other) noexcept;
+        mapped_file& operator=(mapped_file&& other) noexcept;
+
+        //! Opens (and creates if required) the file at path for reading and writing and maps it.
+        //! \param size     Minimum size of the file. A smaller file is extended with zero bytes, a size of 0 maps the
+        //!                 file with its current size.
+        //! \returns true when the file has been mapped, otherwise false.
+        bool open(std::string const& path, std::size_t size) noexcept;
+
+        //! Opens the existing file at path read-only and maps it with its current size.
+        bool open_read_only(std::string const& path) noexcept;
+
+        //! Changes the size of a read-write mapping. Pointers obtained by data() before are invalidated.
+        bool resize(std::size_t size) noexcept;
+
+        //! Flushes the mapped pages to the file. Only needed for durability against OS crashes.
+        bool sync() noexcept;
+
+        //! Unmaps and closes the file. Does nothing when no file is open.
+        void close() noexcept;
+
+        [[nodiscard]] bool is_open() const noexcept;
+        [[nodiscard]] bool is_writable() const noexcept;
+        [[nodiscard]] std::byte* data() const noexcept;
+        [[nodiscard]] std::size_t size() const noexcept;
+
+    private:
+        bool map(std::size_t size, bool writable) noexcept;
+
+    private:
+        int fd_{-1};
+        std::byte* data_{nullptr};
+        std::size_t size_{0};
+        bool writable_{false};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl mapped_file
+// ------------------------------------------------------------------------------------------------
+inline astl::mapped_file::~mapped_file() noexcept
+{
+    close();
+}
+
+inline astl::mapped_file::mapped_file(mapped_file&& other) noexcept
+    : fd_{std::exchange(other.fd_, -1)}
+    , data_{std::exchange(other.data_, nullptr)}
+    , size_{std::exchange(other.size_, 0)}
+    , writable_{std::exchange(other.writable_, false)}
+{}
+
+inline astl::mapped_file& astl::mapped_file::operator=(mapped_file&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        fd_ = std::exchange(other.fd_, -1);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        writable_ = std::exchange(other.writable_, false);
+    }
+    return *this;
+}
+
+inline bool astl::mapped_file::open(std::string const& path, std::size_t size) noexcept
+{
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) {
+        close();
+        return false;
+    }
+    auto current = static_cast<std::size_t>(st.st_size);
+    if (current < size && ::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        close();
+        return false;
+    }
+    return map(current < size ? size : current, true);
+}
+
+inline bool astl::mapped_file::open_read_only(std::string const& path) noexcept
+{
+    close();
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        return false;
+    }
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) {
+        close();
+        return false;
+    }
+    return map(static_cast<std::size_t>(st.st_size), false);
+}
+
+inline bool astl::mapped_file::resize(std::size_t size) noexcept
+{
+    if (fd_ < 0 || !writable_ || size == 0) {
+        return false;
+    }
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        return false;
+    }
+    if (data_) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+    return map(size, true);
+}
+
+inline bool astl::mapped_file::sync() noexcept
+{
+    return data_ && ::msync(data_, size_, MS_SYNC) == 0;
+}
+
+inline void astl::mapped_file::close() noexcept
+{
+    if (data_) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+    writable_ = false;
+}
+
+inline bool astl::mapped_file::is_open() const noexcept
+{
+    return fd_ >= 0;
+}
+
+inline bool astl::mapped_file::is_writable() const noexcept
+{
+    return writable_;
+}
+
+inline std::byte* astl::mapped_file::data() const noexcept
+{
+    return data_;
+}
+
+inline std::size_t astl::mapped_file::size() const noexcept
+{
+    return size_;
+}
+
+inline bool astl::mapped_file::map(std::size_t size, bool writable) noexcept
+{
+    writable_ = writable;
+    if (size == 0) {
+        // empty files cannot be mapped, but are a valid (empty) mapping
+        return true;
+    }
+    auto prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* p = ::mmap(nullptr, size, prot, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data_ = static_cast<std::byte*>(p);
+    size_ = size;
+    return true;
+}
@@ -11,8 +11,8 @@
 // If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
+#include <astl/small_vector.h>
 #include <functional>
-#include <vector>
 
 namespace astl {
 
@@ -54,16 +54,16 @@ namespace astl {
         void append(F f) noexcept;
 
     private:
-        std::vector<std::function<void()>> functors_;
+        small_vector<std::function<void()>, 2> functors_;
     };
 
 } // namespace astl
 
-astl::multi_final::multi_final()
+inline astl::multi_final::multi_final()
     : functors_{}
 {}
 
-astl::multi_final::~multi_final() noexcept {
+inline astl::multi_final::~multi_final() noexcept {
     for (auto const &f : functors_) {
         f();
     }
@@ -76,7 +76,7 @@ astl::multi_final::multi_final(F f) noexcept
     append(f);
 }
 
-void astl::multi_final::reset() noexcept
+inline void astl::multi_final::reset() noexcept
 {
     functors_.clear();
 }
@@ -0,0 +1,144 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/signal.h>
+#include <astl/small_vector.h>
+#include <cstddef>
+#include <tuple>
+
+namespace astl {
+
+    //! Event delivering reentrant invocations depth-first.
+    //! An invocation from within a slot is dispatched immediately to the current slots, before invoke returns to the
+    //! slot - unlike astl::recursive_event, which queues it until the outer dispatch finishes. Each nesting level keeps
+    //! its own position in the slot table on its stack frame. A slot disconnected at any level is skipped by all
+    //! levels; slots connected while dispatching receive the invocations after the outermost level has finished,
+    //! which is also when the slot table is cleaned up.
+    //! Nesting costs no heap allocation. Invocations beyond max_depth levels are queued - that allocates once
+    //! more than two are pending - and dispatched when the deepest level returns.
+    //! \code
+    //! #include <astl/nested_event.h>
+    //!
+    //! astl::nested_event<PathTag, std::string> visit{};
+    //! decltype(visit)::slot_type walker{[&visit](std::string const& path){
+    //!     for (auto const& child : children(path)) {
+    //!         visit.invoke(child);     // the children are visited before the next sibling
+    //!     }
+    //! }};
+    //! \endcode
+    //!
+    //! \tparam Ts      Types of data associated with an event. Maybe empty.
+    //! \tparam TAG     Tagging type to distinguish events using the same data type T. Defaults to T.
+    //!
+    //! \see \link signal-slot Event Delegation
+    template<typename TAG, typename...Ts>
+    class nested_event
+    {
+    public:
+        using value_type = std::tuple<Ts...>;
+        using signal_type = signal<TAG, Ts...>;
+        using slot_type = slot<TAG, Ts...>;
+
+        static constexpr std::size_t default_max_depth = 16;
+
+        //! \param max_depth    Maximal number of nested dispatch levels, at least 1.
+        explicit nested_event(std::size_t max_depth = default_max_depth) noexcept;
+        ~nested_event() = default;
+
+        nested_event(nested_event const&) = delete;
+        nested_event& operator=(nested_event const&) = delete;
+
+        //! Returns a reference to the signal associated with the event.
+        signal_type& sig() noexcept;
+
+        //! Raises the event and propagates it to the connected slots in order of their priority until one of them
+        //! consumes it. May be called from within the slots.
+        //! \returns true if a slot consumed the event, false if none did or the invocation was queued.
+        template<typename...Args>
+        bool invoke(Args&&...args) noexcept;
+
+        //! Number of dispatch levels currently active, 0 outside of dispatch.
+        [[nodiscard]] std::size_t depth() const noexcept;
+
+    private:
+        signal_type signal_{};
+        std::size_t const max_depth_;
+        std::size_t depth_{0};
+        small_vector<value_type, 2> overflow_{};     // invocations beyond max_depth_, FIFO
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl nested_event
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts>
+    astl::nested_event<TAG, Ts...>::nested_event(std::size_t max_depth) noexcept
+        : max_depth_{max_depth > 0 ? max_depth : 1}
+{}
+
+template<typename TAG, typename...Ts>
+    typename astl::nested_event<TAG, Ts...>::signal_type&
+    astl::nested_event<TAG, Ts...>::sig() noexcept
+{
+    return signal_;
+}
+
+template<typename TAG, typename...Ts>
+    template<typename...Args>
+    bool
+    astl::nested_event<TAG, Ts...>::invoke(Args &&... args) noexcept
+{
+    if (depth_ == max_depth_) {
+#ifdef ASTL_TRACE
+        trace::write_record<TAG>(trace::now(), signal_.slot_count(), 0, trace::queued);
+#endif
+        overflow_.emplace_back(std::forward<Args>(args)...);
+        return false;
+    }
+    if (depth_ == 0 && signal_.empty()) {
+        return false;
+    }
+
+    bool consumed;
+    {
+#ifdef ASTL_TRACE
+        trace::scope<TAG> trace_scope{signal_.slot_count()};
+#endif
+        if (depth_++ == 0) {
+            signal_.begin_dispatch();
+        }
+        consumed = signal_.dispatch(std::forward<Args>(args)...);
+    }
+
+    if (depth_ == max_depth_) {
+        // the deepest level delivers what its slots queued
+        for (std::size_t i = 0; i < overflow_.size(); ++i) {
+            // move out, invocations from the slots may grow the queue and relocate its elements
+            auto current = std::move(overflow_[i]);
+            std::apply([this](Ts const&...values){ this->signal_.dispatch(values...); }, current);
+        }
+        overflow_.clear();
+    }
+    if (--depth_ == 0) {
+        signal_.end_dispatch();
+    }
+    return consumed;
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::nested_event<TAG, Ts...>::depth() const noexcept
+{
+    return depth_;
+}
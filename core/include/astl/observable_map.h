@@ -0,0 +1,330 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/change_batch.h>
+#include <astl/recursive_event.h>
+#include <cassert>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace astl {
+
+    //! Change record of an observable_map. Reset records carry a default constructed key.
+    template<typename K>
+    struct map_change
+    {
+        change_kind kind;
+        K key;
+
+        bool operator==(map_change const& other) const
+        {
+            return kind == other.kind && key == other.key;
+        }
+    };
+
+    //! Unordered map notifying its changes per key.
+    //! Every modification outside of a change_batch results in one notification. Inside a change_batch the changes of
+    //! each key are merged into their net effect and notified once when the batch ends, e.g. insert followed by erase
+    //! of a key results in no record at all, erase followed by insert in an update record. The records are ordered by
+    //! the first change of their key. A reset record replaces all others when the map has been cleared or reassigned.
+    //! \code
+    //! #include <astl/observable_map.h>
+    //!
+    //! astl::observable_map<std::string, int> model{};
+    //! model.sig().connect(slot);
+    //! {
+    //!     astl::change_batch batch{model};
+    //!     model.insert_or_assign("a", 1);
+    //!     model.insert_or_assign("a", 2);
+    //! }   // one notification: insert "a"
+    //! \endcode
+    //!
+    //! \tparam K       Type of the keys.
+    //! \tparam V       Type of the mapped values.
+    //! \tparam TAG     Tagging type of the change event. Defaults to V.
+    template<typename K, typename V, typename TAG = V>
+    class observable_map
+    {
+    public:
+        using key_type = K;
+        using mapped_type = V;
+        using map_type = std::unordered_map<K, V>;
+        using changes_type = std::vector<map_change<K>>;
+        using signal_type = typename recursive_event<TAG, changes_type>::signal_type;
+        using slot_type = typename recursive_event<TAG, changes_type>::slot_type;
+        using const_iterator = typename map_type::const_iterator;
+
+        explicit observable_map() = default;
+        explicit observable_map(map_type values);
+
+        observable_map(observable_map const&) = delete;
+        observable_map& operator=(observable_map const&) = delete;
+
+        //! Returns the signal of the change event.
+        signal_type& sig() noexcept;
+
+        [[nodiscard]] map_type const& get() const noexcept;
+        [[nodiscard]] std::size_t size() const noexcept;
+        [[nodiscard]] bool empty() const noexcept;
+        [[nodiscard]] bool contains(K const& key) const;
+        const_iterator find(K const& key) const;
+        const_iterator begin() const noexcept;
+        const_iterator end() const noexcept;
+
+        //! Inserts value for key or assigns it to the existing element.
+        //! \returns true if a new element has been inserted.
+        bool insert_or_assign(K const& key, V value);
+
+        //! Erases the element of key. \returns true if an element has been erased.
+        bool erase(K const& key);
+
+        //! Modifies the element of key in place by f(V&). \returns false if there is no element for key.
+        template<typename F>
+        bool modify(K const& key, F f);
+
+        //! Erases all elements, observers are notified by a reset record.
+        void clear();
+
+        //! Replaces the content, observers are notified by a reset record.
+        void assign(map_type values);
+
+        //! Starts a batch, see astl::change_batch.
+        void begin_batch() noexcept;
+
+        //! Ends a batch, the outermost one dispatches the merged changes.
+        void end_batch() noexcept;
+
+    private:
+        enum class net_change { none, insert, erase, update };
+
+        void record(K const& key, net_change change);
+        changes_type changes() const;
+
+    private:
+        map_type values_{};
+        std::vector<std::pair<K, net_change>> pending_{};
+        std::unordered_map<K, std::size_t> pending_index_{};
+        std::size_t depth_{0};
+        bool reset_{false};
+        recursive_event<TAG, changes_type> event_{};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl observable_map
+// ------------------------------------------------------------------------------------------------
+template<typename K, typename V, typename TAG>
+    astl::observable_map<K, V, TAG>::observable_map(map_type values)
+        : values_{std::move(values)}
+{}
+
+template<typename K, typename V, typename TAG>
+    typename astl::observable_map<K, V, TAG>::signal_type&
+    astl::observable_map<K, V, TAG>::sig() noexcept
+{
+    return event_.sig();
+}
+
+template<typename K, typename V, typename TAG>
+    typename astl::observable_map<K, V, TAG>::map_type const&
+    astl::observable_map<K, V, TAG>::get() const noexcept
+{
+    return values_;
+}
+
+template<typename K, typename V, typename TAG>
+    std::size_t
+    astl::observable_map<K, V, TAG>::size() const noexcept
+{
+    return values_.size();
+}
+
+template<typename K, typename V, typename TAG>
+    bool
+    astl::observable_map<K, V, TAG>::empty() const noexcept
+{
+    return values_.empty();
+}
+
+template<typename K, typename V, typename TAG>
+    bool
+    astl::observable_map<K, V, TAG>::contains(K const& key) const
+{
+    return values_.find(key) != values_.end();
+}
+
+template<typename K, typename V, typename TAG>
+    typename astl::observable_map<K, V, TAG>::const_iterator
+    astl::observable_map<K, V, TAG>::find(K const& key) const
+{
+    return values_.find(key);
+}
+
+template<typename K, typename V, typename TAG>
+    typename astl::observable_map<K, V, TAG>::const_iterator
+    astl::observable_map<K, V, TAG>::begin() const noexcept
+{
+    return values_.cbegin();
+}
+
+template<typename K, typename V, typename TAG>
+    typename astl::observable_map<K, V, TAG>::const_iterator
+    astl::observable_map<K, V, TAG>::end() const noexcept
+{
+    return values_.cend();
+}
+
+template<typename K, typename V, typename TAG>
+    bool
+    astl::observable_map<K, V, TAG>::insert_or_assign(K const& key, V value)
+{
+    begin_batch();
+    auto inserted = values_.insert_or_assign(key, std::move(value)).second;
+    record(key, inserted ? net_change::insert : net_change::update);
+    end_batch();
+    return inserted;
+}
+
+template<typename K, typename V, typename TAG>
+    bool
+    astl::observable_map<K, V, TAG>::erase(K const& key)
+{
+    begin_batch();
+    auto erased = values_.erase(key) > 0;
+    if (erased) {
+        record(key, net_change::erase);
+    }
+    end_batch();
+    return erased;
+}
+
+template<typename K, typename V, typename TAG>
+    template<typename F>
+    bool
+    astl::observable_map<K, V, TAG>::modify(K const& key, F f)
+{
+    auto i = values_.find(key);
+    if (i == values_.end()) {
+        return false;
+    }
+    begin_batch();
+    f(i->second);
+    record(key, net_change::update);
+    end_batch();
+    return true;
+}
+
+template<typename K, typename V, typename TAG>
+    void
+    astl::observable_map<K, V, TAG>::clear()
+{
+    assign(map_type{});
+}
+
+template<typename K, typename V, typename TAG>
+    void
+    astl::observable_map<K, V, TAG>::assign(map_type values)
+{
+    begin_batch();
+    values_ = std::move(values);
+    reset_ = true;
+    pending_.clear();
+    pending_index_.clear();
+    end_batch();
+}
+
+template<typename K, typename V, typename TAG>
+    void
+    astl::observable_map<K, V, TAG>::begin_batch() noexcept
+{
+    if (depth_++ == 0) {
+        reset_ = false;
+    }
+}
+
+template<typename K, typename V, typename TAG>
+    void
+    astl::observable_map<K, V, TAG>::end_batch() noexcept
+{
+    assert(depth_ > 0);
+    if (--depth_ > 0) {
+        return;
+    }
+    auto records = changes();
+    pending_.clear();
+    pending_index_.clear();
+    if (!records.empty()) {
+        event_.invoke(std::move(records));
+    }
+}
+
+template<typename K, typename V, typename TAG>
+    void
+    astl::observable_map<K, V, TAG>::record(K const& key, net_change change)
+{
+    if (reset_) {
+        return;
+    }
+    auto [i, added] = pending_index_.try_emplace(key, pending_.size());
+    if (added) {
+        pending_.emplace_back(key, change);
+        return;
+    }
+    auto& net = pending_[i->second].second;
+    switch (net) {
+        case net_change::none:
+            net = change;
+            break;
+        case net_change::insert:
+            // an element inserted within the batch stays an insert until it is erased again
+            net = change == net_change::erase ? net_change::none : net_change::insert;
+            break;
+        case net_change::erase:
+            net = change == net_change::insert ? net_change::update : change;
+            break;
+        case net_change::update:
+            net = change == net_change::erase ? net_change::erase : net_change::update;
+            break;
+    }
+}
+
+template<typename K, typename V, typename TAG>
+    typename astl::observable_map<K, V, TAG>::changes_type
+    astl::observable_map<K, V, TAG>::changes() const
+{
+    changes_type records{};
+    if (reset_) {
+        records.push_back(map_change<K>{change_kind::reset, K{}});
+        return records;
+    }
+    records.reserve(pending_.size());
+    for (auto const& [key, net] : pending_) {
+        switch (net) {
+            case net_change::none:
+                break;
+            case net_change::insert:
+                records.push_back(map_change<K>{change_kind::insert, key});
+                break;
+            case net_change::erase:
+                records.push_back(map_change<K>{change_kind::erase, key});
+                break;
+            case net_change::update:
+                records.push_back(map_change<K>{change_kind::update, key});
+                break;
+        }
+    }
+    return records;
+}
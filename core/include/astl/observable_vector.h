@@ -0,0 +1,496 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/change_batch.h>
+#include <astl/recursive_event.h>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace astl {
+
+    //! Change record of an observable_vector: count elements starting at index first.
+    struct vector_change
+    {
+        change_kind kind;
+        std::size_t first;
+        std::size_t count;
+
+        bool operator==(vector_change const& other) const noexcept
+        {
+            return kind == other.kind && first == other.first && count == other.count;
+        }
+    };
+
+    //! Vector notifying its changes as ranges.
+    //! Every modification outside of a change_batch results in one notification. Inside a change_batch the changes are
+    //! merged and notified once when the batch ends. The records of a notification are to be applied in order, each
+    //! refers to the indices after applying the previous records:
+    //! - first the erase records in the index space of the vector before the batch,
+    //! - then the insert records in ascending order of the final indices,
+    //! - then the update records with final indices.
+    //! So an observer mirroring the vector can read the values of inserted and updated elements directly from the
+    //! vector. A reset record replaces all others when the vector has been reassigned.
+    //! \code
+    //! #include <astl/observable_vector.h>
+    //!
+    //! astl::observable_vector<int> model{};
+    //! astl::observable_vector<int>::slot_type slot{[&](std::vector<astl::vector_change> const& changes){ ... }};
+    //! model.sig().connect(slot);
+    //! {
+    //!     astl::change_batch batch{model};
+    //!     model.push_back(1);
+    //!     model.push_back(2);
+    //! }   // one notification: insert [0, 2)
+    //! \endcode
+    //!
+    //! \tparam T       Type of the elements.
+    //! \tparam TAG     Tagging type of the change event. Defaults to T.
+    template<typename T, typename TAG = T>
+    class observable_vector
+    {
+    public:
+        using value_type = T;
+        using changes_type = std::vector<vector_change>;
+        using signal_type = typename recursive_event<TAG, changes_type>::signal_type;
+        using slot_type = typename recursive_event<TAG, changes_type>::slot_type;
+        using const_iterator = typename std::vector<T>::const_iterator;
+
+        explicit observable_vector() = default;
+        explicit observable_vector(std::vector<T> values);
+
+        observable_vector(observable_vector const&) = delete;
+        observable_vector& operator=(observable_vector const&) = delete;
+
+        //! Returns the signal of the change event.
+        signal_type& sig() noexcept;
+
+        [[nodiscard]] std::vector<T> const& get() const noexcept;
+        [[nodiscard]] std::size_t size() const noexcept;
+        [[nodiscard]] bool empty() const noexcept;
+        T const& operator[](std::size_t index) const noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator end() const noexcept;
+
+        void push_back(T value);
+        template<typename...Args>
+        T& emplace_back(Args&&...args);
+        void pop_back();
+        void insert(std::size_t index, T value);
+        template<typename InputIt>
+        void insert(std::size_t index, InputIt first, InputIt last);
+        void erase(std::size_t index);
+        void erase(std::size_t first, std::size_t last);
+        void clear();
+
+        //! Assigns value to the element at index.
+        void set(std::size_t index, T value);
+
+        //! Modifies the element at index in place by f(T&).
+        template<typename F>
+        void modify(std::size_t index, F f);
+
+        //! Replaces the content, observers are notified by a reset record.
+        void assign(std::vector<T> values);
+
+        //! Starts a batch, see astl::change_batch.
+        void begin_batch();
+
+        //! Ends a batch, the outermost one dispatches the merged changes.
+        void end_batch() noexcept;
+
+    private:
+        static constexpr std::size_t inserted = std::numeric_limits<std::size_t>::max();
+
+        // run of elements of the vector during a batch: either elements of the vector before the batch (origin is
+        // their index then) or inserted elements, start is the index of its first element in the vector now
+        struct segment
+        {
+            std::size_t start;
+            std::size_t origin;
+            std::size_t length;
+            bool updated;
+        };
+
+        std::size_t split(std::size_t index);
+        void shift(std::size_t first, std::size_t count, bool grow) noexcept;
+        void coalesce(std::size_t first, std::size_t last) noexcept;
+        void record_insert(std::size_t index, std::size_t count);
+        void record_erase(std::size_t index, std::size_t count);
+        void record_update(std::size_t index, std::size_t count);
+        changes_type changes() const;
+
+    private:
+        std::vector<T> values_{};
+        std::vector<segment> segments_{};
+        std::size_t initial_size_{0};
+        std::size_t depth_{0};
+        bool reset_{false};
+        recursive_event<TAG, changes_type> event_{};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl observable_vector
+// ------------------------------------------------------------------------------------------------
+template<typename T, typename TAG>
+    astl::observable_vector<T, TAG>::observable_vector(std::vector<T> values)
+        : values_{std::move(values)}
+{}
+
+template<typename T, typename TAG>
+    typename astl::observable_vector<T, TAG>::signal_type&
+    astl::observable_vector<T, TAG>::sig() noexcept
+{
+    return event_.sig();
+}
+
+template<typename T, typename TAG>
+    std::vector<T> const&
+    astl::observable_vector<T, TAG>::get() const noexcept
+{
+    return values_;
+}
+
+template<typename T, typename TAG>
+    std::size_t
+    astl::observable_vector<T, TAG>::size() const noexcept
+{
+    return values_.size();
+}
+
+template<typename T, typename TAG>
+    bool
+    astl::observable_vector<T, TAG>::empty() const noexcept
+{
+    return values_.empty();
+}
+
+template<typename T, typename TAG>
+    T const&
+    astl::observable_vector<T, TAG>::operator[](std::size_t index) const noexcept
+{
+    return values_[index];
+}
+
+template<typename T, typename TAG>
+    typename astl::observable_vector<T, TAG>::const_iterator
+    astl::observable_vector<T, TAG>::begin() const noexcept
+{
+    return values_.cbegin();
+}
+
+template<typename T, typename TAG>
+    typename astl::observable_vector<T, TAG>::const_iterator
+    astl::observable_vector<T, TAG>::end() const noexcept
+{
+    return values_.cend();
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::push_back(T value)
+{
+    begin_batch();
+    values_.push_back(std::move(value));
+    record_insert(values_.size() - 1, 1);
+    end_batch();
+}
+
+template<typename T, typename TAG>
+    template<typename...Args>
+    T&
+    astl::observable_vector<T, TAG>::emplace_back(Args&&...args)
+{
+    begin_batch();
+    auto& value = values_.emplace_back(std::forward<Args>(args)...);
+    record_insert(values_.size() - 1, 1);
+    end_batch();
+    return value;
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::pop_back()
+{
+    assert(!values_.empty());
+    erase(values_.size() - 1);
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::insert(std::size_t index, T value)
+{
+    begin_batch();
+    values_.insert(values_.begin() + index, std::move(value));
+    record_insert(index, 1);
+    end_batch();
+}
+
+template<typename T, typename TAG>
+    template<typename InputIt>
+    void
+    astl::observable_vector<T, TAG>::insert(std::size_t index, InputIt first, InputIt last)
+{
+    begin_batch();
+    auto size = values_.size();
+    values_.insert(values_.begin() + index, first, last);
+    if (values_.size() > size) {
+        record_insert(index, values_.size() - size);
+    }
+    end_batch();
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::erase(std::size_t index)
+{
+    erase(index, index + 1);
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::erase(std::size_t first, std::size_t last)
+{
+    if (first >= last) {
+        return;
+    }
+    begin_batch();
+    values_.erase(values_.begin() + first, values_.begin() + last);
+    record_erase(first, last - first);
+    end_batch();
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::clear()
+{
+    erase(0, values_.size());
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::set(std::size_t index, T value)
+{
+    begin_batch();
+    values_[index] = std::move(value);
+    record_update(index, 1);
+    end_batch();
+}
+
+template<typename T, typename TAG>
+    template<typename F>
+    void
+    astl::observable_vector<T, TAG>::modify(std::size_t index, F f)
+{
+    begin_batch();
+    f(values_[index]);
+    record_update(index, 1);
+    end_batch();
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::assign(std::vector<T> values)
+{
+    begin_batch();
+    values_ = std::move(values);
+    reset_ = true;
+    segments_.clear();
+    end_batch();
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::begin_batch()
+{
+    if (depth_ == 0) {
+        initial_size_ = values_.size();
+        reset_ = false;
+        segments_.clear();
+        if (initial_size_) {
+            segments_.push_back(segment{0, 0, initial_size_, false});
+        }
+    }
+    ++depth_;
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::end_batch() noexcept
+{
+    assert(depth_ > 0);
+    if (--depth_ > 0) {
+        return;
+    }
+    auto records = changes();
+    segments_.clear();
+    if (!records.empty()) {
+        event_.invoke(std::move(records));
+    }
+}
+
+template<typename T, typename TAG>
+    std::size_t
+    astl::observable_vector<T, TAG>::split(std::size_t index)
+{
+    // the segment containing index is the last one starting at or before it
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), index,
+                               [](std::size_t i, segment const& s){ return i < s.start; });
+    if (it == segments_.begin()) {
+        return 0;
+    }
+    auto i = static_cast<std::size_t>(it - segments_.begin()) - 1;
+    auto& s = segments_[i];
+    if (s.start == index) {
+        return i;
+    }
+    if (index >= s.start + s.length) {
+        return segments_.size();
+    }
+    auto offset = index - s.start;
+    auto tail = segment{index, s.origin == inserted ? inserted : s.origin + offset, s.length - offset, s.updated};
+    s.length = offset;
+    segments_.insert(segments_.begin() + static_cast<std::ptrdiff_t>(i) + 1, tail);
+    return i + 1;
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::shift(std::size_t first, std::size_t count, bool grow) noexcept
+{
+    for (auto i = first; i < segments_.size(); ++i) {
+        segments_[i].start = grow ? segments_[i].start + count : segments_[i].start - count;
+    }
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::coalesce(std::size_t first, std::size_t last) noexcept
+{
+    // merges adjacent compatible segments with indices in [first, last]
+    first = first > 0 ? first - 1 : 0;
+    last = std::min(last, segments_.size() ? segments_.size() - 1 : 0);
+    for (auto i = first; i < last && i + 1 < segments_.size();) {
+        auto& a = segments_[i];
+        auto& b = segments_[i + 1];
+        auto compatible = (a.origin == inserted && b.origin == inserted)
+                || (a.origin != inserted && b.origin == a.origin + a.length && a.updated == b.updated);
+        if (compatible) {
+            a.length += b.length;
+            segments_.erase(segments_.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            --last;
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::record_insert(std::size_t index, std::size_t count)
+{
+    if (reset_) {
+        return;
+    }
+    auto i = split(index);
+    segments_.insert(segments_.begin() + static_cast<std::ptrdiff_t>(i), segment{index, inserted, count, false});
+    shift(i + 1, count, true);
+    coalesce(i, i + 1);
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::record_erase(std::size_t index, std::size_t count)
+{
+    if (reset_) {
+        return;
+    }
+    auto i = split(index);
+    auto j = split(index + count);
+    segments_.erase(segments_.begin() + static_cast<std::ptrdiff_t>(i),
+                    segments_.begin() + static_cast<std::ptrdiff_t>(j));
+    shift(i, count, false);
+    coalesce(i, i);
+}
+
+template<typename T, typename TAG>
+    void
+    astl::observable_vector<T, TAG>::record_update(std::size_t index, std::size_t count)
+{
+    if (reset_) {
+        return;
+    }
+    auto i = split(index);
+    auto j = split(index + count);
+    for (auto k = i; k < j; ++k) {
+        if (segments_[k].origin != inserted) {
+            segments_[k].updated = true;
+        }
+    }
+    coalesce(i, j);
+}
+
+template<typename T, typename TAG>
+    typename astl::observable_vector<T, TAG>::changes_type
+    astl::observable_vector<T, TAG>::changes() const
+{
+    changes_type records{};
+    if (reset_) {
+        records.push_back(vector_change{change_kind::reset, 0, values_.size()});
+        return records;
+    }
+    // erased elements are the gaps between the runs of original elements
+    std::size_t expected{0};
+    std::size_t erased{0};
+    for (auto const& s : segments_) {
+        if (s.origin == inserted) {
+            continue;
+        }
+        if (s.origin > expected) {
+            records.push_back(vector_change{change_kind::erase, expected - erased, s.origin - expected});
+            erased += s.origin - expected;
+        }
+        expected = s.origin + s.length;
+    }
+    if (initial_size_ > expected) {
+        records.push_back(vector_change{change_kind::erase, expected - erased, initial_size_ - expected});
+    }
+    std::size_t position{0};
+    for (auto const& s : segments_) {
+        if (s.origin == inserted) {
+            records.push_back(vector_change{change_kind::insert, position, s.length});
+        }
+        position += s.length;
+    }
+    position = 0;
+    auto updates = records.size();
+    for (auto const& s : segments_) {
+        if (s.origin != inserted && s.updated) {
+            if (records.size() > updates && records.back().first + records.back().count == position) {
+                records.back().count += s.length;
+            }
+            else {
+                records.push_back(vector_change{change_kind::update, position, s.length});
+            }
+        }
+        position += s.length;
+    }
+    return records;
+}
@@ -0,0 +1,507 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/event.h>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace astl {
+
+    namespace detail {
+
+        //! Node of the dependency graph of properties and computed values.
+        class reactive_node
+        {
+        public:
+            explicit reactive_node() noexcept = default;
+            virtual ~reactive_node() noexcept;
+
+            reactive_node(reactive_node const&) = delete;
+            reactive_node& operator=(reactive_node const&) = delete;
+
+        protected:
+            friend class reactive_context;
+
+            enum class node_state : std::uint8_t {
+                clean,  //!< value is up to date
+                check,  //!< a transitive source changed, the direct sources have to be checked
+                dirty,  //!< a direct source changed, the value has to be recomputed
+            };
+
+            //! Brings the value up to date.
+            virtual void update() noexcept {}
+
+            //! Invokes the change event if the value changed since the last notification.
+            virtual void notify() noexcept = 0;
+
+            //! Returns true when slots are connected to the change event.
+            [[nodiscard]] virtual bool observed() noexcept = 0;
+
+            //! Registers this node as source of the computed value being evaluated.
+            void track() noexcept;
+
+            //! Marks the direct observers dirty and the transitive ones to be checked.
+            void changed() noexcept;
+
+            //! Updates the sources until one of them changed and marked this node dirty.
+            void update_sources() noexcept;
+
+            void mark(node_state state) noexcept;
+            void raise_height(std::size_t height) noexcept;
+            void unlink_sources() noexcept;
+
+        protected:
+            std::vector<reactive_node*> sources_{};
+            std::vector<reactive_node*> observers_{};
+            std::size_t height_{0};         // 0 for properties, 1 + maximum height of the sources otherwise
+            node_state state_{node_state::clean};
+            bool pending_{false};           // queued for notification
+        };
+
+        //! Per thread state of the dependency graph: the evaluated computed value and the pending notifications.
+        class reactive_context
+        {
+        public:
+            static reactive_context& current() noexcept;
+
+            void begin() noexcept;
+            void end() noexcept;
+            void enqueue(reactive_node& node) noexcept;
+            void remove(reactive_node& node) noexcept;
+
+            reactive_node* tracking{nullptr};
+
+        private:
+            void propagate() noexcept;
+
+            std::vector<reactive_node*> pending_{};
+            std::vector<reactive_node*> batch_{};
+            std::size_t depth_{0};
+            bool propagating_{false};
+        };
+
+    } // namespace detail
+
+    //! Value that invokes its change event only when it is set to a different value.
+    //! Reading a property while a astl::computed value is evaluated makes the computed value depend on it.
+    //! Properties and computed values belong to the thread using them.
+    //! \code
+    //! #include <astl/property.h>
+    //!
+    //! astl::property<float> width{2.f};
+    //! astl::property<float> height{3.f};
+    //! astl::computed<float> area{[&]{ return width.get() * height.get(); }};
+    //! area.get();     // 6.f
+    //! {
+    //!     astl::transaction t{};
+    //!     width.set(4.f);
+    //!     height.set(1.5f);
+    //! }               // area is recomputed once; it is still 6.f, so its change event does not fire
+    //! \endcode
+    //!
+    //! \tparam T       Type of the value, must be copyable and equality comparable.
+    //! \tparam TAG     Tagging type of the change event. Defaults to T.
+    template<typename T, typename TAG = T>
+    class property : private detail::reactive_node
+    {
+    public:
+        using value_type = T;
+        using signal_type = typename event<TAG, T>::signal_type;
+        using slot_type = typename event<TAG, T>::slot_type;
+
+        explicit property() = default;
+        explicit property(T value);
+        ~property() noexcept override = default;
+
+        //! Returns the value.
+        T const& get() noexcept;
+
+        //! Sets the value. Dependent computed values are invalidated and the change events fire at the end of the
+        //! outermost transaction - immediately without a transaction.
+        template<typename U>
+        void set(U&& value) noexcept;
+
+        //! Returns the signal of the change event.
+        signal_type& sig() noexcept;
+
+    private:
+        void notify() noexcept override;
+        [[nodiscard]] bool observed() noexcept override;
+
+    private:
+        T value_{};
+        std::optional<T> notified_{};   // value before the first change of the pending batch
+        event<TAG, T> event_{};
+    };
+
+    //! Value derived from properties and other computed values.
+    //! The sources are recorded while the function is evaluated, so they may differ from evaluation to evaluation.
+    //! A computed value is evaluated lazily on get() and only when a source changed. When a source changes, the
+    //! observers are invalidated incrementally: direct observers become dirty, transitive observers are only checked,
+    //! so a node whose sources recompute to the same values is not recomputed at all. Computed values with connected
+    //! slots are brought up to date in topological order at the end of a transaction, so each node is recomputed at
+    //! most once per batch and slots never see a mix of old and new values (no glitches).
+    //! The change event of a computed value fires after it has been evaluated once.
+    //!
+    //! \tparam T       Type of the value, must be equality comparable.
+    //! \tparam TAG     Tagging type of the change event. Defaults to T.
+    template<typename T, typename TAG = T>
+    class computed : private detail::reactive_node
+    {
+    public:
+        using value_type = T;
+        using function_type = std::function<T()>;
+        using signal_type = typename event<TAG, T>::signal_type;
+        using slot_type = typename event<TAG, T>::slot_type;
+
+        template<typename F>
+        explicit computed(F f);
+        ~computed() noexcept override = default;
+
+        //! Returns the value, evaluates the function when a source changed.
+        T const& get() noexcept;
+
+        //! Returns the signal of the change event.
+        signal_type& sig() noexcept;
+
+    private:
+        void update() noexcept override;
+        void notify() noexcept override;
+        [[nodiscard]] bool observed() noexcept override;
+        void recompute() noexcept;
+
+    private:
+        function_type function_;
+        std::optional<T> value_{};
+        bool changed_{false};
+        bool evaluating_{false};
+        event<TAG, T> event_{};
+    };
+
+    //! Scope coalescing writes to properties: change events fire and observed computed values are updated once when
+    //! the outermost transaction ends.
+    class transaction
+    {
+    public:
+        explicit transaction() noexcept;
+        ~transaction() noexcept;
+
+        transaction(transaction const&) = delete;
+        transaction& operator=(transaction const&) = delete;
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl reactive_node
+// ------------------------------------------------------------------------------------------------
+inline astl::detail::reactive_node::~reactive_node() noexcept
+{
+    unlink_sources();
+    for (auto observer : observers_) {
+        auto& sources = observer->sources_;
+        sources.erase(std::find(sources.begin(), sources.end(), this));
+        observer->mark(node_state::dirty);
+    }
+    if (pending_) {
+        reactive_context::current().remove(*this);
+    }
+}
+
+inline void astl::detail::reactive_node::track() noexcept
+{
+    auto evaluated = reactive_context::current().tracking;
+    if (!evaluated || std::find(evaluated->sources_.begin(), evaluated->sources_.end(), this)
+                      != evaluated->sources_.end()) {
+        return;
+    }
+    evaluated->sources_.push_back(this);
+    evaluated->raise_height(height_ + 1);
+    observers_.push_back(evaluated);
+}
+
+inline void astl::detail::reactive_node::changed() noexcept
+{
+    for (std::size_t i = 0; i < observers_.size(); ++i) {
+        observers_[i]->mark(node_state::dirty);
+    }
+}
+
+inline void astl::detail::reactive_node::update_sources() noexcept
+{
+    for (std::size_t i = 0; i < sources_.size() && state_ == node_state::check; ++i) {
+        sources_[i]->update();
+    }
+}
+
+inline void astl::detail::reactive_node::mark(node_state state) noexcept
+{
+    auto was_clean = state_ == node_state::clean;
+    state_ = std::max(state_, state);
+    // also when already invalid: slots may have been connected since the node was marked
+    if (observed()) {
+        reactive_context::current().enqueue(*this);
+    }
+    if (was_clean) {
+        for (auto observer : observers_) {
+            observer->mark(node_state::check);
+        }
+    }
+}
+
+inline void astl::detail::reactive_node::raise_height(std::size_t height) noexcept
+{
+    if (height_ >= height) {
+        return;
+    }
+    height_ = height;
+    // observers have to stay above this node for the topological order of the notifications
+    for (auto observer : observers_) {
+        observer->raise_height(height + 1);
+    }
+}
+
+inline void astl::detail::reactive_node::unlink_sources() noexcept
+{
+    for (auto source : sources_) {
+        auto& observers = source->observers_;
+        observers.erase(std::find(observers.begin(), observers.end(), this));
+    }
+    sources_.clear();
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl reactive_context
+// ------------------------------------------------------------------------------------------------
+inline astl::detail::reactive_context& astl::detail::reactive_context::current() noexcept
+{
+    static thread_local reactive_context context{};
+    return context;
+}
+
+inline void astl::detail::reactive_context::begin() noexcept
+{
+    ++depth_;
+}
+
+inline void astl::detail::reactive_context::end() noexcept
+{
+    assert(depth_ > 0);
+    if (--depth_ == 0) {
+        propagate();
+    }
+}
+
+inline void astl::detail::reactive_context::enqueue(reactive_node& node) noexcept
+{
+    if (!node.pending_) {
+        node.pending_ = true;
+        pending_.push_back(&node);
+    }
+}
+
+inline void astl::detail::reactive_context::remove(reactive_node& node) noexcept
+{
+    pending_.erase(std::remove(pending_.begin(), pending_.end(), &node), pending_.end());
+    std::replace(batch_.begin(), batch_.end(), &node, static_cast<reactive_node*>(nullptr));
+    node.pending_ = false;
+}
+
+inline void astl::detail::reactive_context::propagate() noexcept
+{
+    // slots writing properties extend the propagation by another batch instead of recursing
+    if (propagating_) {
+        return;
+    }
+    propagating_ = true;
+    while (!pending_.empty()) {
+        batch_.swap(pending_);
+        std::stable_sort(batch_.begin(), batch_.end(), [](reactive_node* a, reactive_node* b){
+            return a->height_ < b->height_;
+        });
+        for (auto node : batch_) {
+            node->pending_ = false;
+        }
+        for (std::size_t i = 0; i < batch_.size(); ++i) {
+            if (batch_[i]) {
+                batch_[i]->update();
+            }
+            if (batch_[i]) {
+                batch_[i]->notify();
+            }
+        }
+        batch_.clear();
+    }
+    propagating_ = false;
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl property
+// ------------------------------------------------------------------------------------------------
+template<typename T, typename TAG>
+    astl::property<T, TAG>::property(T value)
+        : value_{std::move(value)}
+{}
+
+template<typename T, typename TAG>
+    T const&
+    astl::property<T, TAG>::get() noexcept
+{
+    track();
+    return value_;
+}
+
+template<typename T, typename TAG>
+    template<typename U>
+    void
+    astl::property<T, TAG>::set(U&& value) noexcept
+{
+    if (value_ == value) {
+        return;
+    }
+    auto& context = detail::reactive_context::current();
+    context.begin();
+    if (observed() && !pending_) {
+        notified_ = value_;
+        context.enqueue(*this);
+    }
+    value_ = std::forward<U>(value);
+    changed();
+    context.end();
+}
+
+template<typename T, typename TAG>
+    typename astl::property<T, TAG>::signal_type&
+    astl::property<T, TAG>::sig() noexcept
+{
+    return event_.sig();
+}
+
+template<typename T, typename TAG>
+    void
+    astl::property<T, TAG>::notify() noexcept
+{
+    if (notified_ && !(*notified_ == value_)) {
+        event_.invoke(value_);
+    }
+    notified_.reset();
+}
+
+template<typename T, typename TAG>
+    bool
+    astl::property<T, TAG>::observed() noexcept
+{
+    return !event_.sig().empty();
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl computed
+// ------------------------------------------------------------------------------------------------
+template<typename T, typename TAG>
+    template<typename F>
+    astl::computed<T, TAG>::computed(F f)
+        : function_{std::move(f)}
+{
+    state_ = node_state::dirty;
+}
+
+template<typename T, typename TAG>
+    T const&
+    astl::computed<T, TAG>::get() noexcept
+{
+    assert(!evaluating_); // check cyclic dependency
+    update();
+    track();
+    return *value_;
+}
+
+template<typename T, typename TAG>
+    typename astl::computed<T, TAG>::signal_type&
+    astl::computed<T, TAG>::sig() noexcept
+{
+    return event_.sig();
+}
+
+template<typename T, typename TAG>
+    void
+    astl::computed<T, TAG>::update() noexcept
+{
+    if (state_ == node_state::check) {
+        update_sources();
+    }
+    if (state_ == node_state::dirty) {
+        recompute();
+    }
+    state_ = node_state::clean;
+}
+
+template<typename T, typename TAG>
+    void
+    astl::computed<T, TAG>::notify() noexcept
+{
+    if (changed_) {
+        changed_ = false;
+        event_.invoke(*value_);
+    }
+}
+
+template<typename T, typename TAG>
+    bool
+    astl::computed<T, TAG>::observed() noexcept
+{
+    return !event_.sig().empty();
+}
+
+template<typename T, typename TAG>
+    void
+    astl::computed<T, TAG>::recompute() noexcept
+{
+    auto& context = detail::reactive_context::current();
+    unlink_sources();
+    height_ = 0;
+    auto evaluated = context.tracking;
+    context.tracking = this;
+    evaluating_ = true;
+    auto value = function_();
+    evaluating_ = false;
+    context.tracking = evaluated;
+    state_ = node_state::clean;
+
+    if (!value_) {
+        value_.emplace(std::move(value));
+    }
+    else if (!(*value_ == value)) {
+        *value_ = std::move(value);
+        changed_ = true;
+        changed();
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl transaction
+// ------------------------------------------------------------------------------------------------
+inline astl::transaction::transaction() noexcept
+{
+    detail::reactive_context::current().begin();
+}
+
+inline astl::transaction::~transaction() noexcept
+{
+    detail::reactive_context::current().end();
+}
@@ -12,8 +12,8 @@
 #pragma once
 
 #include <astl/signal.h>
+#include <astl/small_vector.h>
 #include <cassert>
-#include <queue>
 #include <tuple>
 
 namespace astl {
@@ -48,7 +48,9 @@ namespace astl {
 
     private:
         signal_type signal_{};
-        std::queue<value_type> event_queue_{};
+        small_vector<value_type, 2> event_queue_{};    // FIFO of invocations, [head_, size) are pending
+        std::size_t head_{0};                           // next invocation to dispatch
+        bool dispatching_{false};
     };
 
 } // namespace astl
@@ -68,13 +70,28 @@ template<typename TAG, typename...Ts>
     void
     astl::recursive_event<TAG, Ts...>::invoke(Args &&... args) noexcept
 {
-    event_queue_.push(std::make_tuple(std::forward<Args>(args)...));
-    if (event_queue_.size() > 1) {
+    event_queue_.emplace_back(std::forward<Args>(args)...);
+    if (dispatching_) {
         // we're not the first in a recursive invocation, let the while-loop work by returning
+#ifdef ASTL_TRACE
+        trace::write_record<TAG>(trace::now(), signal_.slot_count(), 0, trace::queued);
+#endif
         return;
     }
-    while(!event_queue_.empty()) {
-        std::apply([this](Ts... args){this->signal_.invoke(args...);},  event_queue_.front());
-        event_queue_.pop();
+    dispatching_ = true;
+    while (head_ < event_queue_.size()) {
+        // move out, recursive invocations may grow the queue and relocate its elements
+        auto current = std::move(event_queue_[head_++]);
+        if (head_ == event_queue_.size()) {
+            // drained, a recursive chain starts over at the front instead of growing the queue
+            event_queue_.clear();
+            head_ = 0;
+        } else if (head_ > event_queue_.size() - head_) {
+            // drop the moved-from entries once they outnumber the pending ones
+            event_queue_.erase(event_queue_.begin(), event_queue_.begin() + head_);
+            head_ = 0;
+        }
+        std::apply([this](Ts... args){this->signal_.invoke(args...);}, current);
     }
+    dispatching_ = false;
 }
@@ -0,0 +1,203 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace astl {
+
+    //! Customization point for the binary serialization of event data.
+    //! A specialization for type T has to provide three static functions:
+    //! \code
+    //! template<>
+    //! struct astl::serializer<MyType>
+    //! {
+    //!     // number of bytes write() will produce for v
+    //!     static std::size_t size(MyType const& v) noexcept;
+    //!     // writes v to out and returns the position behind the written bytes
+    //!     static std::byte* write(std::byte* out, MyType const& v) noexcept;
+    //!     // reads v from [in, end) and returns the position behind the read bytes or nullptr on malformed input
+    //!     static std::byte const* read(std::byte const* in, std::byte const* end, MyType& v) noexcept;
+    //! }
+    //! \endcode
+    //! Serializers for trivially copyable types (copied bitwise, so only between hosts with the same ABI),
+    //! std::string, std::string_view and std::vector are provided. The std::string_view serializer reads without
+    //! copying - the view refers to the input buffer and is only valid as long as it is.
+    template<typename T, typename Enable = void>
+    struct serializer;
+
+    //! Selects the bitwise serializer for T. True for trivially copyable types except pointers and string views.
+    template<typename T>
+    struct is_bitwise_serializable : std::bool_constant<std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>> {};
+
+    template<typename Char>
+    struct is_bitwise_serializable<std::basic_string_view<Char>> : std::false_type {};
+
+    //! Returns the number of bytes serialize() will produce for values.
+    template<typename...Ts>
+    std::size_t serialized_size(Ts const&...values) noexcept;
+
+    //! Writes values one after another to out and returns the position behind the written bytes.
+    template<typename...Ts>
+    std::byte* serialize(std::byte* out, Ts const&...values) noexcept;
+
+    //! Reads values from [in, end). Returns false when the input is malformed or not completely consumed.
+    template<typename...Ts>
+    bool deserialize(std::byte const* in, std::byte const* end, std::tuple<Ts...>& values) noexcept;
+
+    template<typename T>
+    struct serializer<T, std::enable_if_t<is_bitwise_serializable<T>::value>>
+    {
+        static std::size_t size(T const&) noexcept
+        {
+            return sizeof(T);
+        }
+
+        static std::byte* write(std::byte* out, T const& v) noexcept
+        {
+            std::memcpy(out, &v, sizeof(T));
+            return out + sizeof(T);
+        }
+
+        static std::byte const* read(std::byte const* in, std::byte const* end, T& v) noexcept
+        {
+            if (static_cast<std::size_t>(end - in) < sizeof(T)) {
+                return nullptr;
+            }
+            std::memcpy(&v, in, sizeof(T));
+            return in + sizeof(T);
+        }
+    };
+
+    template<typename Char>
+    struct serializer<std::basic_string_view<Char>>
+    {
+        static std::size_t size(std::basic_string_view<Char> const& v) noexcept
+        {
+            return sizeof(std::uint32_t) + v.size() * sizeof(Char);
+        }
+
+        static std::byte* write(std::byte* out, std::basic_string_view<Char> const& v) noexcept
+        {
+            out = serializer<std::uint32_t>::write(out, static_cast<std::uint32_t>(v.size()));
+            if (!v.empty()) {
+                std::memcpy(out, v.data(), v.size() * sizeof(Char));
+            }
+            return out + v.size() * sizeof(Char);
+        }
+
+        static std::byte const* read(std::byte const* in, std::byte const* end,
+                                     std::basic_string_view<Char>& v) noexcept
+        {
+            std::uint32_t length{0};
+            in = serializer<std::uint32_t>::read(in, end, length);
+            if (!in || static_cast<std::size_t>(end - in) < length * sizeof(Char)) {
+                return nullptr;
+            }
+            v = std::basic_string_view<Char>{reinterpret_cast<Char const*>(in), length};
+            return in + length * sizeof(Char);
+        }
+    };
+
+    template<typename Char>
+    struct serializer<std::basic_string<Char>>
+    {
+        static std::size_t size(std::basic_string<Char> const& v) noexcept
+        {
+            return serializer<std::basic_string_view<Char>>::size(v);
+        }
+
+        static std::byte* write(std::byte* out, std::basic_string<Char> const& v) noexcept
+        {
+            return serializer<std::basic_string_view<Char>>::write(out, v);
+        }
+
+        static std::byte const* read(std::byte const* in, std::byte const* end, std::basic_string<Char>& v) noexcept
+        {
+            std::basic_string_view<Char> view{};
+            in = serializer<std::basic_string_view<Char>>::read(in, end, view);
+            if (in) {
+                v.assign(view);
+            }
+            return in;
+        }
+    };
+
+    template<typename T>
+    struct serializer<std::vector<T>>
+    {
+        static std::size_t size(std::vector<T> const& v) noexcept
+        {
+            std::size_t result{sizeof(std::uint32_t)};
+            for (auto const& e : v) {
+                result += serializer<T>::size(e);
+            }
+            return result;
+        }
+
+        static std::byte* write(std::byte* out, std::vector<T> const& v) noexcept
+        {
+            out = serializer<std::uint32_t>::write(out, static_cast<std::uint32_t>(v.size()));
+            for (auto const& e : v) {
+                out = serializer<T>::write(out, e);
+            }
+            return out;
+        }
+
+        static std::byte const* read(std::byte const* in, std::byte const* end, std::vector<T>& v) noexcept
+        {
+            std::uint32_t count{0};
+            in = serializer<std::uint32_t>::read(in, end, count);
+            v.clear();
+            for (std::uint32_t i = 0; in && i < count; ++i) {
+                in = serializer<T>::read(in, end, v.emplace_back());
+            }
+            return in;
+        }
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl serialize, deserialize
+// ------------------------------------------------------------------------------------------------
+template<typename...Ts>
+    std::size_t
+    astl::serialized_size(Ts const&...values) noexcept
+{
+    return (std::size_t{0} + ... + serializer<Ts>::size(values));
+}
+
+template<typename...Ts>
+    std::byte*
+    astl::serialize(std::byte* out, Ts const&...values) noexcept
+{
+    ((out = serializer<Ts>::write(out, values)), ...);
+    return out;
+}
+
+template<typename...Ts>
+    bool
+    astl::deserialize(std::byte const* in, std::byte const* end, std::tuple<Ts...>& values) noexcept
+{
+    std::apply([&in, end](Ts&...v){
+        ((in = in ? serializer<Ts>::read(in, end, v) : nullptr), ...);
+    }, values);
+    return in == end;
+}
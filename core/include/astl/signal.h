@@ -11,21 +11,44 @@
 // If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
+#include <astl/small_vector.h>
 #include <cassert>
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
-#include <list>
+#include <type_traits>
+#include <vector>
+
+#ifdef ASTL_TRACE
+#include <astl/trace.h>
+#endif
+#ifdef ASTL_WATCHDOG
+#include <astl/watchdog.h>
+#endif
 
 namespace astl {
 
     template<typename TAG, typename...Ts> class recursive_event;
+    template<typename TAG, typename...Ts> class nested_event;
     template<typename TAG, typename...Ts> class event;
     template<typename TAG, typename...Ts> class signal;
     template<typename TAG, typename...Ts> class slot;
 
+    //! Result of a slot handler. A handler returning consumed ends the dispatch of the event, slots of lower priority
+    //! are not invoked. Handlers returning void proceed.
+    enum class slot_result { proceed, consumed };
+
     //! Signal transmitting event to connected slots.
     //! Signals are the connection points for slots that are interested in event invocations. Signals are owned by
     //! events and cannot be created outside of them.
+    //! A signal is a single tagged pointer: empty, pointing to the only connected slot or pointing to a heap allocated
+    //! slot table once more than one slot is connected. Events without slots therefore cost one pointer and their
+    //! invocation a single branch. The table stores up to four slots without further allocation.
+    //! Slots are invoked in order of descending priority, slots of equal priority in connection order. The table is
+    //! kept sorted, connecting a slot is a binary search.
+    //! The producer may install a presence handler, called when the first slot connects and when the last one goes; the
+    //! handler is kept in the slot table, which then stays allocated.
     //!
     //! \tparam Ts      Types of data associated with an event. Maybe empty.
     //! \tparam TAG     Tagging type to distinguish events using the same data type T. Defaults to T.
@@ -37,28 +60,72 @@ namespace astl {
     public:
         using slot_type = slot<TAG, Ts...>;
 
-        void connect(slot_type& slot) noexcept;
+        //! Connects slot with the given priority. Connecting an already connected slot only changes its priority.
+        void connect(slot_type& slot, int priority = 0) noexcept;
+
+        //! Returns true when no slot is connected.
+        [[nodiscard]] bool empty() const noexcept;
 
     private:
         template<typename TAG1, typename...Ts1> friend class event;
         template<typename TAG1, typename...Ts1> friend class recursive_event;
+        template<typename TAG1, typename...Ts1> friend class nested_event;
         template<typename TAG1, typename...Ts1> friend class slot;
 
         explicit signal() = default;
         ~signal();
 
+        //! \returns true if a slot consumed the event.
+        template<typename...Args>
+        bool invoke(Args&& ... args) noexcept;
+
+        //! Invokes the slots within a dispatch started by begin_dispatch(). Dispatches may nest, each level keeps its
+        //! own position in the slot table; slots detached meanwhile are skipped by all levels.
         template<typename...Args>
-        void invoke(Args&& ... args) noexcept;
+        bool dispatch(Args&& ... args) noexcept;
+
+        //! While dispatching slots are not removed from or inserted into the table, end_dispatch() does that for
+        //! the slots detached and connected meanwhile. Nested dispatches end with the outermost one.
+        void begin_dispatch() noexcept;
+        void end_dispatch() noexcept;
 
         void slot_detached(slot_type& slot) noexcept;
 
+        template<typename F>
+        void set_presence_handler(F f) noexcept;
+
+        [[nodiscard]] std::size_t slot_count() const noexcept;
+
     private:
-        std::list<slot_type*> slots_{};
-        slot_type* actual_slot_{nullptr};
+        struct slot_table
+        {
+            small_vector<slot_type*, 4> slots{};    // in dispatch order, nullptr for slots detached while dispatching
+            std::vector<slot_type*> added{};        // connected while dispatching, inserted by compact()
+            std::size_t detached{0};                // number of nullptr entries
+            std::function<void(bool)> presence{};
+        };
+
+        // low bits of state_, slots and slot tables are at least 4 byte aligned
+        static constexpr std::uintptr_t table_bit = 1u;
+        static constexpr std::uintptr_t dispatching_bit = 2u;
+        static constexpr std::uintptr_t flag_mask = table_bit | dispatching_bit;
+
+        [[nodiscard]] bool is_table() const noexcept;
+        [[nodiscard]] bool is_dispatching() const noexcept;
+        [[nodiscard]] slot_type* single() const noexcept;
+        [[nodiscard]] slot_table* table() const noexcept;
+        void set_state(std::uintptr_t state) noexcept;
+        void compact() noexcept;
+        void reprioritize(slot_type& slot, int priority) noexcept;
+        static void notify_presence(slot_table& t, bool present) noexcept;
+        static void insert_sorted(small_vector<slot_type*, 4>& slots, slot_type& slot);
+
+    private:
+        std::uintptr_t state_{0};
     };
 
     //! A slot contains a (possible indefinite) handler functor that will be called when an event arrives from the
-    //! connected signal. The handler functor has signature void(T const&) noexcept.
+    //! connected signal. The handler functor has signature void(T const&) noexcept or slot_result(T const&) noexcept.
     //! Slots automatically unlink themselves from connected signals and signals automatically disconnect from all
     //! connected slots when they're destructed.
     //!
@@ -90,14 +157,21 @@ namespace astl {
         template<typename TAG1, typename...Ts1> friend class signal;
 
         template<typename...Args>
-        void invoke(Args&& ... args) noexcept;
+        slot_result invoke(Args&& ... args) noexcept;
 
-        void connected_to(signal_type& signal) noexcept;
+        void connected_to(signal_type& signal, int priority) noexcept;
         void disconnected() noexcept;
 
+        // handlers returning void are wrapped to return slot_result::proceed
+        using handler_type = std::function<slot_result(Ts const&...)>;
+
+        template<typename F>
+        static handler_type make_functor(F f) noexcept;
+
     private:
-        functor_type functor_{};
+        handler_type functor_{};
         signal_type* signal_{nullptr};
+        int priority_{0};
     };
 
 } // namespace astl
@@ -108,61 +182,308 @@ namespace astl {
 template<typename TAG, typename...Ts>
     astl::signal<TAG, Ts...>::~signal()
 {
-    for (auto& slot : slots_) {
-        slot->disconnected();
+    if (is_table()) {
+        for (auto slot : table()->slots) {
+            if (slot) {
+                slot->disconnected();
+            }
+        }
+        for (auto slot : table()->added) {
+            slot->disconnected();
+        }
+        delete table();
+    }
+    else if (single()) {
+        single()->disconnected();
     }
 }
 
 template<typename TAG, typename...Ts>
     template<typename...Args>
-    void
+    bool
     astl::signal<TAG, Ts...>::invoke(Args &&... args) noexcept
 {
-    assert(actual_slot_ == nullptr); // check recursive invocation
-    for(auto i = slots_.begin(); i != slots_.end();) {
-        actual_slot_ = *i;
-        (*i)->invoke(std::forward<Args>(args)...);
-        if (actual_slot_) {
-            ++i;
+#ifdef ASTL_TRACE
+    trace::scope<TAG> trace_scope{slot_count()};
+#endif
+    if (!state_) {
+        return false;
+    }
+    assert(!is_dispatching()); // check recursive invocation
+    begin_dispatch();
+    auto consumed = dispatch(std::forward<Args>(args)...);
+    end_dispatch();
+    return consumed;
+}
+
+template<typename TAG, typename...Ts>
+    template<typename...Args>
+    bool
+    astl::signal<TAG, Ts...>::dispatch(Args &&... args) noexcept
+{
+#ifdef ASTL_WATCHDOG
+    watchdog::dispatch_scope<TAG> watchdog_scope{};
+#endif
+    auto consumed = false;
+    if (!is_table()) {
+        if (auto slot = single()) {
+#ifdef ASTL_WATCHDOG
+            watchdog_scope.enter(slot);
+#endif
+            consumed = slot->invoke(std::forward<Args>(args)...) == slot_result::consumed;
         }
-        else {
-            i = slots_.erase(i);
+    }
+    else {
+        // slots connected while dispatching are kept aside and not dispatched before the next invocation
+        auto& slots = table()->slots;
+        for (std::size_t i = 0; i < slots.size() && !consumed; ++i) {
+            if (auto slot = slots[i]) {
+#ifdef ASTL_WATCHDOG
+                watchdog_scope.enter(slot);
+#endif
+                consumed = slot->invoke(std::forward<Args>(args)...) == slot_result::consumed;
+            }
         }
     }
-    actual_slot_ = nullptr;
+    return consumed;
 }
 
 template<typename TAG, typename...Ts>
     void
-    astl::signal<TAG, Ts...>::connect(slot_type& slot) noexcept
+    astl::signal<TAG, Ts...>::begin_dispatch() noexcept
 {
-    auto i = std::find_if(slots_.begin(), slots_.end(), [&slot](slot_type* s){return s == &slot;});
-    if (i != slots_.end())
+    state_ |= dispatching_bit;
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::signal<TAG, Ts...>::end_dispatch() noexcept
+{
+    state_ &= ~dispatching_bit;
+    compact();
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::signal<TAG, Ts...>::connect(slot_type& slot, int priority) noexcept
+{
+    static_assert(alignof(slot_type) > flag_mask && alignof(slot_table) > flag_mask);
+    if (slot.signal_ == this) {
+        reprioritize(slot, priority);
+        return;
+    }
+    slot.connected_to(*this, priority);
+    if (!is_table()) {
+        // without a table there is no presence handler to notify
+        auto first = single();
+        if (!first && !is_dispatching()) {
+            set_state(reinterpret_cast<std::uintptr_t>(&slot));
+            return;
+        }
+        // also when the single slot detached itself while dispatching: the slot must not join the dispatch
+        auto t = new slot_table{};
+        if (first) {
+            t->slots.push_back(first);
+        }
+        if (is_dispatching()) {
+            t->added.push_back(&slot);
+        }
+        else {
+            insert_sorted(t->slots, slot);
+        }
+        set_state(reinterpret_cast<std::uintptr_t>(t) | table_bit);
         return;
-    // pushing to front guarantees that a new slot will not be dispatched while an event invocation is ongoing
-    slots_.push_front(&slot);
-    slot.connected_to(*this);
+    }
+    auto t = table();
+    auto was_empty = empty();
+    if (is_dispatching()) {
+        t->added.push_back(&slot);
+    }
+    else {
+        insert_sorted(t->slots, slot);
+    }
+    if (was_empty) {
+        notify_presence(*t, true);
+    }
 }
 
 template<typename TAG, typename...Ts>
     void
     astl::signal<TAG, Ts...>::slot_detached(slot_type& slot) noexcept
 {
-    if (actual_slot_ != &slot) {
-        slots_.erase(std::find_if(slots_.begin(), slots_.end(), [&slot](slot_type* s){return s == &slot;}));
+    if (!is_table()) {
+        if (single() == &slot) {
+            set_state(0);
+        }
+        return;
+    }
+    auto t = table();
+    if (auto i = std::find(t->added.begin(), t->added.end(), &slot); i != t->added.end()) {
+        t->added.erase(i);
+    }
+    else {
+        auto j = std::find(t->slots.begin(), t->slots.end(), &slot);
+        if (j == t->slots.end()) {
+            return;
+        }
+        if (is_dispatching()) {
+            // keep the indices of the dispatch loop valid, compact() removes the entry afterwards
+            *j = nullptr;
+            ++t->detached;
+        }
+        else {
+            t->slots.erase(j);
+        }
+    }
+    if (empty()) {
+        notify_presence(*t, false);
+    }
+    compact();
+}
+
+template<typename TAG, typename...Ts>
+    template<typename F>
+    void
+    astl::signal<TAG, Ts...>::set_presence_handler(F f) noexcept
+{
+    if (!is_table()) {
+        auto t = new slot_table{};
+        if (single()) {
+            t->slots.push_back(single());
+        }
+        set_state(reinterpret_cast<std::uintptr_t>(t) | table_bit);
+    }
+    table()->presence = std::move(f);
+    compact();
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::signal<TAG, Ts...>::empty() const noexcept
+{
+    return slot_count() == 0;
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::signal<TAG, Ts...>::slot_count() const noexcept
+{
+    if (is_table()) {
+        return table()->slots.size() - table()->detached + table()->added.size();
+    }
+    return single() ? 1 : 0;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::signal<TAG, Ts...>::is_table() const noexcept
+{
+    return state_ & table_bit;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::signal<TAG, Ts...>::is_dispatching() const noexcept
+{
+    return state_ & dispatching_bit;
+}
+
+template<typename TAG, typename...Ts>
+    typename astl::signal<TAG, Ts...>::slot_type*
+    astl::signal<TAG, Ts...>::single() const noexcept
+{
+    return is_table() ? nullptr : reinterpret_cast<slot_type*>(state_ & ~flag_mask);
+}
+
+template<typename TAG, typename...Ts>
+    typename astl::signal<TAG, Ts...>::slot_table*
+    astl::signal<TAG, Ts...>::table() const noexcept
+{
+    return reinterpret_cast<slot_table*>(state_ & ~flag_mask);
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::signal<TAG, Ts...>::set_state(std::uintptr_t state) noexcept
+{
+    state_ = state | (state_ & dispatching_bit);
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::signal<TAG, Ts...>::compact() noexcept
+{
+    if (!is_table() || is_dispatching()) {
+        return;
+    }
+    auto t = table();
+    if (t->detached) {
+        t->slots.erase(std::remove(t->slots.begin(), t->slots.end(), nullptr), t->slots.end());
+        t->detached = 0;
+    }
+    for (auto slot : t->added) {
+        insert_sorted(t->slots, *slot);
+    }
+    t->added.clear();
+    if (t->slots.size() <= 1 && !t->presence) {
+        set_state(t->slots.empty() ? 0 : reinterpret_cast<std::uintptr_t>(t->slots.front()));
+        delete t;
+    }
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::signal<TAG, Ts...>::reprioritize(slot_type& slot, int priority) noexcept
+{
+    if (slot.priority_ == priority) {
+        return;
+    }
+    slot.priority_ = priority;
+    if (!is_table()) {
+        return;
+    }
+    auto t = table();
+    if (std::find(t->added.begin(), t->added.end(), &slot) != t->added.end()) {
+        return; // sorted in by compact()
+    }
+    auto i = std::find(t->slots.begin(), t->slots.end(), &slot);
+    if (is_dispatching()) {
+        *i = nullptr;
+        ++t->detached;
+        t->added.push_back(&slot);
     }
     else {
-        actual_slot_ = nullptr;
+        t->slots.erase(i);
+        insert_sorted(t->slots, slot);
+    }
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::signal<TAG, Ts...>::notify_presence(slot_table& t, bool present) noexcept
+{
+    if (t.presence) {
+        t.presence(present);
     }
 }
 
+template<typename TAG, typename...Ts>
+    void
+    astl::signal<TAG, Ts...>::insert_sorted(small_vector<slot_type*, 4>& slots, slot_type& slot)
+{
+    // behind all slots of higher or equal priority
+    auto i = std::upper_bound(slots.begin(), slots.end(), slot.priority_,
+                              [](int priority, slot_type const* s){ return priority > s->priority_; });
+    slots.insert(i, &slot);
+}
+
 // ------------------------------------------------------------------------------------------------
 // impl slot
 // ------------------------------------------------------------------------------------------------
 template<typename TAG, typename...Ts>
     template<typename F>
     astl::slot<TAG, Ts...>::slot(F f) noexcept
-        : functor_{f}
+        : functor_{make_functor(std::move(f))}
 {}
 
 template<typename TAG, typename...Ts>
@@ -178,7 +499,7 @@ template<typename TAG, typename...Ts>
     void
     astl::slot<TAG, Ts...>::set_functor(F f) noexcept
 {
-    functor_ = f;
+    functor_ = make_functor(std::move(f));
 }
 
 template<typename TAG, typename...Ts>
@@ -193,22 +514,24 @@ template<typename TAG, typename...Ts>
 
 template<typename TAG, typename...Ts>
     template<typename...Args>
-    void
+    astl::slot_result
     astl::slot<TAG, Ts...>::invoke(Args &&... args) noexcept
 {
     if (functor_) {
-        functor_(std::forward<Args>(args)...);
+        return functor_(std::forward<Args>(args)...);
     }
+    return slot_result::proceed;
 }
 
 template<typename TAG, typename...Ts>
     void
-    astl::slot<TAG, Ts...>::connected_to(signal_type& signal) noexcept
+    astl::slot<TAG, Ts...>::connected_to(signal_type& signal, int priority) noexcept
 {
-    if (signal_) {
+    if (signal_ && signal_ != &signal) {
         signal_->slot_detached(*this);
     }
     signal_ = &signal;
+    priority_ = priority;
 }
 
 template<typename TAG, typename...Ts>
@@ -225,3 +548,25 @@ template<typename TAG, typename...Ts>
     return signal_;
 }
 
+template<typename TAG, typename...Ts>
+    template<typename F>
+    typename astl::slot<TAG, Ts...>::handler_type
+    astl::slot<TAG, Ts...>::make_functor(F f) noexcept
+{
+    if constexpr (std::is_same_v<F, std::nullptr_t>) {
+        return handler_type{};
+    }
+    else if constexpr (std::is_same_v<std::invoke_result_t<F&, Ts const&...>, slot_result>) {
+        return handler_type{std::move(f)};
+    }
+    else if constexpr (std::is_same_v<F, functor_type> || std::is_pointer_v<F>) {
+        // keep an empty handler empty
+        if (!f) {
+            return handler_type{};
+        }
+        return [f = std::move(f)](Ts const&...values){ f(values...); return slot_result::proceed; };
+    }
+    else {
+        return [f = std::move(f)](Ts const&...values) mutable { f(values...); return slot_result::proceed; };
+    }
+}
@@ -0,0 +1,372 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/signal.h>
+#include <astl/slot_holder.h>
+#include <chrono>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace astl {
+
+    //! Compile-time list of the data types flowing through a pipeline.
+    template<typename...Ts>
+    struct type_list {};
+
+    //! A pipeline is a chain of signal operators attached to a signal.
+    //! Operators are appended with operator| and fused at compile time into a single handler functor, so a slot
+    //! connected through a pipeline costs one std::function call per event regardless of the number of operators.
+    //! Stateful operators (throttle, debounce, distinct) keep their state inside the fused functor.
+    //! \code
+    //! #include <astl/signal_operators.h>
+    //!
+    //! SpeedEvent::slot_type slot{};
+    //! (speedEvent.sig() | astl::filter([](float const& v){ return v >= 0.f; })
+    //!                   | astl::map([](float const& v){ return v * 3.6f; })
+    //!                   | astl::throttle(std::chrono::milliseconds{10})).connect(slot, [](float const& kmh){ ... });
+    //! \endcode
+    //!
+    //! \tparam Signal  The signal the pipeline is attached to.
+    //! \tparam Values  type_list of the data types produced by the last operator.
+    //! \tparam Ops     The operators in the order of their application.
+    template<typename Signal, typename Values, typename...Ops>
+    class pipeline;
+
+    template<typename TAG, typename...Ts, typename...Vs, typename...Ops>
+    class pipeline<signal<TAG, Ts...>, type_list<Vs...>, Ops...>
+    {
+    public:
+        using signal_type = signal<TAG, Ts...>;
+        using slot_type = slot<TAG, Ts...>;
+
+        pipeline(signal_type& signal, std::tuple<Ops...> ops) noexcept;
+
+        //! Appends the operator op to the pipeline.
+        template<typename Op>
+        auto operator|(Op op) &&;
+
+        //! Returns the functor with signature void(Ts const&...) fusing all operators and handler.
+        template<typename F>
+        auto fuse(F handler) &&;
+
+        //! Sets the fused functor as handler of slot and connects it to the signal.
+        template<typename F>
+        void connect(slot_type& slot, F handler) &&;
+
+        //! Connects the fused functor via holder to the signal, see slot_holder::connect.
+        template<typename F>
+        bool connect(slot_holder& holder, F handler, bool replace = false) &&;
+
+    private:
+        signal_type& signal_;
+        std::tuple<Ops...> ops_;
+    };
+
+    //! Starts a pipeline on signal with operator op.
+    template<typename TAG, typename...Ts, typename Op>
+    auto operator|(signal<TAG, Ts...>& signal, Op op);
+
+    //! Operator passing an event on only when predicate(values...) returns true.
+    template<typename P>
+    struct filter_op
+    {
+        template<typename...Vs>
+        using output = type_list<Vs...>;
+
+        template<typename Next, typename...Vs>
+        struct stage
+        {
+            void operator()(Vs const&...values)
+            {
+                if (op_.predicate_(values...)) {
+                    next_(values...);
+                }
+            }
+
+            filter_op op_;
+            Next next_;
+        };
+
+        P predicate_;
+    };
+
+    //! Operator replacing the event data by the result of f(values...).
+    template<typename F>
+    struct map_op
+    {
+        template<typename...Vs>
+        using output = type_list<std::decay_t<std::invoke_result_t<F&, Vs const&...>>>;
+
+        template<typename Next, typename...Vs>
+        struct stage
+        {
+            void operator()(Vs const&...values)
+            {
+                next_(op_.f_(values...));
+            }
+
+            map_op op_;
+            Next next_;
+        };
+
+        F f_;
+    };
+
+    //! Operator passing an event on only when at least interval has passed since the last passed event.
+    template<typename Clock>
+    struct throttle_op
+    {
+        template<typename...Vs>
+        using output = type_list<Vs...>;
+
+        template<typename Next, typename...Vs>
+        struct stage
+        {
+            void operator()(Vs const&...values)
+            {
+                auto now = Clock::now();
+                if (last_ && now - *last_ < op_.interval_) {
+                    return;
+                }
+                last_ = now;
+                next_(values...);
+            }
+
+            throttle_op op_;
+            Next next_;
+            std::optional<typename Clock::time_point> last_{};
+        };
+
+        typename Clock::duration interval_;
+    };
+
+    //! Operator passing an event on only when no other event has been received for at least quiet time before it.
+    //! As the operators run synchronously in the dispatch of the signal there is no timer that could emit a trailing
+    //! event, so this is a leading edge debounce: the first event of a burst passes, the following ones are dropped.
+    template<typename Clock>
+    struct debounce_op
+    {
+        template<typename...Vs>
+        using output = type_list<Vs...>;
+
+        template<typename Next, typename...Vs>
+        struct stage
+        {
+            void operator()(Vs const&...values)
+            {
+                auto now = Clock::now();
+                auto pass = !last_ || now - *last_ >= op_.quiet_;
+                last_ = now;
+                if (pass) {
+                    next_(values...);
+                }
+            }
+
+            debounce_op op_;
+            Next next_;
+            std::optional<typename Clock::time_point> last_{};
+        };
+
+        typename Clock::duration quiet_;
+    };
+
+    //! Key of an event for distinct_op: a tuple with copies of the event data.
+    struct tuple_key
+    {
+        template<typename...Vs>
+        std::tuple<Vs...> operator()(Vs const&...values) const
+        {
+            return std::tuple<Vs...>{values...};
+        }
+    };
+
+    //! Operator passing an event on only when key(values...) differs from the key of the last passed event.
+    template<typename Key>
+    struct distinct_op
+    {
+        template<typename...Vs>
+        using output = type_list<Vs...>;
+
+        template<typename Next, typename...Vs>
+        struct stage
+        {
+            void operator()(Vs const&...values)
+            {
+                auto key = op_.key_(values...);
+                if (last_ && *last_ == key) {
+                    return;
+                }
+                last_.emplace(std::move(key));
+                next_(values...);
+            }
+
+            distinct_op op_;
+            Next next_;
+            std::optional<std::decay_t<std::invoke_result_t<Key&, Vs const&...>>> last_{};
+        };
+
+        Key key_;
+    };
+
+    template<typename P>
+    filter_op<P> filter(P predicate);
+
+    template<typename F>
+    map_op<F> map(F f);
+
+    template<typename Clock = std::chrono::steady_clock>
+    throttle_op<Clock> throttle(typename Clock::duration interval);
+
+    template<typename Clock = std::chrono::steady_clock>
+    debounce_op<Clock> debounce(typename Clock::duration quiet);
+
+    template<typename Key = tuple_key>
+    distinct_op<Key> distinct(Key key = Key{});
+
+    //! Returns a handler that forwards its arguments to ev.invoke().
+    template<typename Event>
+    auto forward_to(Event& ev);
+
+    namespace detail {
+
+        template<typename Values, typename Handler, typename...Ops>
+        struct fuser;
+
+        template<typename...Vs, typename Handler>
+        struct fuser<type_list<Vs...>, Handler>
+        {
+            using type = Handler;
+
+            static type make(Handler handler)
+            {
+                return handler;
+            }
+        };
+
+        template<typename...Vs, typename Handler, typename Op, typename...Rest>
+        struct fuser<type_list<Vs...>, Handler, Op, Rest...>
+        {
+            using next = fuser<typename Op::template output<Vs...>, Handler, Rest...>;
+            using type = typename Op::template stage<typename next::type, Vs...>;
+
+            static type make(Handler handler, Op op, Rest...rest)
+            {
+                return type{std::move(op), next::make(std::move(handler), std::move(rest)...)};
+            }
+        };
+
+    } // namespace detail
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl pipeline
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts, typename...Vs, typename...Ops>
+    astl::pipeline<astl::signal<TAG, Ts...>, astl::type_list<Vs...>, Ops...>::pipeline(
+            signal_type& signal, std::tuple<Ops...> ops) noexcept
+        : signal_{signal}
+        , ops_{std::move(ops)}
+{}
+
+template<typename TAG, typename...Ts, typename...Vs, typename...Ops>
+    template<typename Op>
+    auto
+    astl::pipeline<astl::signal<TAG, Ts...>, astl::type_list<Vs...>, Ops...>::operator|(Op op) &&
+{
+    using values = typename Op::template output<Vs...>;
+    return pipeline<signal_type, values, Ops..., Op>{
+            signal_, std::tuple_cat(std::move(ops_), std::make_tuple(std::move(op)))};
+}
+
+template<typename TAG, typename...Ts, typename...Vs, typename...Ops>
+    template<typename F>
+    auto
+    astl::pipeline<astl::signal<TAG, Ts...>, astl::type_list<Vs...>, Ops...>::fuse(F handler) &&
+{
+    return std::apply([&handler](Ops&...ops){
+        return detail::fuser<type_list<Ts...>, F, Ops...>::make(std::move(handler), std::move(ops)...);
+    }, ops_);
+}
+
+template<typename TAG, typename...Ts, typename...Vs, typename...Ops>
+    template<typename F>
+    void
+    astl::pipeline<astl::signal<TAG, Ts...>, astl::type_list<Vs...>, Ops...>::connect(slot_type& slot, F handler) &&
+{
+    slot.set_functor(std::move(*this).fuse(std::move(handler)));
+    signal_.connect(slot);
+}
+
+template<typename TAG, typename...Ts, typename...Vs, typename...Ops>
+    template<typename F>
+    bool
+    astl::pipeline<astl::signal<TAG, Ts...>, astl::type_list<Vs...>, Ops...>::connect(
+            slot_holder& holder, F handler, bool replace) &&
+{
+    return holder.connect(signal_, std::move(*this).fuse(std::move(handler)), replace);
+}
+
+template<typename TAG, typename...Ts, typename Op>
+    auto
+    astl::operator|(signal<TAG, Ts...>& signal, Op op)
+{
+    return pipeline<astl::signal<TAG, Ts...>, type_list<Ts...>>{signal, std::tuple<>{}} | std::move(op);
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl operator factories
+// ------------------------------------------------------------------------------------------------
+template<typename P>
+    astl::filter_op<P>
+    astl::filter(P predicate)
+{
+    return filter_op<P>{std::move(predicate)};
+}
+
+template<typename F>
+    astl::map_op<F>
+    astl::map(F f)
+{
+    return map_op<F>{std::move(f)};
+}
+
+template<typename Clock>
+    astl::throttle_op<Clock>
+    astl::throttle(typename Clock::duration interval)
+{
+    return throttle_op<Clock>{interval};
+}
+
+template<typename Clock>
+    astl::debounce_op<Clock>
+    astl::debounce(typename Clock::duration quiet)
+{
+    return debounce_op<Clock>{quiet};
+}
+
+template<typename Key>
+    astl::distinct_op<Key>
+    astl::distinct(Key key)
+{
+    return distinct_op<Key>{std::move(key)};
+}
+
+template<typename Event>
+    auto
+    astl::forward_to(Event& ev)
+{
+    return [&ev](auto const&...values){ ev.invoke(values...); };
+}
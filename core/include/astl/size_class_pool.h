@@ -0,0 +1,188 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace astl {
+
+    //! Thread local free lists of memory blocks in the size classes 64, 128 and 256 bytes; larger blocks are taken
+    //! from operator new directly. A thread caches at most max_cached blocks per size class, beyond that it moves
+    //! batch_size blocks to a lock-free list shared by all threads. A thread whose cache is empty takes a batch from
+    //! there before it calls operator new, so blocks freed by a consumer thread find their way back to the producer
+    //! threads allocating them. Blocks are aligned for any type up to __STDCPP_DEFAULT_NEW_ALIGNMENT__, over-aligned
+    //! blocks are taken from the aligned operator new directly.
+    //! \code
+    //! #include <astl/size_class_pool.h>
+    //!
+    //! auto p = astl::size_class_pool::allocate(sizeof(Message), alignof(Message));
+    //! auto m = new (p) Message{};
+    //! m->~Message();
+    //! astl::size_class_pool::deallocate(p, sizeof(Message), alignof(Message));
+    //! \endcode
+    class size_class_pool
+    {
+    public:
+        static constexpr std::size_t batch_size = 32;
+        static constexpr std::size_t max_cached = 2 * batch_size;
+
+        static void* allocate(std::size_t size, std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+        //! \param size         Size passed to allocate() for p.
+        //! \param alignment    Alignment passed to allocate() for p.
+        static void deallocate(void* p, std::size_t size,
+                               std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) noexcept;
+
+    private:
+        static constexpr std::size_t classes = 3;
+
+        struct node
+        {
+            node* next;
+            node* next_batch;   // first node of a batch in the shared list only
+        };
+
+        struct cache
+        {
+            ~cache() noexcept;
+
+            node* free[classes]{};
+            std::size_t count[classes]{};
+        };
+
+        static std::size_t size_class(std::size_t size) noexcept;
+        static cache& local() noexcept;
+        static std::atomic<node*>& shared(std::size_t c) noexcept;
+        static node* take_batch(std::size_t c) noexcept;
+        static void give_batch(std::size_t c, node* first) noexcept;
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl size_class_pool
+// ------------------------------------------------------------------------------------------------
+inline void* astl::size_class_pool::allocate(std::size_t size, std::size_t alignment)
+{
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return ::operator new(size, std::align_val_t{alignment});
+    }
+    auto c = size_class(size);
+    if (c < classes) {
+        auto& l = local();
+        if (auto n = l.free[c]) {
+            l.free[c] = n->next;
+            --l.count[c];
+            return n;
+        }
+        if (auto n = take_batch(c)) {
+            l.free[c] = n->next;
+            l.count[c] = batch_size - 1;
+            return n;
+        }
+        return ::operator new(std::size_t{64} << c);
+    }
+    return ::operator new(size);
+}
+
+inline void astl::size_class_pool::deallocate(void* p, std::size_t size, std::size_t alignment) noexcept
+{
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        ::operator delete(p, std::align_val_t{alignment});
+        return;
+    }
+    auto c = size_class(size);
+    if (c < classes) {
+        auto& l = local();
+        auto n = static_cast<node*>(p);
+        n->next = l.free[c];
+        l.free[c] = n;
+        if (++l.count[c] == max_cached) {
+            auto last = n;
+            for (std::size_t i = 1; i < batch_size; ++i) {
+                last = last->next;
+            }
+            l.free[c] = last->next;
+            l.count[c] -= batch_size;
+            last->next = nullptr;
+            give_batch(c, n);
+        }
+        return;
+    }
+    ::operator delete(p);
+}
+
+inline std::size_t astl::size_class_pool::size_class(std::size_t size) noexcept
+{
+    return size <= 64 ? 0 : size <= 128 ? 1 : size <= 256 ? 2 : classes;
+}
+
+inline astl::size_class_pool::cache& astl::size_class_pool::local() noexcept
+{
+    static thread_local cache c{};
+    return c;
+}
+
+inline std::atomic<astl::size_class_pool::node*>& astl::size_class_pool::shared(std::size_t c) noexcept
+{
+    // trivially destructible, so threads can still free blocks during static destruction
+    static std::atomic<node*> batches[classes]{};
+    return batches[c];
+}
+
+inline astl::size_class_pool::node* astl::size_class_pool::take_batch(std::size_t c) noexcept
+{
+    auto& head = shared(c);
+    if (!head.load(std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    // taking the whole list instead of popping one batch leaves no room for ABA
+    auto first = head.exchange(nullptr, std::memory_order_acquire);
+    if (!first) {
+        return nullptr;
+    }
+    if (auto rest = first->next_batch) {
+        node* expected{nullptr};
+        if (!head.compare_exchange_strong(expected, rest, std::memory_order_release, std::memory_order_relaxed)) {
+            auto last = rest;
+            while (last->next_batch) {
+                last = last->next_batch;
+            }
+            do {
+                last->next_batch = expected;
+            } while (!head.compare_exchange_weak(expected, rest, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+        }
+    }
+    return first;
+}
+
+inline void astl::size_class_pool::give_batch(std::size_t c, node* first) noexcept
+{
+    auto& head = shared(c);
+    first->next_batch = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(first->next_batch, first, std::memory_order_release,
+                                       std::memory_order_relaxed)) {}
+}
+
+inline astl::size_class_pool::cache::~cache() noexcept
+{
+    for (auto& head : free) {
+        while (head) {
+            auto n = head;
+            head = n->next;
+            ::operator delete(n);
+        }
+    }
+}
@@ -12,9 +12,10 @@
 #pragma once
 
 #include <astl/event.h>
-#include <algorithm>
+#include <astl/flat_map.h>
+#include <astl/small_vector.h>
+#include <memory>
 #include <tuple>
-#include <vector>
 
 namespace astl {
 
@@ -68,7 +69,7 @@ namespace astl {
         };
 
         using value_type = std::pair<void*, std::unique_ptr<abstract_item>>;
-        std::vector<value_type> slots_{};
+        flat_map<void*, std::unique_ptr<abstract_item>, std::less<void*>, small_vector<value_type, 4>> slots_{};
     };
 
 } // namespace astl
@@ -76,7 +77,7 @@ namespace astl {
 template<typename F, typename TAG, typename...Ts>
 bool astl::slot_holder::connect(astl::signal<TAG, Ts...>& signal, F f, bool replace) noexcept
 {
-    auto i = std::find_if(slots_.begin(), slots_.end(), [&signal](value_type const& v){return v.first == &signal;});
+    auto i = slots_.find(&signal);
     if (i != slots_.end() && !replace) {
         return false;
     }
@@ -85,24 +86,21 @@ bool astl::slot_holder::connect(astl::signal<TAG, Ts...>& signal, F f, bool repl
     }
     auto slotItem = std::make_unique<item<TAG, Ts...>>(std::forward<F>(f));
     signal.connect(slotItem->get());
-    slots_.push_back(std::make_pair(&signal, std::move(slotItem)));
+    slots_.try_emplace(&signal, std::move(slotItem));
     return true;
 }
 
 template<typename TAG, typename...Ts>
 void astl::slot_holder::disconnect(astl::signal<TAG, Ts...>& signal) noexcept
 {
-    auto i = std::find_if(slots_.begin(), slots_.end(), [&signal](value_type const& v){return v.first == &signal;});
-    if (i != slots_.end()) {
-        slots_.erase(i);
-    }
+    slots_.erase(&signal);
 }
 
 template<typename TAG, typename...Ts>
 bool astl::slot_holder::is_connected(astl::signal<TAG, Ts...>& signal) const noexcept
 {
-    auto i = std::find_if(slots_.cbegin(), slots_.cend(), [&signal](value_type const& v){return v.first == &signal;});
-    if (i == slots_.cend())
+    auto i = slots_.find(&signal);
+    if (i == slots_.end())
         return false;
     return i->second->is_connected();
 }
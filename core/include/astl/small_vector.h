@@ -0,0 +1,569 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace astl {
+
+    //! Contiguous sequence container storing up to N elements inside the object itself.
+    //! Only when more than N elements are stored the elements move to storage obtained from the allocator; they stay
+    //! there until the container is destroyed or shrink_to_fit() is called. Iterators are pointers and are invalidated
+    //! like those of std::vector, additionally by moving the container while its elements are stored inline.
+    //! \code
+    //! #include <astl/small_vector.h>
+    //!
+    //! astl::small_vector<int, 4> v{1, 2, 3};
+    //! v.push_back(4);     // still no heap allocation
+    //! v.push_back(5);     // moves to the heap
+    //! \endcode
+    //!
+    //! \tparam T           Type of the elements.
+    //! \tparam N           Number of elements stored inline, at least 1.
+    //! \tparam Allocator   Allocator for more than N elements.
+    template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+    class small_vector : private Allocator
+    {
+        static_assert(N > 0, "small_vector needs an inline capacity");
+        using traits = std::allocator_traits<Allocator>;
+
+    public:
+        using value_type = T;
+        using allocator_type = Allocator;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = T const&;
+        using pointer = T*;
+        using const_pointer = T const*;
+        using iterator = T*;
+        using const_iterator = T const*;
+
+        static constexpr size_type inline_capacity = N;
+
+        small_vector() noexcept(noexcept(Allocator{}));
+        explicit small_vector(Allocator const& alloc) noexcept;
+        small_vector(std::initializer_list<T> values, Allocator const& alloc = Allocator{});
+        small_vector(small_vector const& other);
+        small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+        ~small_vector() noexcept;
+
+        small_vector& operator=(small_vector const& other);
+        small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+
+        [[nodiscard]] allocator_type get_allocator() const noexcept;
+
+        iterator begin() noexcept;
+        iterator end() noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator cend() const noexcept;
+
+        T* data() noexcept;
+        T const* data() const noexcept;
+        T& operator[](size_type i) noexcept;
+        T const& operator[](size_type i) const noexcept;
+        T& front() noexcept;
+        T const& front() const noexcept;
+        T& back() noexcept;
+        T const& back() const noexcept;
+
+        [[nodiscard]] bool empty() const noexcept;
+        [[nodiscard]] size_type size() const noexcept;
+        [[nodiscard]] size_type capacity() const noexcept;
+
+        //! Returns whether the elements are stored inside the object.
+        [[nodiscard]] bool is_inline() const noexcept;
+
+        void reserve(size_type capacity);
+
+        //! Moves the elements back inline if they fit, otherwise to storage of exactly size() elements.
+        void shrink_to_fit();
+
+        void clear() noexcept;
+
+        template<typename...Args>
+        T& emplace_back(Args&&...args);
+        void push_back(T const& value);
+        void push_back(T&& value);
+        void pop_back() noexcept;
+
+        template<typename...Args>
+        iterator emplace(const_iterator pos, Args&&...args);
+        iterator insert(const_iterator pos, T const& value);
+        iterator insert(const_iterator pos, T&& value);
+
+        iterator erase(const_iterator pos) noexcept;
+        iterator erase(const_iterator first, const_iterator last) noexcept;
+
+        void resize(size_type count);
+
+    private:
+        T* inline_data() noexcept;
+        Allocator& allocator() noexcept;
+        void grow(size_type capacity);
+        void release() noexcept;
+        void move_from(small_vector& other);
+
+    private:
+        T* data_;
+        size_type size_{0};
+        size_type capacity_{N};
+        alignas(T) unsigned char inline_[N * sizeof(T)];
+    };
+
+    template<typename T, std::size_t N, typename A>
+    bool operator==(small_vector<T, N, A> const& lhs, small_vector<T, N, A> const& rhs);
+
+    template<typename T, std::size_t N, typename A>
+    bool operator!=(small_vector<T, N, A> const& lhs, small_vector<T, N, A> const& rhs);
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl small_vector
+// ------------------------------------------------------------------------------------------------
+template<typename T, std::size_t N, typename Allocator>
+    astl::small_vector<T, N, Allocator>::small_vector() noexcept(noexcept(Allocator{}))
+        : Allocator{}
+        , data_{inline_data()}
+{}
+
+template<typename T, std::size_t N, typename Allocator>
+    astl::small_vector<T, N, Allocator>::small_vector(Allocator const& alloc) noexcept
+        : Allocator{alloc}
+        , data_{inline_data()}
+{}
+
+template<typename T, std::size_t N, typename Allocator>
+    astl::small_vector<T, N, Allocator>::small_vector(std::initializer_list<T> values, Allocator const& alloc)
+        : Allocator{alloc}
+        , data_{inline_data()}
+{
+    reserve(values.size());
+    for (auto const& v : values) {
+        emplace_back(v);
+    }
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    astl::small_vector<T, N, Allocator>::small_vector(small_vector const& other)
+        : Allocator{traits::select_on_container_copy_construction(other.get_allocator())}
+        , data_{inline_data()}
+{
+    reserve(other.size());
+    for (auto const& v : other) {
+        emplace_back(v);
+    }
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    astl::small_vector<T, N, Allocator>::small_vector(small_vector&& other)
+        noexcept(std::is_nothrow_move_constructible_v<T>)
+        : Allocator{std::move(other.allocator())}
+        , data_{inline_data()}
+{
+    move_from(other);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    astl::small_vector<T, N, Allocator>::~small_vector() noexcept
+{
+    release();
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    astl::small_vector<T, N, Allocator>&
+    astl::small_vector<T, N, Allocator>::operator=(small_vector const& other)
+{
+    if (this != &other) {
+        clear();
+        reserve(other.size());
+        for (auto const& v : other) {
+            emplace_back(v);
+        }
+    }
+    return *this;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    astl::small_vector<T, N, Allocator>&
+    astl::small_vector<T, N, Allocator>::operator=(small_vector&& other)
+        noexcept(std::is_nothrow_move_constructible_v<T>)
+{
+    if (this != &other) {
+        release();
+        data_ = inline_data();
+        capacity_ = N;
+        if constexpr (traits::propagate_on_container_move_assignment::value) {
+            allocator() = std::move(other.allocator());
+        }
+        move_from(other);
+    }
+    return *this;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    Allocator
+    astl::small_vector<T, N, Allocator>::get_allocator() const noexcept
+{
+    return *this;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T*
+    astl::small_vector<T, N, Allocator>::begin() noexcept
+{
+    return data_;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T*
+    astl::small_vector<T, N, Allocator>::end() noexcept
+{
+    return data_ + size_;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T const*
+    astl::small_vector<T, N, Allocator>::begin() const noexcept
+{
+    return data_;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T const*
+    astl::small_vector<T, N, Allocator>::end() const noexcept
+{
+    return data_ + size_;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T const*
+    astl::small_vector<T, N, Allocator>::cbegin() const noexcept
+{
+    return data_;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T const*
+    astl::small_vector<T, N, Allocator>::cend() const noexcept
+{
+    return data_ + size_;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T*
+    astl::small_vector<T, N, Allocator>::data() noexcept
+{
+    return data_;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T const*
+    astl::small_vector<T, N, Allocator>::data() const noexcept
+{
+    return data_;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T&
+    astl::small_vector<T, N, Allocator>::operator[](size_type i) noexcept
+{
+    assert(i < size_);
+    return data_[i];
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T const&
+    astl::small_vector<T, N, Allocator>::operator[](size_type i) const noexcept
+{
+    assert(i < size_);
+    return data_[i];
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T&
+    astl::small_vector<T, N, Allocator>::front() noexcept
+{
+    assert(size_ > 0);
+    return data_[0];
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T const&
+    astl::small_vector<T, N, Allocator>::front() const noexcept
+{
+    assert(size_ > 0);
+    return data_[0];
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T&
+    astl::small_vector<T, N, Allocator>::back() noexcept
+{
+    assert(size_ > 0);
+    return data_[size_ - 1];
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T const&
+    astl::small_vector<T, N, Allocator>::back() const noexcept
+{
+    assert(size_ > 0);
+    return data_[size_ - 1];
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    bool
+    astl::small_vector<T, N, Allocator>::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    std::size_t
+    astl::small_vector<T, N, Allocator>::size() const noexcept
+{
+    return size_;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    std::size_t
+    astl::small_vector<T, N, Allocator>::capacity() const noexcept
+{
+    return capacity_;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    bool
+    astl::small_vector<T, N, Allocator>::is_inline() const noexcept
+{
+    return data_ == reinterpret_cast<T const*>(inline_);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    void
+    astl::small_vector<T, N, Allocator>::reserve(size_type capacity)
+{
+    if (capacity > capacity_) {
+        grow(capacity);
+    }
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    void
+    astl::small_vector<T, N, Allocator>::shrink_to_fit()
+{
+    if (is_inline() || size_ == capacity_) {
+        return;
+    }
+    auto old = data_;
+    auto old_capacity = capacity_;
+    if (size_ <= N) {
+        data_ = inline_data();
+        capacity_ = N;
+    }
+    else {
+        data_ = traits::allocate(allocator(), size_);
+        capacity_ = size_;
+    }
+    std::uninitialized_move(old, old + size_, data_);
+    std::destroy(old, old + size_);
+    traits::deallocate(allocator(), old, old_capacity);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    void
+    astl::small_vector<T, N, Allocator>::clear() noexcept
+{
+    std::destroy(begin(), end());
+    size_ = 0;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    template<typename...Args>
+    T&
+    astl::small_vector<T, N, Allocator>::emplace_back(Args&&...args)
+{
+    if (size_ == capacity_) {
+        // construct first, args may refer to an element
+        T value(std::forward<Args>(args)...);
+        grow(2 * capacity_);
+        traits::construct(allocator(), data_ + size_, std::move(value));
+    }
+    else {
+        traits::construct(allocator(), data_ + size_, std::forward<Args>(args)...);
+    }
+    return data_[size_++];
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    void
+    astl::small_vector<T, N, Allocator>::push_back(T const& value)
+{
+    emplace_back(value);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    void
+    astl::small_vector<T, N, Allocator>::push_back(T&& value)
+{
+    emplace_back(std::move(value));
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    void
+    astl::small_vector<T, N, Allocator>::pop_back() noexcept
+{
+    assert(size_ > 0);
+    traits::destroy(allocator(), data_ + --size_);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    template<typename...Args>
+    T*
+    astl::small_vector<T, N, Allocator>::emplace(const_iterator pos, Args&&...args)
+{
+    auto index = pos - begin();
+    emplace_back(std::forward<Args>(args)...);
+    std::rotate(begin() + index, end() - 1, end());
+    return begin() + index;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T*
+    astl::small_vector<T, N, Allocator>::insert(const_iterator pos, T const& value)
+{
+    return emplace(pos, value);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T*
+    astl::small_vector<T, N, Allocator>::insert(const_iterator pos, T&& value)
+{
+    return emplace(pos, std::move(value));
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T*
+    astl::small_vector<T, N, Allocator>::erase(const_iterator pos) noexcept
+{
+    return erase(pos, pos + 1);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T*
+    astl::small_vector<T, N, Allocator>::erase(const_iterator first, const_iterator last) noexcept
+{
+    auto f = begin() + (first - begin());
+    auto l = begin() + (last - begin());
+    if (f != l) {
+        auto new_end = std::move(l, end(), f);
+        std::destroy(new_end, end());
+        size_ -= static_cast<size_type>(l - f);
+    }
+    return f;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    void
+    astl::small_vector<T, N, Allocator>::resize(size_type count)
+{
+    if (count < size_) {
+        erase(begin() + count, end());
+        return;
+    }
+    reserve(count);
+    while (size_ < count) {
+        emplace_back();
+    }
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    T*
+    astl::small_vector<T, N, Allocator>::inline_data() noexcept
+{
+    return reinterpret_cast<T*>(inline_);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    Allocator&
+    astl::small_vector<T, N, Allocator>::allocator() noexcept
+{
+    return *this;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    void
+    astl::small_vector<T, N, Allocator>::grow(size_type capacity)
+{
+    auto p = traits::allocate(allocator(), capacity);
+    std::uninitialized_move(begin(), end(), p);
+    std::destroy(begin(), end());
+    if (!is_inline()) {
+        traits::deallocate(allocator(), data_, capacity_);
+    }
+    data_ = p;
+    capacity_ = capacity;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    void
+    astl::small_vector<T, N, Allocator>::release() noexcept
+{
+    clear();
+    if (!is_inline()) {
+        traits::deallocate(allocator(), data_, capacity_);
+    }
+}
+
+template<typename T, std::size_t N, typename Allocator>
+    void
+    astl::small_vector<T, N, Allocator>::move_from(small_vector& other)
+{
+    // precondition: this is empty and inline
+    if (!other.is_inline() && allocator() == other.allocator()) {
+        data_ = std::exchange(other.data_, other.inline_data());
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, N);
+        return;
+    }
+    reserve(other.size());
+    for (auto& v : other) {
+        emplace_back(std::move(v));
+    }
+    other.clear();
+}
+
+template<typename T, std::size_t N, typename A>
+    bool
+    astl::operator==(small_vector<T, N, A> const& lhs, small_vector<T, N, A> const& rhs)
+{
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template<typename T, std::size_t N, typename A>
+    bool
+    astl::operator!=(small_vector<T, N, A> const& lhs, small_vector<T, N, A> const& rhs)
+{
+    return !(lhs == rhs);
+}
@@ -0,0 +1,169 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/event.h>
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace astl {
+
+    //! Event whose handlers are fixed at compile time.
+    //! The handlers are stored in a tuple and invoked by a fold expression, so the compiler can inline all of them
+    //! into invoke(). There are no slots, no connections and no type erasure. Compared to astl::event the semantics
+    //! of \link signal-slot Event Delegation \endlink apply with these differences:
+    //! - [S1] every handler is invoked exactly once per invocation,
+    //! - [S2] handlers are invoked in the order of the Handlers parameter pack,
+    //! - [S3], [S4] handlers cannot be connected or disconnected,
+    //! - [S5'] recursive invocation results in undefined behavior (DEBUG builds will terminate).
+    //! A dynamic_forwarder as handler forwards the invocations to an astl::signal for subscribers only known at
+    //! runtime.
+    //! \code
+    //! #include <astl/static_dispatch_event.h>
+    //!
+    //! auto ev = astl::make_static_dispatch_event<SpeedEventFlag>(
+    //!         [&controller](float const& v){ controller.on_speed(v); },
+    //!         astl::dynamic_forwarder<SpeedEventFlag, float>{});
+    //! ev.handler<1>().sig().connect(lateSlot);
+    //! ev.invoke(23.3f);
+    //! \endcode
+    //!
+    //! \tparam TAG         Tagging type to distinguish events.
+    //! \tparam Handlers    Types of the handler functors, each callable with the event data as const references.
+    template<typename TAG, typename...Handlers>
+    class static_dispatch_event
+    {
+    public:
+        using handlers_type = std::tuple<Handlers...>;
+
+        //! Default constructs all handlers.
+        explicit static_dispatch_event() = default;
+
+        //! Constructs the handlers from hs.
+        template<typename...Hs, typename = std::enable_if_t<sizeof...(Hs) == sizeof...(Handlers) && sizeof...(Hs) != 0
+                && !std::is_same_v<std::tuple<std::decay_t<Hs>...>, std::tuple<static_dispatch_event>>>>
+        explicit static_dispatch_event(Hs&&...hs);
+
+        ~static_dispatch_event() = default;
+
+        static_dispatch_event(static_dispatch_event const&) = default;
+        static_dispatch_event(static_dispatch_event&&) = default;
+        static_dispatch_event& operator=(static_dispatch_event const&) = delete;
+
+        //! Invokes all handlers with the given data as const references.
+        template<typename...Args>
+        void invoke(Args&&...args) noexcept;
+
+        //! Returns the I-th handler.
+        template<std::size_t I>
+        std::tuple_element_t<I, handlers_type>& handler() noexcept;
+
+    private:
+        handlers_type handlers_{};
+#ifndef NDEBUG
+        bool dispatching_{false};
+#endif
+    };
+
+    //! Creates a static_dispatch_event with handlers of deduced types.
+    template<typename TAG, typename...Handlers>
+    static_dispatch_event<TAG, Handlers...> make_static_dispatch_event(Handlers...handlers);
+
+    //! Handler forwarding static dispatches to an astl::signal to which slots can connect at runtime.
+    //! Copies of a forwarder start without connected slots, so copy it only before connecting slots.
+    template<typename TAG, typename...Ts>
+    class dynamic_forwarder
+    {
+    public:
+        using signal_type = typename event<TAG, Ts...>::signal_type;
+        using slot_type = typename event<TAG, Ts...>::slot_type;
+
+        explicit dynamic_forwarder() = default;
+        dynamic_forwarder(dynamic_forwarder const&) noexcept;
+        dynamic_forwarder& operator=(dynamic_forwarder const&) = delete;
+
+        //! Returns the signal for late subscribers.
+        signal_type& sig() noexcept;
+
+        void operator()(Ts const&...args) noexcept;
+
+    private:
+        event<TAG, Ts...> event_{};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl static_dispatch_event
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Handlers>
+    template<typename...Hs, typename>
+    astl::static_dispatch_event<TAG, Handlers...>::static_dispatch_event(Hs&&...hs)
+        : handlers_{std::forward<Hs>(hs)...}
+{}
+
+template<typename TAG, typename...Handlers>
+    template<typename...Args>
+    void
+    astl::static_dispatch_event<TAG, Handlers...>::invoke(Args&&...args) noexcept
+{
+#ifndef NDEBUG
+    assert(!dispatching_);
+    dispatching_ = true;
+#endif
+    std::apply([&args...](Handlers&...handlers){
+        (handlers(static_cast<Args const&>(args)...), ...);
+    }, handlers_);
+#ifndef NDEBUG
+    dispatching_ = false;
+#endif
+}
+
+template<typename TAG, typename...Handlers>
+    template<std::size_t I>
+    std::tuple_element_t<I, typename astl::static_dispatch_event<TAG, Handlers...>::handlers_type>&
+    astl::static_dispatch_event<TAG, Handlers...>::handler() noexcept
+{
+    return std::get<I>(handlers_);
+}
+
+template<typename TAG, typename...Handlers>
+    astl::static_dispatch_event<TAG, Handlers...>
+    astl::make_static_dispatch_event(Handlers...handlers)
+{
+    return static_dispatch_event<TAG, Handlers...>{std::move(handlers)...};
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl dynamic_forwarder
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts>
+    astl::dynamic_forwarder<TAG, Ts...>::dynamic_forwarder(dynamic_forwarder const&) noexcept
+        : dynamic_forwarder{}
+{}
+
+template<typename TAG, typename...Ts>
+    typename astl::dynamic_forwarder<TAG, Ts...>::signal_type&
+    astl::dynamic_forwarder<TAG, Ts...>::sig() noexcept
+{
+    return event_.sig();
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::dynamic_forwarder<TAG, Ts...>::operator()(Ts const&...args) noexcept
+{
+    event_.invoke(args...);
+}
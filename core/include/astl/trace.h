@@ -0,0 +1,416 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/mapped_file.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <typeinfo>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace astl::trace {
+
+    //! Flags stored with each trace record.
+    enum record_flags : std::uint32_t {
+        dispatched  = 0,    //!< the event has been dispatched to the slots of its signal
+        queued      = 1,    //!< a recursive invocation has been queued by astl::recursive_event
+    };
+
+    //! Clock source of the timestamps in a trace file.
+    enum class clock_type : std::uint32_t {
+        tsc         = 1,    //!< CPU time stamp counter ticks
+        steady_ns   = 2,    //!< std::chrono::steady_clock nanoseconds
+    };
+
+    //! Fixed size binary record written for each event invocation.
+    struct record
+    {
+        std::uint64_t timestamp;    //!< start of the invocation
+        std::uint64_t tag_id;       //!< identifies the TAG of the event, see file_header and tag_entry
+        std::uint32_t slot_count;   //!< number of slots connected when the invocation started
+        std::uint32_t duration;     //!< duration of the dispatch in clock ticks (saturated)
+        std::uint32_t flags;        //!< see record_flags
+        std::uint32_t reserved;
+    };
+    static_assert(sizeof(record) == 32);
+
+    //! Maps a tag id to the (mangled) type name of the TAG.
+    struct tag_entry
+    {
+        std::uint64_t tag_id;
+        char name[120];
+    };
+    static_assert(sizeof(tag_entry) == 128);
+
+    //! Header at the start of a trace file. It is followed by tag_capacity tag entries and capacity records.
+    struct file_header
+    {
+        char magic[8];
+        std::uint32_t version;
+        clock_type clock;
+        std::uint64_t capacity;
+        std::uint32_t tag_capacity;
+        std::atomic<std::uint32_t> tag_count;
+        alignas(64) std::atomic<std::uint64_t> head;    //!< total number of records ever written
+    };
+    static_assert(sizeof(file_header) == 128);
+
+    constexpr char file_magic[8] = {'A', 'S', 'T', 'L', 'T', 'R', 'C', '\0'};
+    constexpr std::uint32_t file_version = 1;
+
+    //! Returns the clock source used by now().
+    constexpr clock_type clock() noexcept;
+
+    //! Returns the current timestamp of the trace clock.
+    std::uint64_t now() noexcept;
+
+    //! Per-thread ring buffer of trace records in a memory-mapped file.
+    //! A buffer has exactly one writer - the thread it is attached to - and therefore needs no locking. The file
+    //! survives a crash of the process so that the last records can be decoded post-mortem with astl-trace-dump.
+    //! \code
+    //! #include <astl/trace.h>
+    //!
+    //! astl::trace::buffer tb{};
+    //! if (tb.open("/var/tmp/myapp-trace-" + std::to_string(::gettid()), 1u << 16)) {
+    //!     tb.attach();    // all event invocations of this thread are traced from now on
+    //! }
+    //! \endcode
+    class buffer
+    {
+    public:
+        explicit buffer() noexcept = default;
+        ~buffer() noexcept;
+
+        buffer(buffer const&) = delete;
+        buffer& operator=(buffer const&) = delete;
+
+        //! Creates (or truncates) the trace file at path.
+        //! \param capacity     Number of records in the ring, rounded up to a power of two.
+        //! \param tag_capacity Maximum number of different TAGs whose names are recorded.
+        bool open(std::string const& path, std::size_t capacity, std::size_t tag_capacity = 256) noexcept;
+
+        //! Makes this buffer the trace target of the calling thread.
+        void attach() noexcept;
+
+        //! Stops tracing of the calling thread if this buffer is attached to it.
+        void detach() noexcept;
+
+        //! Returns the buffer attached to the calling thread or nullptr.
+        static buffer* current() noexcept;
+
+        //! Appends a record, overwriting the oldest one when the ring is full.
+        void write(record const& r) noexcept;
+
+        //! Records the name for tag_id in the tag table of the file. Returns false when the table is full.
+        bool register_tag(std::uint64_t tag_id, char const* name) noexcept;
+
+        //! Unique number of the opened file, used to detect when TAG names must be registered again.
+        [[nodiscard]] std::uint64_t generation() const noexcept;
+
+    private:
+        mapped_file file_{};
+        file_header* header_{nullptr};
+        tag_entry* tags_{nullptr};
+        record* records_{nullptr};
+        std::uint64_t mask_{0};
+        std::uint64_t generation_{0};
+
+        static inline thread_local buffer* current_{nullptr};
+    };
+
+    //! Read access to a trace file, used by the decoder tool.
+    class reader
+    {
+    public:
+        //! Opens the trace file at path. Returns false if it is not a valid trace file.
+        bool open(std::string const& path) noexcept;
+
+        [[nodiscard]] clock_type clock() const noexcept;
+        [[nodiscard]] std::uint64_t capacity() const noexcept;
+
+        //! Total number of records written, including those already overwritten.
+        [[nodiscard]] std::uint64_t written() const noexcept;
+
+        //! Returns the name registered for tag_id or nullptr.
+        [[nodiscard]] char const* tag_name(std::uint64_t tag_id) const noexcept;
+
+        //! Calls f(std::uint64_t index, record const&) for all records still in the ring, oldest first.
+        template<typename F>
+        void for_each(F f) const;
+
+    private:
+        mapped_file file_{};
+        file_header const* header_{nullptr};
+        tag_entry const* tags_{nullptr};
+        record const* records_{nullptr};
+    };
+
+    //! Identity of a TAG type in trace records.
+    template<typename TAG>
+    struct tag_info
+    {
+        static std::uint64_t id() noexcept;
+        static char const* name() noexcept;
+
+    private:
+        static inline char const anchor_{};
+        static inline thread_local std::uint64_t generation_{0};
+        template<typename TAG1> friend void write_record(std::uint64_t, std::size_t, std::uint32_t, std::uint32_t) noexcept;
+    };
+
+    //! Writes a record for an invocation of an event with TAG to the buffer of the calling thread, if any.
+    template<typename TAG>
+    void write_record(std::uint64_t start, std::size_t slot_count, std::uint32_t duration, std::uint32_t flags) noexcept;
+
+    //! Traces the lifetime of a scope - the dispatch of an event - as one record.
+    template<typename TAG>
+    class scope
+    {
+    public:
+        explicit scope(std::size_t slot_count) noexcept;
+        ~scope() noexcept;
+
+        scope(scope const&) = delete;
+        scope& operator=(scope const&) = delete;
+
+    private:
+        std::uint64_t start_{0};
+        std::size_t slot_count_;
+        bool active_;
+    };
+
+} // namespace astl::trace
+
+// ------------------------------------------------------------------------------------------------
+// impl clock
+// ------------------------------------------------------------------------------------------------
+constexpr astl::trace::clock_type astl::trace::clock() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return clock_type::tsc;
+#else
+    return clock_type::steady_ns;
+#endif
+}
+
+inline std::uint64_t astl::trace::now() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl buffer
+// ------------------------------------------------------------------------------------------------
+inline astl::trace::buffer::~buffer() noexcept
+{
+    detach();
+}
+
+inline bool astl::trace::buffer::open(std::string const& path, std::size_t capacity, std::size_t tag_capacity) noexcept
+{
+    detach();
+    std::uint64_t cap{1};
+    while (cap < capacity) {
+        cap <<= 1u;
+    }
+    auto size = sizeof(file_header) + tag_capacity * sizeof(tag_entry) + cap * sizeof(record);
+    // truncate first - records of a previous run must not be mixed with the new ones
+    if (!file_.open(path, 0) || !file_.resize(size)) {
+        return false;
+    }
+    std::memset(static_cast<void*>(file_.data()), 0, size);
+
+    header_ = new (file_.data()) file_header{};
+    tags_ = reinterpret_cast<tag_entry*>(file_.data() + sizeof(file_header));
+    records_ = reinterpret_cast<record*>(file_.data() + sizeof(file_header) + tag_capacity * sizeof(tag_entry));
+    std::memcpy(header_->magic, file_magic, sizeof(file_magic));
+    header_->version = file_version;
+    header_->clock = trace::clock();
+    header_->capacity = cap;
+    header_->tag_capacity = static_cast<std::uint32_t>(tag_capacity);
+    mask_ = cap - 1;
+
+    static std::atomic<std::uint64_t> generations{0};
+    generation_ = ++generations;
+    return true;
+}
+
+inline void astl::trace::buffer::attach() noexcept
+{
+    if (header_) {
+        current_ = this;
+    }
+}
+
+inline void astl::trace::buffer::detach() noexcept
+{
+    if (current_ == this) {
+        current_ = nullptr;
+    }
+}
+
+inline astl::trace::buffer* astl::trace::buffer::current() noexcept
+{
+    return current_;
+}
+
+inline void astl::trace::buffer::write(record const& r) noexcept
+{
+    auto head = header_->head.load(std::memory_order_relaxed);
+    records_[head & mask_] = r;
+    header_->head.store(head + 1, std::memory_order_release);
+}
+
+inline bool astl::trace::buffer::register_tag(std::uint64_t tag_id, char const* name) noexcept
+{
+    auto count = header_->tag_count.load(std::memory_order_relaxed);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        if (tags_[i].tag_id == tag_id) {
+            return true;
+        }
+    }
+    if (count == header_->tag_capacity) {
+        return false;
+    }
+    tags_[count].tag_id = tag_id;
+    std::strncpy(tags_[count].name, name, sizeof(tag_entry::name) - 1);
+    header_->tag_count.store(count + 1, std::memory_order_release);
+    return true;
+}
+
+inline std::uint64_t astl::trace::buffer::generation() const noexcept
+{
+    return generation_;
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl reader
+// ------------------------------------------------------------------------------------------------
+inline bool astl::trace::reader::open(std::string const& path) noexcept
+{
+    if (!file_.open_read_only(path) || file_.size() < sizeof(file_header)) {
+        return false;
+    }
+    header_ = reinterpret_cast<file_header const*>(file_.data());
+    if (std::memcmp(header_->magic, file_magic, sizeof(file_magic)) != 0 || header_->version != file_version) {
+        return false;
+    }
+    auto tags_size = header_->tag_capacity * sizeof(tag_entry);
+    if (file_.size() < sizeof(file_header) + tags_size + header_->capacity * sizeof(record)) {
+        return false;
+    }
+    tags_ = reinterpret_cast<tag_entry const*>(file_.data() + sizeof(file_header));
+    records_ = reinterpret_cast<record const*>(file_.data() + sizeof(file_header) + tags_size);
+    return true;
+}
+
+inline astl::trace::clock_type astl::trace::reader::clock() const noexcept
+{
+    return header_->clock;
+}
+
+inline std::uint64_t astl::trace::reader::capacity() const noexcept
+{
+    return header_->capacity;
+}
+
+inline std::uint64_t astl::trace::reader::written() const noexcept
+{
+    return header_->head.load(std::memory_order_acquire);
+}
+
+inline char const* astl::trace::reader::tag_name(std::uint64_t tag_id) const noexcept
+{
+    auto count = header_->tag_count.load(std::memory_order_acquire);
+    for (std::uint32_t i = 0; i < count && i < header_->tag_capacity; ++i) {
+        if (tags_[i].tag_id == tag_id) {
+            return tags_[i].name;
+        }
+    }
+    return nullptr;
+}
+
+template<typename F>
+void astl::trace::reader::for_each(F f) const
+{
+    auto head = written();
+    auto first = head > header_->capacity ? head - header_->capacity : 0;
+    for (auto i = first; i < head; ++i) {
+        f(i, records_[i & (header_->capacity - 1)]);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl tag_info, write_record, scope
+// ------------------------------------------------------------------------------------------------
+template<typename TAG>
+    std::uint64_t
+    astl::trace::tag_info<TAG>::id() noexcept
+{
+    return reinterpret_cast<std::uintptr_t>(&anchor_);
+}
+
+template<typename TAG>
+    char const*
+    astl::trace::tag_info<TAG>::name() noexcept
+{
+    return typeid(TAG).name();
+}
+
+template<typename TAG>
+    void
+    astl::trace::write_record(std::uint64_t start, std::size_t slot_count, std::uint32_t duration,
+                              std::uint32_t flags) noexcept
+{
+    auto buf = buffer::current();
+    if (!buf) {
+        return;
+    }
+    if (tag_info<TAG>::generation_ != buf->generation()) {
+        // first record for TAG in this buffer - make its name available to the decoder
+        buf->register_tag(tag_info<TAG>::id(), tag_info<TAG>::name());
+        tag_info<TAG>::generation_ = buf->generation();
+    }
+    buf->write(record{start, tag_info<TAG>::id(), static_cast<std::uint32_t>(slot_count), duration, flags, 0});
+}
+
+template<typename TAG>
+    astl::trace::scope<TAG>::scope(std::size_t slot_count) noexcept
+        : slot_count_{slot_count}
+        , active_{buffer::current() != nullptr}
+{
+    if (active_) {
+        start_ = now();
+    }
+}
+
+template<typename TAG>
+    astl::trace::scope<TAG>::~scope() noexcept
+{
+    if (active_) {
+        auto duration = now() - start_;
+        auto saturated = duration > UINT32_MAX ? UINT32_MAX : static_cast<std::uint32_t>(duration);
+        write_record<TAG>(start_, slot_count_, saturated, dispatched);
+    }
+}
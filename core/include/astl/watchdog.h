@@ -0,0 +1,483 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#include <cxxabi.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+
+namespace astl::watchdog {
+
+    class monitor;
+
+    //! Stalled slot handler or event loop detected by a monitor.
+    struct stall_report
+    {
+        std::string thread;                 //!< name of the heartbeat of the stalled thread
+        std::string tag;                    //!< demangled TAG of the dispatching signal, empty for an event loop
+        void const* slot;                   //!< address of the running slot, nullptr for an event loop
+        std::chrono::nanoseconds duration;  //!< time it has been running when the stall was detected
+        std::uint64_t suppressed;           //!< reports dropped by the rate limit since the previous report
+        std::string stack;                  //!< stack of the stalled thread if captured, one frame per line
+    };
+
+    //! Parameters of a monitor.
+    struct options
+    {
+        //! A slot handler or event loop iteration running longer is reported.
+        std::chrono::milliseconds threshold{100};
+        //! Minimal time between two reports, stalls detected in between are counted as suppressed.
+        std::chrono::milliseconds report_interval{1000};
+        //! Captures the stack of the stalled thread by sending it stack_signal. The monitor installs the signal handler.
+        bool capture_stack{false};
+        int stack_signal{SIGURG};
+    };
+
+    //! Dispatch state of a thread watched by a monitor.
+    //! Once attached to its thread, every slot invoked by signal dispatch on this thread - with ASTL_WATCHDOG defined -
+    //! publishes its address with one relaxed atomic store. Event loops call beat() once per iteration and idle()
+    //! before they block, so that waiting for events is not taken for a stall.
+    //! \code
+    //! #include <astl/watchdog.h>
+    //!
+    //! astl::watchdog::heartbeat hb{monitor, "io-loop"};
+    //! hb.attach();
+    //! while (running) {
+    //!     hb.idle();
+    //!     wait_for_events();
+    //!     hb.beat();
+    //!     dispatch_events();
+    //! }
+    //! \endcode
+    class heartbeat
+    {
+    public:
+        //! Registers the heartbeat with the monitor.
+        explicit heartbeat(monitor& m, std::string name);
+        ~heartbeat() noexcept;
+
+        heartbeat(heartbeat const&) = delete;
+        heartbeat& operator=(heartbeat const&) = delete;
+
+        //! Makes this heartbeat the one of the calling thread. It has to be detached or destroyed before the thread ends.
+        void attach() noexcept;
+
+        //! Stops watching the calling thread if this heartbeat is attached to it.
+        void detach() noexcept;
+
+        //! Returns the heartbeat attached to the calling thread or nullptr.
+        static heartbeat* current() noexcept;
+
+        //! Starts an iteration of an event loop.
+        void beat() noexcept;
+
+        //! Marks the thread as waiting, it is not watched until the next beat() or dispatch.
+        void idle() noexcept;
+
+    private:
+        friend class monitor;
+        template<typename TAG> friend class dispatch_scope;
+
+        struct state
+        {
+            std::uint64_t word;
+            char const* tag;
+        };
+
+        // the upper 16 bits count the stores, so that repeated invocations of the same slot are told apart
+        static constexpr std::uint64_t address_mask = (std::uint64_t{1} << 48u) - 1;
+        static constexpr std::uint64_t loop_address = 1;
+
+        void publish(std::uintptr_t address) noexcept;
+        state enter(char const* tag) noexcept;
+        void leave(state const& previous) noexcept;
+
+    private:
+        monitor& monitor_;
+        std::string const name_;
+        std::atomic<std::uint64_t> word_{0};            // 0 while idle
+        std::atomic<char const*> tag_{nullptr};
+        std::uint64_t count_{0};                        // written by the attached thread only
+        pthread_t thread_{};
+        std::atomic<bool> attached_{false};
+
+        // stack capture, frame_count_ is -1 until the signal handler has run
+        std::array<void*, 64> frames_{};
+        std::atomic<int> frame_count_{0};
+
+        // watcher state, accessed by the monitor thread only
+        std::uint64_t seen_{0};
+        std::chrono::steady_clock::time_point since_{};
+        bool reported_{false};
+
+        static inline thread_local heartbeat* current_{nullptr};
+    };
+
+    //! Publishes the dispatch of a signal with TAG and its slots to the heartbeat of the calling thread, if any.
+    //! Used by signal::invoke when ASTL_WATCHDOG is defined. Nested dispatches restore the state of the enclosing one.
+    template<typename TAG>
+    class dispatch_scope
+    {
+    public:
+        explicit dispatch_scope() noexcept;
+        ~dispatch_scope() noexcept;
+
+        dispatch_scope(dispatch_scope const&) = delete;
+        dispatch_scope& operator=(dispatch_scope const&) = delete;
+
+        //! Publishes slot as the running one.
+        void enter(void const* slot) noexcept;
+
+    private:
+        heartbeat* heartbeat_;
+        heartbeat::state previous_{};
+    };
+
+    //! Watchdog thread sampling the heartbeats registered with it. A slot handler or an event loop iteration that
+    //! runs longer than the threshold is reported once to the stall handler, on the watchdog thread and rate limited.
+    //! The sampling period is a quarter of the threshold, stalls are detected up to that much late.
+    //! \code
+    //! astl::watchdog::monitor monitor{};
+    //! monitor.on_stall([](astl::watchdog::stall_report const& r){ log_warning(r.thread, r.tag, r.duration); });
+    //! monitor.start();
+    //! \endcode
+    class monitor
+    {
+    public:
+        using handler_type = std::function<void(stall_report const&)>;
+
+        explicit monitor(options o = {}) noexcept;
+        ~monitor() noexcept;
+
+        monitor(monitor const&) = delete;
+        monitor& operator=(monitor const&) = delete;
+
+        //! Installs the handler receiving the reports. Call before start().
+        void on_stall(handler_type handler) noexcept;
+
+        //! Starts the watchdog thread. Returns false if it is already running or the signal handler for stack capture
+        //! cannot be installed.
+        bool start() noexcept;
+
+        //! Stops the watchdog thread.
+        void stop() noexcept;
+
+        //! Number of stalls detected, including suppressed ones.
+        [[nodiscard]] std::uint64_t stalls() const noexcept;
+
+    private:
+        friend class heartbeat;
+
+        void add(heartbeat& hb);
+        void remove(heartbeat& hb) noexcept;
+        void run() noexcept;
+        void sample(std::vector<stall_report>& reports) noexcept;
+        void capture_stack(heartbeat& hb, stall_report& report) noexcept;
+        static void on_stack_signal(int) noexcept;
+
+    private:
+        options const options_;
+        handler_type handler_{};
+        std::mutex mutex_{};
+        std::condition_variable wakeup_{};
+        std::vector<heartbeat*> heartbeats_{};
+        std::thread thread_{};
+        bool stop_{false};
+        std::atomic<std::uint64_t> stalls_{0};
+        std::uint64_t suppressed_{0};
+        std::chrono::steady_clock::time_point last_report_{};
+        struct sigaction previous_action_{};
+    };
+
+} // namespace astl::watchdog
+
+// ------------------------------------------------------------------------------------------------
+// impl heartbeat
+// ------------------------------------------------------------------------------------------------
+inline astl::watchdog::heartbeat::heartbeat(monitor& m, std::string name)
+    : monitor_{m}
+    , name_{std::move(name)}
+{
+    monitor_.add(*this);
+}
+
+inline astl::watchdog::heartbeat::~heartbeat() noexcept
+{
+    detach();
+    monitor_.remove(*this);
+}
+
+inline void astl::watchdog::heartbeat::attach() noexcept
+{
+    thread_ = ::pthread_self();
+    current_ = this;
+    attached_.store(true, std::memory_order_release);
+}
+
+inline void astl::watchdog::heartbeat::detach() noexcept
+{
+    if (current_ == this) {
+        attached_.store(false, std::memory_order_release);
+        word_.store(0, std::memory_order_relaxed);
+        current_ = nullptr;
+    }
+}
+
+inline astl::watchdog::heartbeat* astl::watchdog::heartbeat::current() noexcept
+{
+    return current_;
+}
+
+inline void astl::watchdog::heartbeat::beat() noexcept
+{
+    tag_.store(nullptr, std::memory_order_relaxed);
+    publish(loop_address);
+}
+
+inline void astl::watchdog::heartbeat::idle() noexcept
+{
+    word_.store(0, std::memory_order_relaxed);
+}
+
+inline void astl::watchdog::heartbeat::publish(std::uintptr_t address) noexcept
+{
+    word_.store((++count_ << 48u) | (address & address_mask), std::memory_order_relaxed);
+}
+
+inline astl::watchdog::heartbeat::state astl::watchdog::heartbeat::enter(char const* tag) noexcept
+{
+    state previous{word_.load(std::memory_order_relaxed), tag_.load(std::memory_order_relaxed)};
+    tag_.store(tag, std::memory_order_relaxed);
+    return previous;
+}
+
+inline void astl::watchdog::heartbeat::leave(state const& previous) noexcept
+{
+    // the enclosing slot or loop iteration continues, its word is restored unchanged
+    tag_.store(previous.tag, std::memory_order_relaxed);
+    word_.store(previous.word, std::memory_order_relaxed);
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl dispatch_scope
+// ------------------------------------------------------------------------------------------------
+template<typename TAG>
+    astl::watchdog::dispatch_scope<TAG>::dispatch_scope() noexcept
+        : heartbeat_{heartbeat::current()}
+{
+    if (heartbeat_) {
+        previous_ = heartbeat_->enter(typeid(TAG).name());
+    }
+}
+
+template<typename TAG>
+    astl::watchdog::dispatch_scope<TAG>::~dispatch_scope() noexcept
+{
+    if (heartbeat_) {
+        heartbeat_->leave(previous_);
+    }
+}
+
+template<typename TAG>
+    void
+    astl::watchdog::dispatch_scope<TAG>::enter(void const* slot) noexcept
+{
+    if (heartbeat_) {
+        heartbeat_->publish(reinterpret_cast<std::uintptr_t>(slot));
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl monitor
+// ------------------------------------------------------------------------------------------------
+inline astl::watchdog::monitor::monitor(options o) noexcept
+    : options_{o}
+{
+}
+
+inline astl::watchdog::monitor::~monitor() noexcept
+{
+    stop();
+}
+
+inline void astl::watchdog::monitor::on_stall(handler_type handler) noexcept
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    handler_ = std::move(handler);
+}
+
+inline bool astl::watchdog::monitor::start() noexcept
+{
+    if (thread_.joinable()) {
+        return false;
+    }
+    if (options_.capture_stack) {
+        // the first backtrace() may load libgcc and allocate, it must not happen in the signal handler
+        std::array<void*, 1> frame{};
+        ::backtrace(frame.data(), 1);
+        struct sigaction action{};
+        action.sa_handler = &monitor::on_stack_signal;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (::sigaction(options_.stack_signal, &action, &previous_action_) != 0) {
+            return false;
+        }
+    }
+    stop_ = false;
+    thread_ = std::thread{[this]{ run(); }};
+    return true;
+}
+
+inline void astl::watchdog::monitor::stop() noexcept
+{
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stop_ = true;
+    }
+    wakeup_.notify_all();
+    thread_.join();
+    if (options_.capture_stack) {
+        ::sigaction(options_.stack_signal, &previous_action_, nullptr);
+    }
+}
+
+inline std::uint64_t astl::watchdog::monitor::stalls() const noexcept
+{
+    return stalls_.load(std::memory_order_relaxed);
+}
+
+inline void astl::watchdog::monitor::add(heartbeat& hb)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    heartbeats_.push_back(&hb);
+}
+
+inline void astl::watchdog::monitor::remove(heartbeat& hb) noexcept
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    heartbeats_.erase(std::remove(heartbeats_.begin(), heartbeats_.end(), &hb), heartbeats_.end());
+}
+
+inline void astl::watchdog::monitor::run() noexcept
+{
+    auto const period = std::max(std::chrono::duration_cast<std::chrono::nanoseconds>(options_.threshold) / 4,
+                                 std::chrono::nanoseconds{std::chrono::microseconds{100}});
+    std::vector<stall_report> reports{};
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (!wakeup_.wait_for(lock, period, [this]{ return stop_; })) {
+        sample(reports);
+        if (reports.empty() || !handler_) {
+            reports.clear();
+            continue;
+        }
+        // the handler may create or destroy heartbeats
+        auto handler = handler_;
+        lock.unlock();
+        for (auto const& report : reports) {
+            handler(report);
+        }
+        reports.clear();
+        lock.lock();
+    }
+}
+
+inline void astl::watchdog::monitor::sample(std::vector<stall_report>& reports) noexcept
+{
+    auto const now = std::chrono::steady_clock::now();
+    for (auto hb : heartbeats_) {
+        auto word = hb->word_.load(std::memory_order_relaxed);
+        auto tag = hb->tag_.load(std::memory_order_relaxed);
+        if (word == 0 || word != hb->seen_ || !hb->attached_.load(std::memory_order_acquire)) {
+            hb->seen_ = word;
+            hb->since_ = now;
+            hb->reported_ = false;
+            continue;
+        }
+        if (hb->reported_ || now - hb->since_ < options_.threshold
+            || word != hb->word_.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        hb->reported_ = true;
+        stalls_.fetch_add(1, std::memory_order_relaxed);
+        if (now - last_report_ < options_.report_interval && last_report_ != std::chrono::steady_clock::time_point{}) {
+            ++suppressed_;
+            continue;
+        }
+        last_report_ = now;
+
+        auto const address = word & heartbeat::address_mask;
+        stall_report report{hb->name_, {}, nullptr, now - hb->since_, suppressed_, {}};
+        suppressed_ = 0;
+        if (address != heartbeat::loop_address) {
+            report.slot = reinterpret_cast<void const*>(static_cast<std::uintptr_t>(address));
+            int status{0};
+            auto demangled = tag ? abi::__cxa_demangle(tag, nullptr, nullptr, &status) : nullptr;
+            report.tag = demangled ? demangled : (tag ? tag : "");
+            std::free(demangled);
+        }
+        if (options_.capture_stack) {
+            capture_stack(*hb, report);
+        }
+        reports.push_back(std::move(report));
+    }
+}
+
+inline void astl::watchdog::monitor::capture_stack(heartbeat& hb, stall_report& report) noexcept
+{
+    hb.frame_count_.store(-1, std::memory_order_relaxed);
+    if (::pthread_kill(hb.thread_, options_.stack_signal) != 0) {
+        return;
+    }
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{10};
+    auto count = hb.frame_count_.load(std::memory_order_acquire);
+    while (count < 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::microseconds{100});
+        count = hb.frame_count_.load(std::memory_order_acquire);
+    }
+    if (count <= 0) {
+        return;
+    }
+    auto symbols = ::backtrace_symbols(hb.frames_.data(), count);
+    if (!symbols) {
+        return;
+    }
+    for (auto i = 0; i < count; ++i) {
+        report.stack.append(symbols[i]).push_back('\n');
+    }
+    std::free(symbols);
+}
+
+inline void astl::watchdog::monitor::on_stack_signal(int) noexcept
+{
+    if (auto hb = heartbeat::current(); hb && hb->frame_count_.load(std::memory_order_relaxed) < 0) {
+        hb->frame_count_.store(::backtrace(hb->frames_.data(), static_cast<int>(hb->frames_.size())),
+                               std::memory_order_release);
+    }
+}
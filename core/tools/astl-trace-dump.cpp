@@ -0,0 +1,86 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// Decodes trace files written by astl::trace::buffer and prints one line per record, oldest first.
+//
+//   astl-trace-dump <trace-file>...
+
+#include <astl/trace.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+
+    std::string demangle(char const* name)
+    {
+        int status{0};
+        std::unique_ptr<char, decltype(&std::free)> result{abi::__cxa_demangle(name, nullptr, nullptr, &status),
+                                                          &std::free};
+        return status == 0 && result ? std::string{result.get()} : std::string{name};
+    }
+
+    char const* clock_unit(astl::trace::clock_type clock)
+    {
+        return clock == astl::trace::clock_type::tsc ? "tsc" : "ns";
+    }
+
+    int dump(char const* path)
+    {
+        astl::trace::reader reader{};
+        if (!reader.open(path)) {
+            std::cerr << path << ": not a readable astl trace file" << std::endl;
+            return 1;
+        }
+        auto unit = clock_unit(reader.clock());
+        std::cout << "# " << path << ": " << reader.written() << " records written, capacity " << reader.capacity()
+                  << ", clock " << unit << std::endl;
+        std::uint64_t previous{0};
+        reader.for_each([&](std::uint64_t index, astl::trace::record const& r) {
+            auto name = reader.tag_name(r.tag_id);
+            std::cout << index << '\t' << r.timestamp << '\t';
+            // records are written when a dispatch ends, an outer dispatch follows the nested ones it started before
+            auto delta = previous ? static_cast<std::int64_t>(r.timestamp - previous) : std::int64_t{0};
+            std::cout << std::showpos << delta << std::noshowpos << unit << '\t';
+            std::cout << (r.flags == astl::trace::queued ? "queued" : "dispatched") << '\t';
+            std::cout << "slots=" << r.slot_count << '\t' << "duration=" << r.duration << unit << '\t';
+            if (name) {
+                std::cout << demangle(name);
+            }
+            else {
+                std::cout << "tag#" << std::hex << r.tag_id << std::dec;
+            }
+            std::cout << '\n';
+            previous = r.timestamp;
+        });
+        std::cout.flush();
+        return 0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <trace-file>..." << std::endl;
+        return 2;
+    }
+    int result{0};
+    for (int i = 1; i < argc; ++i) {
+        result |= dump(argv[i]);
+    }
+    return result;
+}
@@ -0,0 +1,223 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/async_io.h>
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace {
+    std::string temp_path(char const* name)
+    {
+        return ::testing::TempDir() + "astl-async_io-" + name + "-" + std::to_string(::getpid());
+    }
+
+    void run_until_done(astl::async_io& io)
+    {
+        for (int i = 0; i < 1000 && io.in_flight() > 0; ++i) {
+            io.wait(std::chrono::milliseconds{100});
+        }
+    }
+
+    void write_read_file(astl::io_backend backend)
+    {
+        constexpr std::size_t count = 1000;
+        constexpr std::size_t block = 64;
+        astl::async_io io{count, backend};
+        ASSERT_TRUE(io.is_valid());
+        auto path = temp_path("file");
+        astl::async_file file{io};
+        ASSERT_TRUE(file.open(path, O_RDWR | O_CREAT | O_TRUNC));
+
+        std::vector<std::int64_t> results(count, -1);
+        astl::async_file::slot_type slot{[&results](astl::io_result const& r){ results[r.id] = r.result; }};
+        file.sig().connect(slot);
+
+        std::vector<std::array<char, block>> out(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i].fill(static_cast<char>('a' + i % 26));
+            ASSERT_TRUE(file.write(i, out[i].data(), block, i * block));
+        }
+        ASSERT_EQ(io.in_flight(), count);
+        ASSERT_EQ(io.submit(), count);
+        run_until_done(io);
+        ASSERT_EQ(io.in_flight(), 0u);
+        for (auto r : results) {
+            ASSERT_EQ(r, static_cast<std::int64_t>(block));
+        }
+
+        std::vector<std::array<char, block>> in(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            ASSERT_TRUE(file.read(i, in[i].data(), block, i * block));
+        }
+        io.submit();
+        run_until_done(io);
+        ASSERT_EQ(in, out);
+        ::unlink(path.c_str());
+    }
+
+    void fixed_files_and_buffers(astl::io_backend backend)
+    {
+        astl::async_io io{16, backend};
+        auto path = temp_path("fixed");
+        astl::async_file file{io};
+        ASSERT_TRUE(file.open(path, O_RDWR | O_CREAT | O_TRUNC));
+        std::array<char, 256> buffer{};
+        iovec iov{buffer.data(), buffer.size()};
+        ASSERT_TRUE(io.register_buffers(&iov, 1));
+        int fd = file.fd();
+        ASSERT_TRUE(io.register_files(&fd, 1));
+
+        std::vector<astl::io_result> results;
+        astl::io_event target{};
+        astl::io_event::slot_type slot{[&results](astl::io_result const& r){ results.push_back(r); }};
+        target.sig().connect(slot);
+
+        std::memcpy(buffer.data(), "hello fixed", 11);
+        ASSERT_TRUE(io.write_fixed(target, 1, 0, 0, 0, 11, 0));
+        ASSERT_FALSE(io.write_fixed(target, 2, 1, 0, 0, 11, 0));      // no such file
+        ASSERT_FALSE(io.write_fixed(target, 3, 0, 0, 250, 11, 0));    // beyond the buffer
+        io.submit();
+        run_until_done(io);
+        ASSERT_TRUE(io.read_fixed(target, 4, 0, 0, 100, 5, 6));
+        io.submit();
+        run_until_done(io);
+
+        ASSERT_EQ(results.size(), 2u);
+        ASSERT_EQ(results[0].id, 1u);
+        ASSERT_EQ(results[0].result, 11);
+        ASSERT_EQ(results[1].id, 4u);
+        ASSERT_EQ(results[1].result, 5);
+        ASSERT_EQ(std::string(buffer.data() + 100, 5), "fixed");
+        ::unlink(path.c_str());
+    }
+
+    void error_result(astl::io_backend backend)
+    {
+        astl::async_io io{4, backend};
+        std::int64_t result{0};
+        astl::io_event target{};
+        astl::io_event::slot_type slot{[&result](astl::io_result const& r){ result = r.result; }};
+        target.sig().connect(slot);
+        char buffer[8];
+        ASSERT_TRUE(io.read(target, 0, -1, buffer, sizeof(buffer), 0));
+        run_until_done(io);
+        ASSERT_EQ(result, -EBADF);
+    }
+
+    void wait_in_slot(astl::io_backend backend)
+    {
+        astl::async_io io{4, backend};
+        astl::io_event target{};
+        char buffer[8];
+        int depth{0}, max_depth{0};
+        std::size_t completions{0}, nested{0};
+        astl::io_event::slot_type slot{[&](astl::io_result const& r){
+            max_depth = std::max(max_depth, ++depth);
+            ++completions;
+            if (r.id < 20) {
+                io.read(target, r.id + 1, -1, buffer, sizeof(buffer), 0);
+                nested += io.wait(std::chrono::seconds{10});    // submits, neither blocks nor dispatches
+            }
+            --depth;
+        }};
+        target.sig().connect(slot);
+        ASSERT_TRUE(io.read(target, 0, -1, buffer, sizeof(buffer), 0));
+        run_until_done(io);
+        ASSERT_EQ(completions, 21u);
+        ASSERT_EQ(max_depth, 1);
+        ASSERT_EQ(nested, 0u);
+    }
+}
+
+TEST(async_io, ThreadpoolBackend)
+{
+    astl::async_io io{4, astl::io_backend::threadpool};
+    ASSERT_TRUE(io.is_valid());
+    ASSERT_EQ(io.backend(), astl::io_backend::threadpool);
+    ASSERT_EQ(io.wait(std::chrono::milliseconds{1}), 0u);
+}
+
+TEST(async_io, WriteReadFile)
+{
+    write_read_file(astl::io_backend::automatic);
+    write_read_file(astl::io_backend::threadpool);
+}
+
+TEST(async_io, FixedFilesAndBuffers)
+{
+    fixed_files_and_buffers(astl::io_backend::automatic);
+    fixed_files_and_buffers(astl::io_backend::threadpool);
+}
+
+TEST(async_io, ErrorResult)
+{
+    error_result(astl::io_backend::automatic);
+    error_result(astl::io_backend::threadpool);
+}
+
+TEST(async_io, RegisterFilesWhileSubmitted)
+{
+    astl::async_io io{16, astl::io_backend::threadpool};
+    auto path = temp_path("reregister");
+    astl::async_file file{io};
+    ASSERT_TRUE(file.open(path, O_RDWR | O_CREAT | O_TRUNC));
+    ASSERT_EQ(::pwrite(file.fd(), "first", 5, 0), 5);
+    std::array<char, 64> buffer{};
+    iovec iov{buffer.data(), buffer.size()};
+    ASSERT_TRUE(io.register_buffers(&iov, 1));
+    int fd = file.fd();
+    ASSERT_TRUE(io.register_files(&fd, 1));
+
+    std::vector<astl::io_result> results;
+    astl::io_event target{};
+    astl::io_event::slot_type slot{[&results](astl::io_result const& r){ results.push_back(r); }};
+    target.sig().connect(slot);
+    for (std::uint64_t i = 0; i < 8; ++i) {
+        ASSERT_TRUE(io.read_fixed(target, i, 0, 0, i * 8, 5, 0));
+    }
+    io.submit();
+    // the submitted requests keep the file they were submitted with
+    std::vector<int> others(1000, -1);
+    ASSERT_TRUE(io.register_files(others.data(), others.size()));
+    run_until_done(io);
+
+    ASSERT_EQ(results.size(), 8u);
+    for (std::uint64_t i = 0; i < 8; ++i) {
+        ASSERT_EQ(results[i].result, 5);
+        ASSERT_EQ(std::string(buffer.data() + i * 8, 5), "first");
+    }
+    ::unlink(path.c_str());
+}
+
+TEST(async_io, WaitInSlot)
+{
+    wait_in_slot(astl::io_backend::automatic);
+    wait_in_slot(astl::io_backend::threadpool);
+}
+
+TEST(async_io, QueueFull)
+{
+    astl::async_io io{2, astl::io_backend::automatic};
+    astl::io_event target{};
+    char buffer[8];
+    std::size_t prepared{0};
+    while (prepared < 100 && io.read(target, prepared, -1, buffer, sizeof(buffer), 0)) {
+        ++prepared;
+    }
+    ASSERT_LT(prepared, 100u);
+    run_until_done(io);
+    ASSERT_TRUE(io.read(target, 0, -1, buffer, sizeof(buffer), 0));
+    run_until_done(io);
+}
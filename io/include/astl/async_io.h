@@ -0,0 +1,770 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/event.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <csignal>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace astl {
+
+    //! Implementation used by astl::async_io.
+    enum class io_backend {
+        automatic,  //!< io_uring when the kernel supports it, threadpool otherwise
+        io_uring,   //!< submission and completion rings shared with the kernel
+        threadpool, //!< blocking pread/pwrite on worker threads
+    };
+
+    //! Completion of an asynchronous I/O request.
+    struct io_result
+    {
+        std::uint64_t id;       //!< id given when the request was prepared
+        std::int64_t result;    //!< number of bytes transferred or -errno
+    };
+
+    struct io_completion_tag {};
+
+    //! Event on which completions are delivered, either one per request or one per file (see astl::async_file).
+    using io_event = event<io_completion_tag, io_result>;
+
+    //! Asynchronous file I/O whose completions are delivered as invocations of astl events.
+    //! Requests are prepared with read() / write() and handed to the kernel in batches by submit() - with io_uring a
+    //! batch costs a single system call. Completions are dispatched on the thread calling poll() or wait(), which is
+    //! the thread owning the async_io object and the target events. The targets must live until their requests have
+    //! completed.
+    //! Files and buffers can be registered once (register_files(), register_buffers()) and used by index with
+    //! read_fixed() / write_fixed(), which saves the kernel the per request file lookup and page pinning.
+    //! When io_uring is not available (old kernel, seccomp) the requests are executed by a small pool of threads.
+    //! \code
+    //! #include <astl/async_io.h>
+    //!
+    //! astl::async_io io{4096};
+    //! astl::async_file file{io};
+    //! file.open("/var/tmp/data", O_RDONLY);
+    //! file.sig().connect(completionSlot);
+    //! for (std::uint64_t i = 0; i < 1000; ++i) {
+    //!     file.read(i, buffers[i].data(), 4096, i * 4096);
+    //! }
+    //! io.submit();
+    //! while (io.in_flight()) {
+    //!     io.wait(std::chrono::milliseconds{100});
+    //! }
+    //! \endcode
+    class async_io
+    {
+    public:
+        //! \param entries      Number of requests that can be prepared before submit(). Up to twice as many requests
+        //!                     can be in flight.
+        //! \param backend      Requested implementation.
+        //! \param threads      Number of worker threads of the threadpool implementation.
+        explicit async_io(std::size_t entries = 1024, io_backend backend = io_backend::automatic,
+                          std::size_t threads = 4) noexcept;
+        ~async_io() noexcept;
+
+        async_io(async_io const&) = delete;
+        async_io& operator=(async_io const&) = delete;
+
+        //! Returns the implementation in use.
+        [[nodiscard]] io_backend backend() const noexcept;
+
+        //! Returns false if no implementation could be set up.
+        [[nodiscard]] bool is_valid() const noexcept;
+
+        //! Registers buffers for read_fixed() / write_fixed(). Replaces previously registered buffers.
+        bool register_buffers(iovec const* buffers, std::size_t count) noexcept;
+
+        //! Registers file descriptors for read_fixed() / write_fixed(). Replaces previously registered files.
+        bool register_files(int const* fds, std::size_t count) noexcept;
+
+        //! Prepares reading size bytes at offset of fd into buffer. The completion invokes target with id.
+        //! \returns false if the request could not be queued; submit() and reap completions, then retry.
+        bool read(io_event& target, std::uint64_t id, int fd, void* buffer, std::size_t size,
+                  std::uint64_t offset) noexcept;
+
+        //! Prepares writing size bytes of buffer at offset of fd.
+        bool write(io_event& target, std::uint64_t id, int fd, void const* buffer, std::size_t size,
+                   std::uint64_t offset) noexcept;
+
+        //! Prepares reading size bytes at offset of the registered file into the registered buffer.
+        bool read_fixed(io_event& target, std::uint64_t id, std::size_t file_index, std::size_t buffer_index,
+                        std::size_t buffer_offset, std::size_t size, std::uint64_t offset) noexcept;
+
+        //! Prepares writing size bytes of the registered buffer at offset of the registered file.
+        bool write_fixed(io_event& target, std::uint64_t id, std::size_t file_index, std::size_t buffer_index,
+                         std::size_t buffer_offset, std::size_t size, std::uint64_t offset) noexcept;
+
+        //! Submits all prepared requests. \returns the number of submitted requests.
+        std::size_t submit() noexcept;
+
+        //! Dispatches up to max completions without blocking. \returns the number of dispatched completions.
+        //! Slots may prepare and submit requests. Called by a slot, poll() and wait() do not dispatch: the running
+        //! poll() dispatches the further completions, so io events are never invoked recursively.
+        std::size_t poll(std::size_t max = std::numeric_limits<std::size_t>::max()) noexcept;
+
+        //! Submits prepared requests, waits up to timeout for a completion and dispatches up to max completions.
+        std::size_t wait(std::chrono::nanoseconds timeout,
+                         std::size_t max = std::numeric_limits<std::size_t>::max()) noexcept;
+
+        //! Number of prepared or submitted requests whose completion has not been dispatched yet.
+        [[nodiscard]] std::size_t in_flight() const noexcept;
+
+    private:
+        enum class opcode : std::uint8_t { read, write };
+
+        struct operation
+        {
+            opcode op;
+            bool fixed;
+            int fd;                     // file descriptor or index of the registered file
+            std::uint16_t buffer_index;
+            void* buffer;
+            std::size_t size;
+            std::uint64_t offset;
+            std::uint32_t slot;
+        };
+
+        struct request
+        {
+            io_event* target;
+            std::uint64_t id;
+        };
+
+        struct completion
+        {
+            std::uint32_t slot;
+            std::int64_t result;
+        };
+
+        bool prepare(io_event& target, std::uint64_t id, operation op) noexcept;
+        void complete(std::uint32_t slot, std::int64_t result) noexcept;
+
+        // io_uring
+        bool uring_setup(std::size_t entries) noexcept;
+        void uring_teardown() noexcept;
+        bool uring_prepare(operation const& op) noexcept;
+        std::size_t uring_submit() noexcept;
+        std::size_t uring_reap(std::size_t max) noexcept;
+        bool uring_wait(std::chrono::nanoseconds timeout) noexcept;
+        int uring_enter(unsigned to_submit, unsigned min_complete, unsigned flags, void* arg,
+                        std::size_t arg_size) noexcept;
+
+        // threadpool
+        bool pool_setup(std::size_t threads) noexcept;
+        void pool_teardown() noexcept;
+        void pool_worker() noexcept;
+        std::int64_t pool_execute(operation const& op) noexcept;
+        std::size_t pool_submit() noexcept;
+        std::size_t pool_reap(std::size_t max) noexcept;
+        bool pool_wait(std::chrono::nanoseconds timeout) noexcept;
+
+    private:
+        io_backend backend_{io_backend::automatic};
+        bool valid_{false};
+        std::vector<request> requests_{};
+        std::vector<std::uint32_t> free_{};
+        std::size_t in_flight_{0};
+        bool dispatching_{false};       // poll() is dispatching completions
+        std::vector<iovec> buffers_{};
+        std::vector<int> files_{};
+
+        struct uring_state
+        {
+            int fd{-1};
+            void* sq_ring{nullptr};
+            std::size_t sq_ring_size{0};
+            void* cq_ring{nullptr};
+            std::size_t cq_ring_size{0};
+            io_uring_sqe* sqes{nullptr};
+            std::size_t sqes_size{0};
+            unsigned* sq_head{nullptr};
+            unsigned* sq_tail{nullptr};
+            unsigned sq_mask{0};
+            unsigned sq_entries{0};
+            unsigned* sq_array{nullptr};
+            unsigned* cq_head{nullptr};
+            unsigned* cq_tail{nullptr};
+            unsigned cq_mask{0};
+            io_uring_cqe* cqes{nullptr};
+            unsigned tail{0};           // local submission queue tail
+            unsigned prepared{0};       // entries written but not yet consumed by the kernel
+        } uring_{};
+
+        struct pool_state
+        {
+            std::vector<std::thread> workers{};
+            std::vector<operation> prepared{};
+            std::mutex mutex{};
+            std::condition_variable work{};
+            std::condition_variable done{};
+            std::deque<operation> queue{};
+            std::vector<completion> completions{};
+            std::vector<completion> ready{};
+            std::size_t ready_pos{0};
+            bool stop{false};
+        } pool_{};
+    };
+
+    //! File whose completions are delivered on its own signal.
+    class async_file
+    {
+    public:
+        using signal_type = io_event::signal_type;
+        using slot_type = io_event::slot_type;
+
+        explicit async_file(async_io& io) noexcept;
+        ~async_file() noexcept;
+
+        async_file(async_file const&) = delete;
+        async_file& operator=(async_file const&) = delete;
+
+        //! Opens path synchronously with the flags and mode of ::open().
+        bool open(std::string const& path, int flags, mode_t mode = 0644) noexcept;
+
+        //! Closes the file. Requests must not be in flight.
+        void close() noexcept;
+
+        [[nodiscard]] int fd() const noexcept;
+
+        //! Returns the signal on which all completions of this file are delivered.
+        signal_type& sig() noexcept;
+
+        //! See async_io::read().
+        bool read(std::uint64_t id, void* buffer, std::size_t size, std::uint64_t offset) noexcept;
+
+        //! See async_io::write().
+        bool write(std::uint64_t id, void const* buffer, std::size_t size, std::uint64_t offset) noexcept;
+
+    private:
+        async_io& io_;
+        int fd_{-1};
+        io_event event_{};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl async_io
+// ------------------------------------------------------------------------------------------------
+inline astl::async_io::async_io(std::size_t entries, io_backend backend, std::size_t threads) noexcept
+{
+    if (entries == 0) {
+        entries = 1;
+    }
+    if (backend != io_backend::threadpool && uring_setup(entries)) {
+        backend_ = io_backend::io_uring;
+        valid_ = true;
+    }
+    else if (backend != io_backend::io_uring && pool_setup(threads ? threads : 1)) {
+        backend_ = io_backend::threadpool;
+        valid_ = true;
+    }
+    // with io_uring the kernel sizes the completion queue twice the submission queue
+    auto capacity = backend_ == io_backend::io_uring ? 2 * uring_.sq_entries : 2 * entries;
+    requests_.resize(capacity);
+    free_.reserve(capacity);
+    for (auto i = capacity; i > 0; --i) {
+        free_.push_back(static_cast<std::uint32_t>(i - 1));
+    }
+}
+
+inline astl::async_io::~async_io() noexcept
+{
+    if (backend_ == io_backend::io_uring) {
+        uring_teardown();
+    }
+    else if (backend_ == io_backend::threadpool) {
+        pool_teardown();
+    }
+}
+
+inline astl::io_backend astl::async_io::backend() const noexcept
+{
+    return backend_;
+}
+
+inline bool astl::async_io::is_valid() const noexcept
+{
+    return valid_;
+}
+
+inline bool astl::async_io::register_buffers(iovec const* buffers, std::size_t count) noexcept
+{
+    if (backend_ == io_backend::io_uring) {
+        if (!buffers_.empty()) {
+            ::syscall(__NR_io_uring_register, uring_.fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        }
+        if (::syscall(__NR_io_uring_register, uring_.fd, IORING_REGISTER_BUFFERS, buffers, count) < 0) {
+            buffers_.clear();
+            return false;
+        }
+    }
+    buffers_.assign(buffers, buffers + count);
+    return true;
+}
+
+inline bool astl::async_io::register_files(int const* fds, std::size_t count) noexcept
+{
+    if (backend_ == io_backend::io_uring) {
+        if (!files_.empty()) {
+            ::syscall(__NR_io_uring_register, uring_.fd, IORING_UNREGISTER_FILES, nullptr, 0);
+        }
+        if (::syscall(__NR_io_uring_register, uring_.fd, IORING_REGISTER_FILES, fds, count) < 0) {
+            files_.clear();
+            return false;
+        }
+    }
+    files_.assign(fds, fds + count);
+    return true;
+}
+
+inline bool astl::async_io::read(io_event& target, std::uint64_t id, int fd, void* buffer, std::size_t size,
+                                 std::uint64_t offset) noexcept
+{
+    return prepare(target, id, operation{opcode::read, false, fd, 0, buffer, size, offset, 0});
+}
+
+inline bool astl::async_io::write(io_event& target, std::uint64_t id, int fd, void const* buffer, std::size_t size,
+                                  std::uint64_t offset) noexcept
+{
+    return prepare(target, id, operation{opcode::write, false, fd, 0, const_cast<void*>(buffer), size, offset, 0});
+}
+
+inline bool astl::async_io::read_fixed(io_event& target, std::uint64_t id, std::size_t file_index,
+                                       std::size_t buffer_index, std::size_t buffer_offset, std::size_t size,
+                                       std::uint64_t offset) noexcept
+{
+    if (file_index >= files_.size() || buffer_index >= buffers_.size()
+            || buffer_offset + size > buffers_[buffer_index].iov_len) {
+        return false;
+    }
+    auto buffer = static_cast<char*>(buffers_[buffer_index].iov_base) + buffer_offset;
+    return prepare(target, id, operation{opcode::read, true, static_cast<int>(file_index),
+                                         static_cast<std::uint16_t>(buffer_index), buffer, size, offset, 0});
+}
+
+inline bool astl::async_io::write_fixed(io_event& target, std::uint64_t id, std::size_t file_index,
+                                        std::size_t buffer_index, std::size_t buffer_offset, std::size_t size,
+                                        std::uint64_t offset) noexcept
+{
+    if (file_index >= files_.size() || buffer_index >= buffers_.size()
+            || buffer_offset + size > buffers_[buffer_index].iov_len) {
+        return false;
+    }
+    auto buffer = static_cast<char*>(buffers_[buffer_index].iov_base) + buffer_offset;
+    return prepare(target, id, operation{opcode::write, true, static_cast<int>(file_index),
+                                         static_cast<std::uint16_t>(buffer_index), buffer, size, offset, 0});
+}
+
+inline std::size_t astl::async_io::submit() noexcept
+{
+    if (backend_ == io_backend::io_uring) {
+        return uring_submit();
+    }
+    return valid_ ? pool_submit() : 0;
+}
+
+inline std::size_t astl::async_io::poll(std::size_t max) noexcept
+{
+    if (dispatching_) {
+        return 0;
+    }
+    dispatching_ = true;
+    std::size_t count{0};
+    if (backend_ == io_backend::io_uring) {
+        count = uring_reap(max);
+    }
+    else if (valid_) {
+        count = pool_reap(max);
+    }
+    dispatching_ = false;
+    return count;
+}
+
+inline std::size_t astl::async_io::wait(std::chrono::nanoseconds timeout, std::size_t max) noexcept
+{
+    submit();
+    auto count = poll(max);
+    if (count > 0 || in_flight_ == 0 || dispatching_) {
+        // a slot must not block the dispatch it is called by
+        return count;
+    }
+    auto ready = backend_ == io_backend::io_uring ? uring_wait(timeout) : valid_ && pool_wait(timeout);
+    return ready ? poll(max) : 0;
+}
+
+inline std::size_t astl::async_io::in_flight() const noexcept
+{
+    return in_flight_;
+}
+
+inline bool astl::async_io::prepare(io_event& target, std::uint64_t id, operation op) noexcept
+{
+    if (!valid_ || free_.empty()) {
+        return false;
+    }
+    op.slot = free_.back();
+    auto queued = backend_ == io_backend::io_uring ? uring_prepare(op) : (pool_.prepared.push_back(op), true);
+    if (!queued) {
+        return false;
+    }
+    free_.pop_back();
+    requests_[op.slot] = request{&target, id};
+    ++in_flight_;
+    return true;
+}
+
+inline void astl::async_io::complete(std::uint32_t slot, std::int64_t result) noexcept
+{
+    auto r = requests_[slot];
+    free_.push_back(slot);
+    --in_flight_;
+    r.target->invoke(io_result{r.id, result});
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl async_io - io_uring
+// ------------------------------------------------------------------------------------------------
+inline bool astl::async_io::uring_setup(std::size_t entries) noexcept
+{
+    io_uring_params params{};
+    auto fd = static_cast<int>(::syscall(__NR_io_uring_setup, static_cast<unsigned>(entries), &params));
+    if (fd < 0) {
+        return false;
+    }
+    auto& u = uring_;
+    u.fd = fd;
+    // timeouts of io_uring_enter (5.11) are required by wait()
+    if (!(params.features & IORING_FEAT_EXT_ARG)) {
+        uring_teardown();
+        return false;
+    }
+    u.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    u.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    auto single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+        u.sq_ring_size = u.cq_ring_size = std::max(u.sq_ring_size, u.cq_ring_size);
+    }
+    u.sq_ring = ::mmap(nullptr, u.sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                       IORING_OFF_SQ_RING);
+    if (u.sq_ring == MAP_FAILED) {
+        u.sq_ring = nullptr;
+        uring_teardown();
+        return false;
+    }
+    if (single) {
+        u.cq_ring = u.sq_ring;
+    }
+    else {
+        u.cq_ring = ::mmap(nullptr, u.cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                           IORING_OFF_CQ_RING);
+        if (u.cq_ring == MAP_FAILED) {
+            u.cq_ring = nullptr;
+            uring_teardown();
+            return false;
+        }
+    }
+    u.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    auto sqes = ::mmap(nullptr, u.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        uring_teardown();
+        return false;
+    }
+    u.sqes = static_cast<io_uring_sqe*>(sqes);
+
+    auto sq = static_cast<char*>(u.sq_ring);
+    auto cq = static_cast<char*>(u.cq_ring);
+    u.sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    u.sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    u.sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    u.sq_entries = params.sq_entries;
+    u.sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    u.cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    u.cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    u.cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    u.cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    u.tail = *u.sq_tail;
+    return true;
+}
+
+inline void astl::async_io::uring_teardown() noexcept
+{
+    auto& u = uring_;
+    if (u.sqes) {
+        ::munmap(u.sqes, u.sqes_size);
+    }
+    if (u.cq_ring && u.cq_ring != u.sq_ring) {
+        ::munmap(u.cq_ring, u.cq_ring_size);
+    }
+    if (u.sq_ring) {
+        ::munmap(u.sq_ring, u.sq_ring_size);
+    }
+    if (u.fd >= 0) {
+        ::close(u.fd);
+    }
+    u = uring_state{};
+}
+
+inline bool astl::async_io::uring_prepare(operation const& op) noexcept
+{
+    auto& u = uring_;
+    if (u.tail - __atomic_load_n(u.sq_head, __ATOMIC_ACQUIRE) >= u.sq_entries) {
+        return false;
+    }
+    auto index = u.tail & u.sq_mask;
+    auto& sqe = u.sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    if (op.fixed) {
+        sqe.opcode = op.op == opcode::read ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+        sqe.flags = IOSQE_FIXED_FILE;
+        sqe.buf_index = op.buffer_index;
+    }
+    else {
+        sqe.opcode = op.op == opcode::read ? IORING_OP_READ : IORING_OP_WRITE;
+    }
+    sqe.fd = op.fd;
+    sqe.off = op.offset;
+    sqe.addr = reinterpret_cast<std::uint64_t>(op.buffer);
+    sqe.len = static_cast<std::uint32_t>(op.size);
+    sqe.user_data = op.slot;
+    u.sq_array[index] = index;
+    ++u.tail;
+    ++u.prepared;
+    return true;
+}
+
+inline std::size_t astl::async_io::uring_submit() noexcept
+{
+    auto& u = uring_;
+    if (u.prepared == 0) {
+        return 0;
+    }
+    __atomic_store_n(u.sq_tail, u.tail, __ATOMIC_RELEASE);
+    auto submitted = uring_enter(u.prepared, 0, 0, nullptr, 0);
+    if (submitted <= 0) {
+        return 0;
+    }
+    u.prepared -= static_cast<unsigned>(submitted);
+    return static_cast<std::size_t>(submitted);
+}
+
+inline std::size_t astl::async_io::uring_reap(std::size_t max) noexcept
+{
+    auto& u = uring_;
+    std::size_t count{0};
+    auto head = *u.cq_head;
+    while (count < max) {
+        if (head == __atomic_load_n(u.cq_tail, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        auto const& cqe = u.cqes[head & u.cq_mask];
+        auto slot = static_cast<std::uint32_t>(cqe.user_data);
+        auto result = static_cast<std::int64_t>(cqe.res);
+        // release the entry before dispatching, the kernel may reuse it for requests submitted by slots
+        __atomic_store_n(u.cq_head, ++head, __ATOMIC_RELEASE);
+        complete(slot, result);
+        ++count;
+    }
+    return count;
+}
+
+inline bool astl::async_io::uring_wait(std::chrono::nanoseconds timeout) noexcept
+{
+    __kernel_timespec ts{};
+    ts.tv_sec = timeout.count() / 1'000'000'000;
+    ts.tv_nsec = timeout.count() % 1'000'000'000;
+    io_uring_getevents_arg arg{};
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = reinterpret_cast<std::uint64_t>(&ts);
+    return uring_enter(uring_.prepared, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg)) >= 0;
+}
+
+inline int astl::async_io::uring_enter(unsigned to_submit, unsigned min_complete, unsigned flags, void* arg,
+                                       std::size_t arg_size) noexcept
+{
+    int result;
+    do {
+        result = static_cast<int>(::syscall(__NR_io_uring_enter, uring_.fd, to_submit, min_complete, flags, arg,
+                                            arg_size));
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl async_io - threadpool
+// ------------------------------------------------------------------------------------------------
+inline bool astl::async_io::pool_setup(std::size_t threads) noexcept
+{
+    try {
+        for (std::size_t i = 0; i < threads; ++i) {
+            pool_.workers.emplace_back([this](){ pool_worker(); });
+        }
+    }
+    catch (std::system_error const&) {
+        // no threads left, stop the workers already started
+        pool_teardown();
+        pool_.stop = false;
+        return false;
+    }
+    return true;
+}
+
+inline void astl::async_io::pool_teardown() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{pool_.mutex};
+        pool_.stop = true;
+    }
+    pool_.work.notify_all();
+    for (auto& worker : pool_.workers) {
+        worker.join();
+    }
+    pool_.workers.clear();
+}
+
+inline void astl::async_io::pool_worker() noexcept
+{
+    std::unique_lock<std::mutex> lock{pool_.mutex};
+    while (true) {
+        pool_.work.wait(lock, [this](){ return pool_.stop || !pool_.queue.empty(); });
+        if (pool_.stop) {
+            return;
+        }
+        auto op = pool_.queue.front();
+        pool_.queue.pop_front();
+        lock.unlock();
+        auto result = pool_execute(op);
+        lock.lock();
+        pool_.completions.push_back(completion{op.slot, result});
+        pool_.done.notify_one();
+    }
+}
+
+inline std::int64_t astl::async_io::pool_execute(operation const& op) noexcept
+{
+    auto offset = static_cast<off_t>(op.offset);
+    auto result = op.op == opcode::read ? ::pread(op.fd, op.buffer, op.size, offset)
+                                        : ::pwrite(op.fd, op.buffer, op.size, offset);
+    return result < 0 ? -static_cast<std::int64_t>(errno) : static_cast<std::int64_t>(result);
+}
+
+inline std::size_t astl::async_io::pool_submit() noexcept
+{
+    auto count = pool_.prepared.size();
+    if (count == 0) {
+        return 0;
+    }
+    for (auto& op : pool_.prepared) {
+        if (op.fixed) {
+            // resolved here, the workers must not read files_ while register_files() may replace it
+            op.fd = files_[static_cast<std::size_t>(op.fd)];
+            op.fixed = false;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock{pool_.mutex};
+        pool_.queue.insert(pool_.queue.end(), pool_.prepared.begin(), pool_.prepared.end());
+    }
+    pool_.prepared.clear();
+    pool_.work.notify_all();
+    return count;
+}
+
+inline std::size_t astl::async_io::pool_reap(std::size_t max) noexcept
+{
+    if (pool_.ready_pos == pool_.ready.size()) {
+        pool_.ready.clear();
+        pool_.ready_pos = 0;
+        std::lock_guard<std::mutex> lock{pool_.mutex};
+        pool_.ready.swap(pool_.completions);
+    }
+    std::size_t count{0};
+    while (count < max && pool_.ready_pos < pool_.ready.size()) {
+        auto c = pool_.ready[pool_.ready_pos++];
+        complete(c.slot, c.result);
+        ++count;
+    }
+    return count;
+}
+
+inline bool astl::async_io::pool_wait(std::chrono::nanoseconds timeout) noexcept
+{
+    std::unique_lock<std::mutex> lock{pool_.mutex};
+    return pool_.done.wait_for(lock, timeout, [this](){ return !pool_.completions.empty(); });
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl async_file
+// ------------------------------------------------------------------------------------------------
+inline astl::async_file::async_file(async_io& io) noexcept
+    : io_{io}
+{}
+
+inline astl::async_file::~async_file() noexcept
+{
+    close();
+}
+
+inline bool astl::async_file::open(std::string const& path, int flags, mode_t mode) noexcept
+{
+    close();
+    fd_ = ::open(path.c_str(), flags | O_CLOEXEC, mode);
+    return fd_ >= 0;
+}
+
+inline void astl::async_file::close() noexcept
+{
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+inline int astl::async_file::fd() const noexcept
+{
+    return fd_;
+}
+
+inline astl::async_file::signal_type& astl::async_file::sig() noexcept
+{
+    return event_.sig();
+}
+
+inline bool astl::async_file::read(std::uint64_t id, void* buffer, std::size_t size, std::uint64_t offset) noexcept
+{
+    return io_.read(event_, id, fd_, buffer, size, offset);
+}
+
+inline bool astl::async_file::write(std::uint64_t id, void const* buffer, std::size_t size,
+                                    std::uint64_t offset) noexcept
+{
+    return io_.write(event_, id, fd_, buffer, size, offset);
+}
@@ -0,0 +1,25 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+// Must not compile: a string_view is serialized with its characters, it does not fit a fixed size shm_event slot.
+// Built by the ipc-shm_event-rejects-string_view test, which expects the static_assert of shm_event.
+#include <astl/shm_event.h>
+
+#include <string_view>
+
+struct NameTag {};
+
+int main()
+{
+    astl::shm_event<NameTag, std::string_view> names{};
+    names.invoke(std::string_view{"name"});
+    return 0;
+}
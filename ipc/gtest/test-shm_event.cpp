@@ -0,0 +1,226 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/shm_event.h>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct SampleTag {};
+    struct OtherTag {};
+    struct sample
+    {
+        int id;
+        double value;
+    };
+    using SampleEvent = astl::shm_event<SampleTag, sample, int>;
+    using SampleConsumer = astl::shm_event_consumer<SampleTag, sample, int>;
+}
+
+TEST(shm_event, RoundTrip)
+{
+    SampleEvent producer{};
+    ASSERT_TRUE(producer.create_memfd(16));
+    SampleConsumer consumer{};
+    ASSERT_TRUE(consumer.open_fd(producer.fd()));
+
+    std::vector<std::pair<int, int>> received;
+    SampleConsumer::slot_type slot{[&received](sample const& s, int const& n){ received.emplace_back(s.id, n); }};
+    consumer.sig().connect(slot);
+
+    ASSERT_EQ(consumer.poll(), 0u);
+    producer.invoke(sample{1, 1.5}, 10);
+    producer.invoke(sample{2, 2.5}, 20);
+    producer.invoke(sample{3, 3.5}, 30);
+    ASSERT_EQ(consumer.poll(2), 2u);
+    ASSERT_EQ(consumer.poll(), 1u);
+    ASSERT_EQ(received, (std::vector<std::pair<int, int>>{{1, 10}, {2, 20}, {3, 30}}));
+    ASSERT_EQ(consumer.overruns(), 0u);
+}
+
+TEST(shm_event, ConsumerStartsAtEnd)
+{
+    SampleEvent producer{};
+    ASSERT_TRUE(producer.create_memfd(16));
+    producer.invoke(sample{1, 0.}, 1);
+    SampleConsumer consumer{};
+    ASSERT_TRUE(consumer.open_fd(producer.fd()));
+    ASSERT_EQ(consumer.poll(), 0u);
+}
+
+TEST(shm_event, TagMismatch)
+{
+    SampleEvent producer{};
+    ASSERT_TRUE(producer.create_memfd(16));
+    astl::shm_event_consumer<OtherTag, sample, int> other{};
+    ASSERT_FALSE(other.open_fd(producer.fd()));
+    astl::shm_event_consumer<SampleTag, int> wrongSize{};
+    ASSERT_FALSE(wrongSize.open_fd(producer.fd()));
+}
+
+TEST(shm_event, Overrun)
+{
+    SampleEvent producer{};
+    ASSERT_TRUE(producer.create_memfd(4));
+    SampleConsumer consumer{};
+    ASSERT_TRUE(consumer.open_fd(producer.fd()));
+    std::vector<int> received;
+    SampleConsumer::slot_type slot{[&received](sample const& s, int const&){ received.push_back(s.id); }};
+    consumer.sig().connect(slot);
+
+    for (int i = 0; i < 10; ++i) {
+        producer.invoke(sample{i, 0.}, i);
+    }
+    ASSERT_EQ(consumer.poll(), 4u);
+    ASSERT_EQ(received, (std::vector<int>{6, 7, 8, 9}));
+    ASSERT_EQ(consumer.overruns(), 6u);
+}
+
+TEST(shm_event, LappingProducers)
+{
+    struct LapTag {};
+    struct entry
+    {
+        std::uint32_t producer;
+        std::uint32_t count[15];
+    };
+    astl::shm_event<LapTag, entry> producer{};
+    ASSERT_TRUE(producer.create_memfd(2));
+    astl::shm_event_consumer<LapTag, entry> consumer{};
+    ASSERT_TRUE(consumer.open_fd(producer.fd()));
+
+    // producers a lap apart share a slot; an entry must neither be torn nor published twice
+    constexpr std::uint32_t producers = 4;
+    std::vector<std::uint32_t> last(producers, 0);
+    bool consistent{true};
+    astl::shm_event_consumer<LapTag, entry>::slot_type slot{[&](entry const& e){
+        for (auto c : e.count) {
+            consistent = consistent && c == e.count[0];
+        }
+        consistent = consistent && e.count[0] > last[e.producer];
+        last[e.producer] = e.count[0];
+    }};
+    consumer.sig().connect(slot);
+
+    std::atomic<std::uint32_t> running{producers};
+    std::vector<std::thread> threads;
+    for (std::uint32_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&producer, &running, p]{
+            for (std::uint32_t i = 1; i <= 5000; ++i) {
+                entry e{p, {}};
+                std::fill(std::begin(e.count), std::end(e.count), i);
+                producer.invoke(e);
+            }
+            --running;
+        });
+    }
+    while (running > 0) {
+        consumer.poll();
+        std::this_thread::yield();
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    consumer.poll();
+    ASSERT_TRUE(consistent);
+}
+
+TEST(shm_event, WaitTimeout)
+{
+    SampleEvent producer{};
+    ASSERT_TRUE(producer.create_memfd(4));
+    SampleConsumer consumer{};
+    ASSERT_TRUE(consumer.open_fd(producer.fd()));
+    ASSERT_EQ(consumer.wait(std::chrono::milliseconds{1}), 0u);
+}
+
+TEST(shm_event, WaitWakeup)
+{
+    SampleEvent producer{};
+    ASSERT_TRUE(producer.create_memfd(64));
+    SampleConsumer consumer{};
+    ASSERT_TRUE(consumer.open_fd(producer.fd()));
+    int sum{0};
+    SampleConsumer::slot_type slot{[&sum](sample const&, int const& n){ sum += n; }};
+    consumer.sig().connect(slot);
+
+    std::thread thread{[&producer](){
+        for (int i = 1; i <= 10; ++i) {
+            std::this_thread::sleep_for(std::chrono::microseconds{100});
+            producer.invoke(sample{i, 0.}, i);
+        }
+    }};
+    std::size_t count{0};
+    while (count < 10) {
+        count += consumer.wait(std::chrono::seconds{5});
+    }
+    thread.join();
+    ASSERT_EQ(sum, 55);
+}
+
+TEST(shm_event, CrossProcess)
+{
+    SampleEvent producer{};
+    ASSERT_TRUE(producer.create_memfd(64));
+    SampleConsumer consumer{};
+    ASSERT_TRUE(consumer.open_fd(producer.fd()));
+
+    auto pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        int sum{0};
+        SampleConsumer::slot_type slot{[&sum](sample const& s, int const& n){ sum += s.id * n; }};
+        consumer.sig().connect(slot);
+        std::size_t count{0};
+        for (int i = 0; i < 100 && count < 10; ++i) {
+            count += consumer.wait(std::chrono::milliseconds{50});
+        }
+        ::_exit(count == 10 && sum == 55 ? 0 : 1);
+    }
+    for (int i = 1; i <= 10; ++i) {
+        producer.invoke(sample{i, 0.}, 1);
+    }
+    int status{0};
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(shm_event, NamedSegment)
+{
+    auto name = "/astl-shm_event-" + std::to_string(::getpid());
+    SampleEvent producer{};
+    ASSERT_TRUE(producer.create(name, 8));
+    SampleEvent secondProducer{};
+    ASSERT_TRUE(secondProducer.open(name));
+    SampleConsumer consumer{};
+    ASSERT_TRUE(consumer.open(name));
+    ::shm_unlink(name.c_str());
+
+    std::vector<int> received;
+    SampleConsumer::slot_type slot{[&received](sample const& s, int const&){ received.push_back(s.id); }};
+    consumer.sig().connect(slot);
+    producer.invoke(sample{1, 0.}, 0);
+    secondProducer.invoke(sample{2, 0.}, 0);
+    ASSERT_EQ(consumer.poll(), 2u);
+    ASSERT_EQ(received, (std::vector<int>{1, 2}));
+}
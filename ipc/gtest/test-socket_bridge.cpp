@@ -0,0 +1,357 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <astl/socket_bridge.h>
+#include <astl/testsupport/alloc_counter.h>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct SampleTag {};
+    struct ScaledTag {};
+    struct sample
+    {
+        int id;
+        double value;
+    };
+    using SampleSender = astl::socket_bridge_sender<SampleTag, sample, std::string>;
+    using SampleReceiver = astl::socket_bridge_receiver<SampleTag, sample, std::string>;
+
+    struct socket_pair
+    {
+        explicit socket_pair(int type)
+        {
+            ::socketpair(AF_UNIX, type, 0, fds);
+        }
+
+        ~socket_pair()
+        {
+            ::close(fds[0]);
+            ::close(fds[1]);
+        }
+
+        int fds[2]{-1, -1};
+    };
+
+    astl::bridge_options no_delay(std::size_t batch_bytes = 1024)
+    {
+        astl::bridge_options options{};
+        options.batch_bytes = batch_bytes;
+        options.flush_delay = std::chrono::hours{1};
+        return options;
+    }
+}
+
+// transmits the value scaled to an int16, decodes only values of the expected size
+template<>
+struct astl::bridge_codec<ScaledTag, double>
+{
+    static std::size_t size(double const&) noexcept
+    {
+        return sizeof(std::int16_t);
+    }
+
+    static std::byte* encode(std::byte* out, double const& v) noexcept
+    {
+        auto scaled = static_cast<std::int16_t>(v * 100);
+        std::memcpy(out, &scaled, sizeof(scaled));
+        return out + sizeof(scaled);
+    }
+
+    static bool decode(std::byte const* in, std::byte const* end, std::tuple<double>& values) noexcept
+    {
+        std::int16_t scaled{0};
+        if (end - in != sizeof(scaled)) {
+            return false;
+        }
+        std::memcpy(&scaled, in, sizeof(scaled));
+        std::get<0>(values) = scaled / 100.;
+        return true;
+    }
+};
+
+TEST(socket_bridge, RoundTripStream)
+{
+    socket_pair sockets{SOCK_STREAM};
+    SampleSender sender{};
+    ASSERT_TRUE(sender.open(sockets.fds[0], no_delay()));
+    SampleReceiver receiver{};
+    ASSERT_TRUE(receiver.open(sockets.fds[1]));
+
+    std::vector<std::pair<int, std::string>> received;
+    SampleReceiver::slot_type slot{[&received](sample const& s, std::string const& name){
+        received.emplace_back(s.id, name);
+    }};
+    receiver.sig().connect(slot);
+
+    ASSERT_TRUE(sender.invoke(sample{1, 1.5}, "one"));
+    ASSERT_TRUE(sender.invoke(sample{2, 2.5}, "two"));
+    ASSERT_TRUE(sender.invoke(sample{3, 3.5}, "three"));
+    ASSERT_GT(sender.pending(), 0u);
+    ASSERT_EQ(receiver.poll(), 0u);
+    ASSERT_TRUE(sender.flush());
+    ASSERT_EQ(sender.pending(), 0u);
+    ASSERT_EQ(receiver.poll(2), 2u);
+    ASSERT_EQ(receiver.poll(), 1u);
+    ASSERT_EQ(received, (std::vector<std::pair<int, std::string>>{{1, "one"}, {2, "two"}, {3, "three"}}));
+    ASSERT_FALSE(receiver.closed());
+}
+
+TEST(socket_bridge, FlushesFullBatch)
+{
+    socket_pair sockets{SOCK_STREAM};
+    astl::socket_bridge_sender<SampleTag, int> sender{};
+    ASSERT_TRUE(sender.open(sockets.fds[0], no_delay(64)));
+    astl::socket_bridge_receiver<SampleTag, int> receiver{};
+    ASSERT_TRUE(receiver.open(sockets.fds[1]));
+
+    // 8 bytes per frame, the eighth completes the batch
+    for (auto i = 0; i < 7; ++i) {
+        ASSERT_TRUE(sender.invoke(i));
+    }
+    ASSERT_EQ(receiver.poll(), 0u);
+    ASSERT_TRUE(sender.invoke(7));
+    ASSERT_EQ(sender.pending(), 0u);
+    ASSERT_EQ(receiver.poll(), 8u);
+}
+
+TEST(socket_bridge, FlushesAfterDelay)
+{
+    socket_pair sockets{SOCK_STREAM};
+    astl::bridge_options options{};
+    options.flush_delay = std::chrono::milliseconds{5};
+    astl::socket_bridge_sender<SampleTag, int> sender{};
+    ASSERT_TRUE(sender.open(sockets.fds[0], options));
+    astl::socket_bridge_receiver<SampleTag, int> receiver{};
+    ASSERT_TRUE(receiver.open(sockets.fds[1]));
+
+    ASSERT_EQ(sender.deadline(), std::chrono::steady_clock::time_point::max());
+    ASSERT_TRUE(sender.invoke(1));
+    ASSERT_LE(sender.deadline(), std::chrono::steady_clock::now() + options.flush_delay);
+    ASSERT_TRUE(sender.flush_if_due());
+    ASSERT_EQ(receiver.poll(), 0u);
+
+    std::this_thread::sleep_until(sender.deadline());
+    ASSERT_TRUE(sender.flush_if_due());
+    ASSERT_EQ(receiver.wait(std::chrono::seconds{1}), 1u);
+
+    // invoking after the delay sends the events queued so far
+    ASSERT_TRUE(sender.invoke(2));
+    std::this_thread::sleep_until(sender.deadline());
+    ASSERT_TRUE(sender.invoke(3));
+    ASSERT_EQ(receiver.wait(std::chrono::seconds{1}), 2u);
+}
+
+TEST(socket_bridge, Datagrams)
+{
+    socket_pair sockets{SOCK_SEQPACKET};
+    astl::socket_bridge_sender<SampleTag, int> sender{};
+    ASSERT_TRUE(sender.open(sockets.fds[0], no_delay(64)));
+    astl::bridge_options options{no_delay(64)};
+    options.receive_batches = 4;
+    astl::socket_bridge_receiver<SampleTag, int> receiver{};
+    ASSERT_TRUE(receiver.open(sockets.fds[1], options));
+
+    std::vector<int> received;
+    astl::slot<SampleTag, int> slot{[&received](int v){ received.push_back(v); }};
+    receiver.sig().connect(slot);
+
+    // a batch carries 8 frames, the datagrams exceed the receive batches
+    sender.invoke(-1);
+    ASSERT_TRUE(sender.flush());
+    std::vector<int> expected{-1};
+    for (auto i = 0; i < 100; ++i) {
+        ASSERT_TRUE(sender.invoke(i));
+        expected.push_back(i);
+    }
+    ASSERT_TRUE(sender.flush());
+    ASSERT_EQ(receiver.poll(3), 3u);
+    ASSERT_EQ(receiver.poll(), 98u);
+    ASSERT_EQ(received, expected);
+
+    // events larger than a datagram are dropped
+    astl::socket_bridge_sender<SampleTag, std::string> strings{};
+    ASSERT_TRUE(strings.open(sockets.fds[0], no_delay(64)));
+    ASSERT_FALSE(strings.invoke(std::string(100, 'x')));
+    ASSERT_EQ(strings.dropped(), 1u);
+}
+
+TEST(socket_bridge, ConnectForwardsEvent)
+{
+    socket_pair sockets{SOCK_STREAM};
+    astl::bridge_options options{};
+    options.flush_delay = std::chrono::microseconds{0};
+    SampleSender sender{};
+    ASSERT_TRUE(sender.open(sockets.fds[0], options));
+    SampleReceiver receiver{};
+    ASSERT_TRUE(receiver.open(sockets.fds[1]));
+
+    astl::event<SampleTag, sample, std::string> local{};
+    sender.connect(local.sig());
+    std::vector<double> received;
+    SampleReceiver::slot_type slot{[&received](sample const& s, std::string const&){ received.push_back(s.value); }};
+    receiver.sig().connect(slot);
+
+    local.invoke(sample{1, 0.5}, "a");
+    local.invoke(sample{2, 1.5}, "b");
+    ASSERT_EQ(receiver.poll(), 2u);
+    ASSERT_EQ(received, (std::vector<double>{0.5, 1.5}));
+}
+
+TEST(socket_bridge, CustomCodec)
+{
+    socket_pair sockets{SOCK_DGRAM};
+    astl::socket_bridge_sender<ScaledTag, double> sender{};
+    ASSERT_TRUE(sender.open(sockets.fds[0], no_delay()));
+    astl::socket_bridge_receiver<ScaledTag, double> receiver{};
+    ASSERT_TRUE(receiver.open(sockets.fds[1], no_delay()));
+
+    std::vector<double> received;
+    astl::slot<ScaledTag, double> slot{[&received](double v){ received.push_back(v); }};
+    receiver.sig().connect(slot);
+
+    sender.invoke(1.25);
+    sender.invoke(-3.5);
+    ASSERT_EQ(sender.pending(), 2 * (sizeof(std::uint32_t) + sizeof(std::int16_t)));
+    ASSERT_TRUE(sender.flush());
+    ASSERT_EQ(receiver.poll(), 2u);
+    ASSERT_EQ(received, (std::vector<double>{1.25, -3.5}));
+}
+
+TEST(socket_bridge, Malformed)
+{
+    socket_pair sockets{SOCK_DGRAM};
+    astl::socket_bridge_receiver<ScaledTag, double> receiver{};
+    ASSERT_TRUE(receiver.open(sockets.fds[1], no_delay()));
+
+    // a frame the codec rejects, a valid frame and a truncated frame header
+    std::uint32_t const length = 3;
+    std::vector<std::byte> datagram(sizeof(length) + length + sizeof(length) + 2 + 2);
+    std::memcpy(datagram.data(), &length, sizeof(length));
+    std::uint32_t const valid = 2;
+    std::memcpy(datagram.data() + sizeof(length) + length, &valid, sizeof(valid));
+    ASSERT_EQ(::send(sockets.fds[0], datagram.data(), datagram.size(), 0), static_cast<ssize_t>(datagram.size()));
+    ASSERT_EQ(receiver.poll(), 1u);
+    ASSERT_EQ(receiver.malformed(), 2u);
+}
+
+TEST(socket_bridge, PeerClosed)
+{
+    socket_pair sockets{SOCK_STREAM};
+    astl::socket_bridge_sender<SampleTag, int> sender{};
+    ASSERT_TRUE(sender.open(sockets.fds[0], no_delay()));
+    astl::socket_bridge_receiver<SampleTag, int> receiver{};
+    ASSERT_TRUE(receiver.open(sockets.fds[1]));
+
+    sender.invoke(1);
+    ASSERT_TRUE(sender.flush());
+    ::shutdown(sockets.fds[0], SHUT_WR);
+    ASSERT_EQ(receiver.poll(), 1u);
+    ASSERT_TRUE(receiver.closed());
+
+    ::shutdown(sockets.fds[1], SHUT_RDWR);
+    sender.invoke(2);
+    ASSERT_FALSE(sender.flush());
+    ASSERT_TRUE(sender.failed());
+    ASSERT_FALSE(sender.invoke(3));
+}
+
+TEST(socket_bridge, SustainedBackpressure)
+{
+    socket_pair sockets{SOCK_STREAM};
+    int buffer_size{4096};
+    ::setsockopt(sockets.fds[0], SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+    ::fcntl(sockets.fds[0], F_SETFL, ::fcntl(sockets.fds[0], F_GETFL) | O_NONBLOCK);
+    auto options = no_delay(256);
+    options.max_pending = 64 * 1024;
+    astl::socket_bridge_sender<SampleTag, int> sender{};
+    ASSERT_TRUE(sender.open(sockets.fds[0], options));
+    astl::socket_bridge_receiver<SampleTag, int> receiver{};
+    ASSERT_TRUE(receiver.open(sockets.fds[1]));
+    int received{0};
+    astl::socket_bridge_receiver<SampleTag, int>::slot_type slot{[&received](int const&){ ++received; }};
+    receiver.sig().connect(slot);
+
+    // fill the queue beyond the socket buffers, then let the receiver keep pace with the sender
+    auto sent = 0;
+    while (sender.pending() < options.max_pending / 2) {
+        ASSERT_TRUE(sender.invoke(sent++));
+    }
+    std::uint64_t allocations{0};
+    for (auto round = 0; round < 1000; ++round) {
+        astl::testsupport::alloc_counter counter{};
+        for (auto i = 0; i < 100; ++i) {
+            sender.invoke(sent++);
+        }
+        counter.stop();
+        if (round >= 500) {
+            allocations += counter.allocations();
+        }
+        receiver.poll(100);
+        ASSERT_GT(sender.pending(), options.max_pending / 4);
+    }
+    ASSERT_EQ(sender.dropped(), 0u);
+    ASSERT_EQ(allocations, 0u);    // the sent batches are reused
+}
+
+TEST(socket_bridge, LoopbackTcp)
+{
+    auto listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length{sizeof(address)};
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ASSERT_EQ(::listen(listener, 1), 0);
+    ASSERT_EQ(::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length), 0);
+    auto client = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    auto server = ::accept(listener, nullptr, nullptr);
+    ASSERT_GE(server, 0);
+
+    constexpr auto count = 200000;
+    std::thread producer{[client]{
+        astl::socket_bridge_sender<SampleTag, int> sender{};
+        sender.open(client);
+        for (auto i = 0; i < count; ++i) {
+            sender.invoke(i);
+        }
+        sender.flush();
+        ::shutdown(client, SHUT_WR);
+    }};
+
+    astl::socket_bridge_receiver<SampleTag, int> receiver{};
+    ASSERT_TRUE(receiver.open(server));
+    auto next = 0;
+    auto in_order = true;
+    astl::slot<SampleTag, int> slot{[&next, &in_order](int v){ in_order = in_order && v == next++; }};
+    receiver.sig().connect(slot);
+    while (!receiver.closed()) {
+        receiver.wait(std::chrono::milliseconds{100});
+    }
+    producer.join();
+    ASSERT_EQ(next, count);
+    ASSERT_TRUE(in_order);
+    ::close(server);
+    ::close(client);
+    ::close(listener);
+}
@@ -0,0 +1,241 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/event.h>
+#include <astl/serializer.h>
+#include <astl/shm_ring.h>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+
+namespace astl {
+
+    //! Producer side of an event broadcast to other processes on the same host through a shared memory ring.
+    //! Any number of processes may open the same segment and invoke the event concurrently. The event data is
+    //! copied once - into the ring. See shm_event_consumer for the receiving side.
+    //! \code
+    //! #include <astl/shm_event.h>
+    //!
+    //! // process A
+    //! astl::shm_event<SpeedEventFlag, float> speed{};
+    //! speed.create("/myapp-speed", 4096);
+    //! speed.invoke(23.3f);
+    //!
+    //! // process B
+    //! astl::shm_event_consumer<SpeedEventFlag, float> speed{};
+    //! speed.open("/myapp-speed");
+    //! speed.sig().connect(speedSlot);
+    //! while (running) {
+    //!     speed.wait(std::chrono::milliseconds{100});
+    //! }
+    //! \endcode
+    //!
+    //! \tparam Ts      Types of data associated with an event. Must be trivially copyable and serialized bitwise, a slot
+    //!                 holds exactly sizeof(Ts)... bytes. Pointers and std::string_view are rejected.
+    //! \tparam TAG     Tagging type to distinguish events using the same data type T.
+    template<typename TAG, typename...Ts>
+    class shm_event
+    {
+        static_assert((is_bitwise_serializable<Ts>::value && ...),
+                      "shm_event data must be trivially copyable and serialized with its size, e.g. no string_view");
+
+    public:
+        //! Bytes of event data per entry.
+        static constexpr std::size_t payload_size = (std::size_t{0} + ... + sizeof(Ts));
+
+        explicit shm_event() noexcept = default;
+
+        //! Creates the POSIX shared memory object name with room for capacity events.
+        bool create(std::string const& name, std::size_t capacity) noexcept;
+
+        //! Creates an anonymous segment, whose fd() has to be passed to the consumers.
+        bool create_memfd(std::size_t capacity) noexcept;
+
+        //! Opens an existing segment created by another producer.
+        bool open(std::string const& name) noexcept;
+        bool open_fd(int fd) noexcept;
+
+        //! File descriptor of the segment.
+        [[nodiscard]] int fd() const noexcept;
+
+        //! Broadcasts the event to all consumers of the segment.
+        void invoke(Ts const&...args) noexcept;
+
+    private:
+        shm_ring ring_{};
+    };
+
+    //! Consumer side of a shm_event. It has its own read cursor and dispatches the received events on a local
+    //! astl::signal. A consumer starts with the events invoked after it has been opened.
+    template<typename TAG, typename...Ts>
+    class shm_event_consumer
+    {
+        static_assert((is_bitwise_serializable<Ts>::value && ...),
+                      "shm_event data must be trivially copyable and serialized with its size, e.g. no string_view");
+
+    public:
+        using signal_type = typename event<TAG, Ts...>::signal_type;
+        using slot_type = typename event<TAG, Ts...>::slot_type;
+
+        explicit shm_event_consumer() noexcept = default;
+
+        bool open(std::string const& name) noexcept;
+        bool open_fd(int fd) noexcept;
+
+        //! Returns a reference to the local signal on which received events are dispatched.
+        signal_type& sig() noexcept;
+
+        //! Dispatches up to max received events without blocking. Returns the number of dispatched events.
+        std::size_t poll(std::size_t max = std::numeric_limits<std::size_t>::max()) noexcept;
+
+        //! Blocks until events are available or timeout expires, then dispatches up to max of them.
+        std::size_t wait(std::chrono::nanoseconds timeout,
+                         std::size_t max = std::numeric_limits<std::size_t>::max()) noexcept;
+
+        //! Number of events lost because the producers overran this consumer.
+        [[nodiscard]] std::uint64_t overruns() const noexcept;
+
+    private:
+        shm_ring ring_{};
+        event<TAG, Ts...> event_{};
+        std::uint64_t cursor_{0};
+        std::uint64_t overruns_{0};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl shm_event
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts>
+    bool
+    astl::shm_event<TAG, Ts...>::create(std::string const& name, std::size_t capacity) noexcept
+{
+    return ring_.create(name, typeid(TAG).name(), payload_size, capacity);
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::shm_event<TAG, Ts...>::create_memfd(std::size_t capacity) noexcept
+{
+    return ring_.create_memfd(typeid(TAG).name(), payload_size, capacity);
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::shm_event<TAG, Ts...>::open(std::string const& name) noexcept
+{
+    return ring_.open(name, typeid(TAG).name(), payload_size);
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::shm_event<TAG, Ts...>::open_fd(int fd) noexcept
+{
+    return ring_.open_fd(fd, typeid(TAG).name(), payload_size);
+}
+
+template<typename TAG, typename...Ts>
+    int
+    astl::shm_event<TAG, Ts...>::fd() const noexcept
+{
+    return ring_.fd();
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::shm_event<TAG, Ts...>::invoke(Ts const&...args) noexcept
+{
+    ring_.write([&args...](std::byte* out){ serialize(out, args...); });
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl shm_event_consumer
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts>
+    bool
+    astl::shm_event_consumer<TAG, Ts...>::open(std::string const& name) noexcept
+{
+    if (!ring_.open(name, typeid(TAG).name(), shm_event<TAG, Ts...>::payload_size)) {
+        return false;
+    }
+    cursor_ = ring_.end();
+    return true;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::shm_event_consumer<TAG, Ts...>::open_fd(int fd) noexcept
+{
+    if (!ring_.open_fd(fd, typeid(TAG).name(), shm_event<TAG, Ts...>::payload_size)) {
+        return false;
+    }
+    cursor_ = ring_.end();
+    return true;
+}
+
+template<typename TAG, typename...Ts>
+    typename astl::shm_event_consumer<TAG, Ts...>::signal_type&
+    astl::shm_event_consumer<TAG, Ts...>::sig() noexcept
+{
+    return event_.sig();
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::shm_event_consumer<TAG, Ts...>::poll(std::size_t max) noexcept
+{
+    // the payload is copied out of the ring before dispatch - the slot may be overwritten meanwhile
+    std::array<std::byte, shm_event<TAG, Ts...>::payload_size + 1> buffer{};
+    std::size_t count{0};
+    while (count < max) {
+        auto before = cursor_;
+        auto result = ring_.read(cursor_, buffer.data());
+        if (result == shm_ring::read_result::empty) {
+            break;
+        }
+        if (result == shm_ring::read_result::overrun) {
+            overruns_ += cursor_ - before;
+            continue;
+        }
+        std::tuple<Ts...> values{};
+        deserialize(buffer.data(), buffer.data() + shm_event<TAG, Ts...>::payload_size, values);
+        std::apply([this](Ts const&...args){ this->event_.invoke(args...); }, values);
+        ++count;
+    }
+    return count;
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::shm_event_consumer<TAG, Ts...>::wait(std::chrono::nanoseconds timeout, std::size_t max) noexcept
+{
+    auto count = poll(max);
+    if (count == 0 && ring_.wait(cursor_, timeout)) {
+        count = poll(max);
+    }
+    return count;
+}
+
+template<typename TAG, typename...Ts>
+    std::uint64_t
+    astl::shm_event_consumer<TAG, Ts...>::overruns() const noexcept
+{
+    return overruns_;
+}
@@ -0,0 +1,348 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace astl {
+
+    //! Header of a shared memory ring segment.
+    struct shm_ring_header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t capacity;                         //!< number of slots, a power of two
+        std::uint32_t slot_size;                        //!< bytes per slot including its sequence word
+        std::uint32_t payload_size;                     //!< bytes of payload per slot
+        char tag[104];                                  //!< identifies the type of the transported events
+        alignas(64) std::atomic<std::uint64_t> claimed; //!< number of slots claimed by producers
+        alignas(64) std::atomic<std::uint32_t> futex;   //!< incremented after each commit, consumers wait on it
+        std::atomic<std::uint32_t> waiters;             //!< number of consumers waiting on futex
+    };
+    static_assert(sizeof(shm_ring_header) == 256);
+
+    //! Multi-producer, multi-consumer broadcast ring in a shared memory segment, lock-free for the consumers.
+    //! Every consumer reads all slots with its own cursor; producers never wait for consumers. A producer waits only
+    //! for the producer that claimed its slot one lap earlier and is still writing it. A consumer that falls
+    //! more than the capacity behind has been overrun and skips the lost entries. Each slot is protected by a sequence
+    //! word (seqlock), so a consumer never delivers a torn payload. Consumers sleep on a futex in the segment header
+    //! while the ring is empty; producers only issue the wake system call when a consumer waits.
+    //! The segment is a POSIX shared memory object (shm_open) or an anonymous memfd whose file descriptor has to be
+    //! passed to the other processes (inheritance or SCM_RIGHTS).
+    //! Liveness: producers must not die between claiming and committing a slot. The slot of a dead producer is never
+    //! committed, the producer claiming it one lap later spins forever and so does every producer behind it. Processes
+    //! sharing a ring as producers have to be restarted together.
+    class shm_ring
+    {
+    public:
+        //! Result of a read attempt.
+        enum class read_result {
+            ok,         //!< the payload has been copied, the cursor advanced
+            empty,      //!< no new entry
+            overrun,    //!< entries have been lost, the cursor has been moved to the oldest available entry
+        };
+
+        explicit shm_ring() noexcept = default;
+        ~shm_ring() noexcept;
+
+        shm_ring(shm_ring const&) = delete;
+        shm_ring& operator=(shm_ring const&) = delete;
+
+        //! Creates (or recreates) the POSIX shared memory object name.
+        bool create(std::string const& name, char const* tag, std::size_t payload_size, std::size_t capacity) noexcept;
+
+        //! Creates an anonymous memfd segment, see fd().
+        bool create_memfd(char const* tag, std::size_t payload_size, std::size_t capacity) noexcept;
+
+        //! Maps the existing POSIX shared memory object name.
+        bool open(std::string const& name, char const* tag, std::size_t payload_size) noexcept;
+
+        //! Maps the segment behind fd (e.g. a memfd received from another process). fd is duplicated.
+        bool open_fd(int fd, char const* tag, std::size_t payload_size) noexcept;
+
+        //! Unmaps the segment.
+        void close() noexcept;
+
+        [[nodiscard]] bool is_open() const noexcept;
+
+        //! File descriptor of the segment, e.g. to pass a memfd segment to other processes.
+        [[nodiscard]] int fd() const noexcept;
+
+        //! Claims a slot, lets write(std::byte*) fill payload_size bytes and publishes the slot.
+        template<typename F>
+        void write(F write) noexcept;
+
+        //! Sequence number of the next entry that will be written.
+        [[nodiscard]] std::uint64_t end() const noexcept;
+
+        //! Copies the entry with sequence number cursor to out and advances cursor.
+        read_result read(std::uint64_t& cursor, std::byte* out) const noexcept;
+
+        //! Blocks until an entry behind cursor may be available or timeout expires.
+        //! \returns false when the timeout expired.
+        bool wait(std::uint64_t cursor, std::chrono::nanoseconds timeout) noexcept;
+
+    private:
+        bool init(char const* tag, std::size_t payload_size, std::size_t capacity) noexcept;
+        bool attach(char const* tag, std::size_t payload_size) noexcept;
+        std::atomic<std::uint64_t>& sequence(std::uint64_t index) const noexcept;
+
+        static int futex(std::atomic<std::uint32_t>* addr, int op, std::uint32_t value,
+                         struct timespec const* timeout) noexcept;
+
+    private:
+        int fd_{-1};
+        std::byte* data_{nullptr};
+        std::size_t size_{0};
+        shm_ring_header* header_{nullptr};
+        std::uint64_t mask_{0};
+        std::size_t slot_size_{0};
+        std::size_t payload_size_{0};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl shm_ring
+// ------------------------------------------------------------------------------------------------
+namespace astl::detail {
+    constexpr char shm_ring_magic[8] = {'A', 'S', 'T', 'L', 'S', 'H', 'M', '\0'};
+    constexpr std::uint32_t shm_ring_version = 1;
+}
+
+inline astl::shm_ring::~shm_ring() noexcept
+{
+    close();
+}
+
+inline bool astl::shm_ring::create(std::string const& name, char const* tag, std::size_t payload_size,
+                                   std::size_t capacity) noexcept
+{
+    close();
+    fd_ = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    return fd_ >= 0 && init(tag, payload_size, capacity);
+}
+
+inline bool astl::shm_ring::create_memfd(char const* tag, std::size_t payload_size, std::size_t capacity) noexcept
+{
+    close();
+    fd_ = ::memfd_create("astl-shm-ring", 0);
+    return fd_ >= 0 && init(tag, payload_size, capacity);
+}
+
+inline bool astl::shm_ring::open(std::string const& name, char const* tag, std::size_t payload_size) noexcept
+{
+    close();
+    fd_ = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0600);
+    return fd_ >= 0 && attach(tag, payload_size);
+}
+
+inline bool astl::shm_ring::open_fd(int fd, char const* tag, std::size_t payload_size) noexcept
+{
+    close();
+    fd_ = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    return fd_ >= 0 && attach(tag, payload_size);
+}
+
+inline void astl::shm_ring::close() noexcept
+{
+    if (data_) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        header_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+}
+
+inline bool astl::shm_ring::is_open() const noexcept
+{
+    return header_ != nullptr;
+}
+
+inline int astl::shm_ring::fd() const noexcept
+{
+    return fd_;
+}
+
+template<typename F>
+void astl::shm_ring::write(F write) noexcept
+{
+    auto index = header_->claimed.fetch_add(1, std::memory_order_relaxed);
+    auto& seq = sequence(index);
+    // odd: being written, even: committed entry index + 1 (shifted)
+    // the entry of the previous lap has to be committed first, otherwise its producer would publish our payload.
+    // There is no timeout: a producer still writing cannot be told apart from a dead one, taking over its slot could
+    // publish its late payload under our sequence. A dead producer blocks this slot for good, see class doc.
+    auto previous = index > mask_ ? (index - mask_) << 1u : std::uint64_t{0};
+    auto expected = previous;
+    while (!seq.compare_exchange_weak(expected, (index << 1u) | 1u, std::memory_order_relaxed)) {
+        expected = previous;
+        std::this_thread::yield();
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    write(reinterpret_cast<std::byte*>(&seq) + sizeof(seq));
+    seq.store((index + 1) << 1u, std::memory_order_release);
+
+    header_->futex.fetch_add(1, std::memory_order_release);
+    if (header_->waiters.load(std::memory_order_seq_cst) != 0) {
+        futex(&header_->futex, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+}
+
+inline std::uint64_t astl::shm_ring::end() const noexcept
+{
+    return header_->claimed.load(std::memory_order_acquire);
+}
+
+inline astl::shm_ring::read_result astl::shm_ring::read(std::uint64_t& cursor, std::byte* out) const noexcept
+{
+    auto& seq = sequence(cursor);
+    auto committed = (cursor + 1) << 1u;
+    auto s1 = seq.load(std::memory_order_acquire);
+    if (s1 == committed) {
+        std::memcpy(out, reinterpret_cast<std::byte const*>(&seq) + sizeof(seq), payload_size_);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == s1) {
+            ++cursor;
+            return read_result::ok;
+        }
+    }
+    else if (s1 < committed - 1) {
+        // the slot still holds an older entry (or the entry for cursor is being written): nothing new yet, unless
+        // the producers already claimed more than a full ring behind the cursor
+        if (end() - cursor <= mask_) {
+            return read_result::empty;
+        }
+    }
+    else if (s1 == committed - 1) {
+        return read_result::empty;
+    }
+    // the slot has been reused for a newer entry
+    auto claimed = end();
+    cursor = claimed > mask_ + 1 ? claimed - (mask_ + 1) : 0;
+    return read_result::overrun;
+}
+
+inline bool astl::shm_ring::wait(std::uint64_t cursor, std::chrono::nanoseconds timeout) noexcept
+{
+    auto value = header_->futex.load(std::memory_order_acquire);
+    if (sequence(cursor).load(std::memory_order_acquire) >= ((cursor + 1) << 1u) || end() - cursor > mask_) {
+        return true;
+    }
+    header_->waiters.fetch_add(1, std::memory_order_seq_cst);
+    struct timespec ts{};
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1'000'000'000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1'000'000'000);
+    auto result = futex(&header_->futex, FUTEX_WAIT, value, &ts);
+    header_->waiters.fetch_sub(1, std::memory_order_relaxed);
+    return result == 0 || errno != ETIMEDOUT;
+}
+
+inline bool astl::shm_ring::init(char const* tag, std::size_t payload_size, std::size_t capacity) noexcept
+{
+    std::uint64_t cap{1};
+    while (cap < capacity) {
+        cap <<= 1u;
+    }
+    // every slot on its own cache line(s), so producers writing neighbouring slots do not share them
+    auto slot_size = (sizeof(std::uint64_t) + payload_size + 63u) & ~std::size_t{63u};
+    auto size = sizeof(shm_ring_header) + cap * slot_size;
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        close();
+        return false;
+    }
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data_ = static_cast<std::byte*>(p);
+    size_ = size;
+    std::memset(p, 0, size);
+
+    header_ = new (data_) shm_ring_header{};
+    std::memcpy(header_->magic, detail::shm_ring_magic, sizeof(detail::shm_ring_magic));
+    header_->version = detail::shm_ring_version;
+    header_->capacity = static_cast<std::uint32_t>(cap);
+    header_->slot_size = static_cast<std::uint32_t>(slot_size);
+    header_->payload_size = static_cast<std::uint32_t>(payload_size);
+    std::strncpy(header_->tag, tag, sizeof(header_->tag) - 1);
+    mask_ = cap - 1;
+    slot_size_ = slot_size;
+    payload_size_ = payload_size;
+    return true;
+}
+
+inline bool astl::shm_ring::attach(char const* tag, std::size_t payload_size) noexcept
+{
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(shm_ring_header)) {
+        close();
+        return false;
+    }
+    auto size = static_cast<std::size_t>(st.st_size);
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data_ = static_cast<std::byte*>(p);
+    size_ = size;
+    header_ = reinterpret_cast<shm_ring_header*>(data_);
+    if (std::memcmp(header_->magic, detail::shm_ring_magic, sizeof(detail::shm_ring_magic)) != 0
+            || header_->version != detail::shm_ring_version
+            || header_->payload_size != payload_size
+            || std::strncmp(header_->tag, tag, sizeof(header_->tag) - 1) != 0
+            || sizeof(shm_ring_header) + std::size_t{header_->capacity} * header_->slot_size > size) {
+        close();
+        return false;
+    }
+    mask_ = header_->capacity - 1;
+    slot_size_ = header_->slot_size;
+    payload_size_ = payload_size;
+    return true;
+}
+
+inline std::atomic<std::uint64_t>& astl::shm_ring::sequence(std::uint64_t index) const noexcept
+{
+    return *reinterpret_cast<std::atomic<std::uint64_t>*>(data_ + sizeof(shm_ring_header) + (index & mask_) * slot_size_);
+}
+
+inline int astl::shm_ring::futex(std::atomic<std::uint32_t>* addr, int op, std::uint32_t value,
+                                 struct timespec const* timeout) noexcept
+{
+    // not FUTEX_PRIVATE_FLAG: waiters and wakers live in different processes
+    return static_cast<int>(::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(addr), op, value, timeout,
+                                      nullptr, 0));
+}
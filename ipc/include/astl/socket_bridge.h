@@ -0,0 +1,654 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <astl/event.h>
+#include <astl/serializer.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace astl {
+
+    //! Batching and buffer parameters of socket_bridge_sender and socket_bridge_receiver.
+    struct bridge_options
+    {
+        //! Size of a batch. The sender flushes once this many bytes are queued; on datagram sockets a batch is one
+        //! datagram, so it also limits the size of an event.
+        std::size_t batch_bytes{16 * 1024};
+        //! Longest time the sender holds back an event waiting for more to fill the batch. Zero sends each event
+        //! immediately.
+        std::chrono::microseconds flush_delay{200};
+        //! Bytes the sender queues while the socket does not accept them, events beyond are dropped. The receiver
+        //! rejects frames larger than this.
+        std::size_t max_pending{1024 * 1024};
+        //! Datagrams the receiver reads with one call.
+        std::size_t receive_batches{16};
+    };
+
+    //! Customization point for the wire format of the event data of a socket bridge. The default codec uses
+    //! astl::serializer; a specialization for TAG and Ts... provides the same three static functions:
+    //! \code
+    //! template<>
+    //! struct astl::bridge_codec<PositionTag, position>
+    //! {
+    //!     static std::size_t size(position const& p) noexcept;
+    //!     static std::byte* encode(std::byte* out, position const& p) noexcept;
+    //!     // returns false when [in, end) is not a valid encoding
+    //!     static bool decode(std::byte const* in, std::byte const* end, std::tuple<position>& values) noexcept;
+    //! };
+    //! \endcode
+    template<typename TAG, typename...Ts>
+    struct bridge_codec
+    {
+        static std::size_t size(Ts const&...values) noexcept
+        {
+            return serialized_size(values...);
+        }
+
+        static std::byte* encode(std::byte* out, Ts const&...values) noexcept
+        {
+            return serialize(out, values...);
+        }
+
+        static bool decode(std::byte const* in, std::byte const* end, std::tuple<Ts...>& values) noexcept
+        {
+            return deserialize(in, end, values);
+        }
+    };
+
+    //! Sending side of an event forwarded over a connected socket - TCP, UDP or Unix domain - to a
+    //! socket_bridge_receiver in another process or on another host.
+    //! Invocations are encoded into batches as frames of a 32 bit length followed by the codec output. A batch is sent
+    //! once batch_bytes are queued or the oldest queued event is older than flush_delay, in the manner of Nagle's
+    //! algorithm. Queued batches go out with a single gather write: sendmsg on stream sockets, sendmmsg with one
+    //! datagram per batch on datagram sockets.
+    //! The time limit is checked when events are invoked; when the producer may become quiet it has to call
+    //! flush_if_due() until deadline() or flush() itself.
+    //! \code
+    //! #include <astl/socket_bridge.h>
+    //!
+    //! astl::socket_bridge_sender<SpeedEventTag, float> bridge{};
+    //! bridge.open(connected_socket);
+    //! bridge.connect(speed.sig());        // forwards all invocations of the local event speed
+    //! ...
+    //! bridge.flush_if_due();              // from the event loop, at the latest at bridge.deadline()
+    //! \endcode
+    //! The bridge does not own the socket. Data is encoded in host byte order unless the codec does otherwise.
+    //!
+    //! \tparam Ts      Types of data associated with an event.
+    //! \tparam TAG     Tagging type to distinguish events using the same data type T.
+    template<typename TAG, typename...Ts>
+    class socket_bridge_sender
+    {
+    public:
+        using codec_type = bridge_codec<TAG, Ts...>;
+        using signal_type = typename event<TAG, Ts...>::signal_type;
+        using clock_type = std::chrono::steady_clock;
+
+        explicit socket_bridge_sender() noexcept = default;
+
+        socket_bridge_sender(socket_bridge_sender const&) = delete;
+        socket_bridge_sender& operator=(socket_bridge_sender const&) = delete;
+
+        //! Uses the connected socket fd. Returns false when fd is not a socket.
+        bool open(int fd, bridge_options options = {}) noexcept;
+
+        //! Forwards the invocations of signal.
+        void connect(signal_type& signal) noexcept;
+
+        //! Queues the event and sends the queued batches when a flush is due. Returns false when the event was dropped
+        //! or the socket failed.
+        bool invoke(Ts const&...args) noexcept;
+
+        //! Sends all queued batches. On a non-blocking socket the part the socket does not accept stays queued.
+        //! Returns false when the socket failed.
+        bool flush() noexcept;
+
+        //! Flushes when the oldest queued event has waited flush_delay. Returns false when the socket failed.
+        bool flush_if_due() noexcept;
+
+        //! Time when the queued events are due, clock_type::time_point::max() when none is queued.
+        [[nodiscard]] clock_type::time_point deadline() const noexcept;
+
+        //! Bytes queued and not yet sent.
+        [[nodiscard]] std::size_t pending() const noexcept;
+
+        //! Number of events dropped because max_pending was reached or they exceed the datagram size.
+        [[nodiscard]] std::uint64_t dropped() const noexcept;
+
+        //! Returns whether sending failed, e.g. because the peer closed the connection.
+        [[nodiscard]] bool failed() const noexcept;
+
+    private:
+        using frame_size = std::uint32_t;
+
+        bool flush_stream() noexcept;
+        bool flush_datagrams() noexcept;
+        bool send_failed() noexcept;
+        std::vector<std::byte>& batch_for(std::size_t size) noexcept;
+
+    private:
+        int fd_{-1};
+        bool stream_{true};
+        bool failed_{false};
+        bridge_options options_{};
+        std::vector<std::vector<std::byte>> batches_{};  // [head_, count_) queued, buffers are reused
+        std::size_t head_{0};
+        std::size_t count_{0};
+        std::size_t offset_{0};                          // bytes of batches_[head_] already sent
+        std::size_t pending_{0};
+        clock_type::time_point first_{};                 // time the oldest pending event was queued
+        std::uint64_t dropped_{0};
+        slot<TAG, Ts...> slot_{};
+    };
+
+    //! Receiving side of a socket_bridge_sender. It reads the batches without blocking - recvmmsg into a pool of
+    //! datagram buffers allocated once on datagram sockets - and dispatches the events on a local astl::signal.
+    //! \code
+    //! astl::socket_bridge_receiver<SpeedEventTag, float> bridge{};
+    //! bridge.open(connected_socket);
+    //! bridge.sig().connect(speedSlot);
+    //! while (!bridge.closed()) {
+    //!     bridge.wait(std::chrono::milliseconds{100});
+    //! }
+    //! \endcode
+    template<typename TAG, typename...Ts>
+    class socket_bridge_receiver
+    {
+    public:
+        using codec_type = bridge_codec<TAG, Ts...>;
+        using signal_type = typename event<TAG, Ts...>::signal_type;
+        using slot_type = typename event<TAG, Ts...>::slot_type;
+
+        explicit socket_bridge_receiver() noexcept = default;
+
+        socket_bridge_receiver(socket_bridge_receiver const&) = delete;
+        socket_bridge_receiver& operator=(socket_bridge_receiver const&) = delete;
+
+        //! Uses the connected socket fd. Returns false when fd is not a socket.
+        bool open(int fd, bridge_options options = {}) noexcept;
+
+        //! Returns a reference to the local signal on which received events are dispatched.
+        signal_type& sig() noexcept;
+
+        //! Dispatches up to max received events without blocking. Returns the number of dispatched events.
+        std::size_t poll(std::size_t max = std::numeric_limits<std::size_t>::max()) noexcept;
+
+        //! Blocks until events are available or timeout expires, then dispatches up to max of them.
+        std::size_t wait(std::chrono::nanoseconds timeout,
+                         std::size_t max = std::numeric_limits<std::size_t>::max()) noexcept;
+
+        //! Returns whether the peer closed the connection or receiving failed. Events received before are still
+        //! dispatched.
+        [[nodiscard]] bool closed() const noexcept;
+
+        //! Number of frames or datagrams dropped because they could not be decoded.
+        [[nodiscard]] std::uint64_t malformed() const noexcept;
+
+    private:
+        using frame_size = std::uint32_t;
+        enum class frame_result { dispatched, incomplete, malformed };
+
+        frame_result dispatch_frame(std::byte const*& in, std::byte const* end) noexcept;
+        std::size_t poll_stream(std::size_t max) noexcept;
+        std::size_t poll_datagrams(std::size_t max) noexcept;
+        bool receive_failed() noexcept;
+
+    private:
+        int fd_{-1};
+        int type_{SOCK_STREAM};
+        bool closed_{false};
+        bridge_options options_{};
+        std::vector<std::byte> buffer_{};       // stream: received bytes [begin_, end_), datagrams: pooled buffers
+        std::size_t begin_{0};                  // datagrams: offset of the next frame in the current datagram
+        std::size_t end_{0};
+        std::vector<mmsghdr> messages_{};
+        std::vector<iovec> vectors_{};
+        std::size_t received_{0};               // datagrams read by the last recvmmsg
+        std::size_t current_{0};                // datagram being dispatched
+        std::uint64_t malformed_{0};
+        event<TAG, Ts...> event_{};
+    };
+
+} // namespace astl
+
+// ------------------------------------------------------------------------------------------------
+// impl socket_bridge_sender
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts>
+    bool
+    astl::socket_bridge_sender<TAG, Ts...>::open(int fd, bridge_options options) noexcept
+{
+    int type{0};
+    socklen_t length{sizeof(type)};
+    if (::getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &length) != 0) {
+        return false;
+    }
+    fd_ = fd;
+    stream_ = type == SOCK_STREAM;
+    failed_ = false;
+    options_ = options;
+    head_ = count_ = offset_ = pending_ = 0;
+    return true;
+}
+
+template<typename TAG, typename...Ts>
+    void
+    astl::socket_bridge_sender<TAG, Ts...>::connect(signal_type& signal) noexcept
+{
+    slot_.set_functor([this](Ts const&...args){ invoke(args...); });
+    signal.connect(slot_);
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::socket_bridge_sender<TAG, Ts...>::invoke(Ts const&...args) noexcept
+{
+    if (failed_ || fd_ < 0) {
+        return false;
+    }
+    auto const size = sizeof(frame_size) + codec_type::size(args...);
+    if ((!stream_ && size > options_.batch_bytes) || size - sizeof(frame_size) > std::numeric_limits<frame_size>::max()) {
+        ++dropped_;
+        return false;
+    }
+    if (pending_ + size > options_.max_pending && (!flush() || pending_ + size > options_.max_pending)) {
+        ++dropped_;
+        return false;
+    }
+
+    auto const now = clock_type::now();
+    if (pending_ == 0) {
+        first_ = now;
+    }
+    auto& batch = batch_for(size);
+    auto const at = batch.size();
+    batch.resize(at + size);
+    auto const length = static_cast<frame_size>(size - sizeof(frame_size));
+    std::memcpy(batch.data() + at, &length, sizeof(frame_size));
+    codec_type::encode(batch.data() + at + sizeof(frame_size), args...);
+    pending_ += size;
+
+    if (pending_ >= options_.batch_bytes || now - first_ >= options_.flush_delay) {
+        return flush();
+    }
+    return true;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::socket_bridge_sender<TAG, Ts...>::flush() noexcept
+{
+    if (failed_) {
+        return false;
+    }
+    if (!(stream_ ? flush_stream() : flush_datagrams())) {
+        return false;
+    }
+    if (head_ == count_) {
+        head_ = count_ = offset_ = 0;
+    }
+    return true;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::socket_bridge_sender<TAG, Ts...>::flush_if_due() noexcept
+{
+    if (pending_ > 0 && clock_type::now() >= deadline()) {
+        return flush();
+    }
+    return !failed_;
+}
+
+template<typename TAG, typename...Ts>
+    typename astl::socket_bridge_sender<TAG, Ts...>::clock_type::time_point
+    astl::socket_bridge_sender<TAG, Ts...>::deadline() const noexcept
+{
+    return pending_ > 0 ? first_ + options_.flush_delay : clock_type::time_point::max();
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::socket_bridge_sender<TAG, Ts...>::pending() const noexcept
+{
+    return pending_;
+}
+
+template<typename TAG, typename...Ts>
+    std::uint64_t
+    astl::socket_bridge_sender<TAG, Ts...>::dropped() const noexcept
+{
+    return dropped_;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::socket_bridge_sender<TAG, Ts...>::failed() const noexcept
+{
+    return failed_;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::socket_bridge_sender<TAG, Ts...>::flush_stream() noexcept
+{
+    // sendmsg instead of writev, it takes MSG_NOSIGNAL
+    while (head_ < count_) {
+        std::array<iovec, 64> vectors{};
+        std::size_t n{0};
+        for (auto i = head_; i < count_ && n < vectors.size(); ++i, ++n) {
+            auto const skip = i == head_ ? offset_ : 0;
+            vectors[n].iov_base = batches_[i].data() + skip;
+            vectors[n].iov_len = batches_[i].size() - skip;
+        }
+        msghdr message{};
+        message.msg_iov = vectors.data();
+        message.msg_iovlen = n;
+        auto sent = ::sendmsg(fd_, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            return send_failed();
+        }
+        pending_ -= static_cast<std::size_t>(sent);
+        for (auto rest = static_cast<std::size_t>(sent); rest > 0;) {
+            auto const left = batches_[head_].size() - offset_;
+            if (rest < left) {
+                offset_ += rest;
+                break;
+            }
+            rest -= left;
+            offset_ = 0;
+            ++head_;
+        }
+    }
+    return true;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::socket_bridge_sender<TAG, Ts...>::flush_datagrams() noexcept
+{
+    while (head_ < count_) {
+        std::array<mmsghdr, 64> messages{};
+        std::array<iovec, 64> vectors{};
+        std::size_t n{0};
+        for (auto i = head_; i < count_ && n < messages.size(); ++i, ++n) {
+            vectors[n].iov_base = batches_[i].data();
+            vectors[n].iov_len = batches_[i].size();
+            messages[n].msg_hdr.msg_iov = &vectors[n];
+            messages[n].msg_hdr.msg_iovlen = 1;
+        }
+        auto sent = ::sendmmsg(fd_, messages.data(), static_cast<unsigned>(n), MSG_NOSIGNAL);
+        if (sent < 0) {
+            return send_failed();
+        }
+        for (auto i = 0; i < sent; ++i, ++head_) {
+            pending_ -= batches_[head_].size();
+        }
+    }
+    return true;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::socket_bridge_sender<TAG, Ts...>::send_failed() noexcept
+{
+    if (errno == EINTR) {
+        return flush();
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return true;
+    }
+    failed_ = true;
+    return false;
+}
+
+template<typename TAG, typename...Ts>
+    std::vector<std::byte>&
+    astl::socket_bridge_sender<TAG, Ts...>::batch_for(std::size_t size) noexcept
+{
+    if (count_ > head_ && batches_[count_ - 1].size() + size <= options_.batch_bytes) {
+        return batches_[count_ - 1];
+    }
+    if (count_ == batches_.size() && head_ >= count_ - head_) {
+        // under backpressure the queue never drains, reuse the sent buffers instead of growing without bound
+        std::rotate(batches_.begin(), batches_.begin() + static_cast<std::ptrdiff_t>(head_),
+                    batches_.begin() + static_cast<std::ptrdiff_t>(count_));
+        count_ -= head_;
+        head_ = 0;
+    }
+    if (count_ == batches_.size()) {
+        batches_.emplace_back();
+    }
+    auto& batch = batches_[count_++];
+    batch.clear();
+    batch.reserve(options_.batch_bytes);
+    return batch;
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl socket_bridge_receiver
+// ------------------------------------------------------------------------------------------------
+template<typename TAG, typename...Ts>
+    bool
+    astl::socket_bridge_receiver<TAG, Ts...>::open(int fd, bridge_options options) noexcept
+{
+    int type{0};
+    socklen_t length{sizeof(type)};
+    if (::getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &length) != 0) {
+        return false;
+    }
+    fd_ = fd;
+    type_ = type;
+    closed_ = false;
+    options_ = options;
+    begin_ = end_ = received_ = current_ = 0;
+    if (type_ == SOCK_STREAM) {
+        buffer_.resize(2 * options_.batch_bytes);
+        return true;
+    }
+    // one buffer per datagram, filled by a single recvmmsg
+    buffer_.resize(options_.receive_batches * options_.batch_bytes);
+    messages_.assign(options_.receive_batches, mmsghdr{});
+    vectors_.resize(options_.receive_batches);
+    for (std::size_t i = 0; i < options_.receive_batches; ++i) {
+        vectors_[i].iov_base = buffer_.data() + i * options_.batch_bytes;
+        vectors_[i].iov_len = options_.batch_bytes;
+        messages_[i].msg_hdr.msg_iov = &vectors_[i];
+        messages_[i].msg_hdr.msg_iovlen = 1;
+    }
+    return true;
+}
+
+template<typename TAG, typename...Ts>
+    typename astl::socket_bridge_receiver<TAG, Ts...>::signal_type&
+    astl::socket_bridge_receiver<TAG, Ts...>::sig() noexcept
+{
+    return event_.sig();
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::socket_bridge_receiver<TAG, Ts...>::poll(std::size_t max) noexcept
+{
+    if (fd_ < 0) {
+        return 0;
+    }
+    return type_ == SOCK_STREAM ? poll_stream(max) : poll_datagrams(max);
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::socket_bridge_receiver<TAG, Ts...>::wait(std::chrono::nanoseconds timeout, std::size_t max) noexcept
+{
+    auto count = poll(max);
+    if (count == 0 && !closed_) {
+        pollfd descriptor{fd_, POLLIN, 0};
+        auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        timespec time{static_cast<time_t>(seconds.count()), static_cast<long>((timeout - seconds).count())};
+        if (::ppoll(&descriptor, 1, &time, nullptr) > 0) {
+            count = poll(max);
+        }
+    }
+    return count;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::socket_bridge_receiver<TAG, Ts...>::closed() const noexcept
+{
+    return closed_;
+}
+
+template<typename TAG, typename...Ts>
+    std::uint64_t
+    astl::socket_bridge_receiver<TAG, Ts...>::malformed() const noexcept
+{
+    return malformed_;
+}
+
+template<typename TAG, typename...Ts>
+    typename astl::socket_bridge_receiver<TAG, Ts...>::frame_result
+    astl::socket_bridge_receiver<TAG, Ts...>::dispatch_frame(std::byte const*& in, std::byte const* end) noexcept
+{
+    frame_size length{0};
+    if (static_cast<std::size_t>(end - in) < sizeof(frame_size)) {
+        return frame_result::incomplete;
+    }
+    std::memcpy(&length, in, sizeof(frame_size));
+    if (static_cast<std::size_t>(end - in) - sizeof(frame_size) < length) {
+        return frame_result::incomplete;
+    }
+    auto const data = in + sizeof(frame_size);
+    in = data + length;
+    std::tuple<Ts...> values{};
+    if (!codec_type::decode(data, data + length, values)) {
+        return frame_result::malformed;
+    }
+    std::apply([this](Ts const&...args){ this->event_.invoke(args...); }, values);
+    return frame_result::dispatched;
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::socket_bridge_receiver<TAG, Ts...>::poll_stream(std::size_t max) noexcept
+{
+    std::size_t count{0};
+    while (count < max) {
+        std::byte const* in = buffer_.data() + begin_;
+        auto const result = dispatch_frame(in, buffer_.data() + end_);
+        if (result != frame_result::incomplete) {
+            begin_ = static_cast<std::size_t>(in - buffer_.data());
+            result == frame_result::dispatched ? ++count : ++malformed_;
+            continue;
+        }
+        if (closed_) {
+            break;
+        }
+        // keep the incomplete frame at the front and make room for frames larger than the buffer
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+        if (end_ >= sizeof(frame_size)) {
+            frame_size length{0};
+            std::memcpy(&length, buffer_.data(), sizeof(frame_size));
+            if (length > options_.max_pending) {
+                ++malformed_;
+                closed_ = true;
+                break;
+            }
+            if (sizeof(frame_size) + length > buffer_.size()) {
+                buffer_.resize(sizeof(frame_size) + length);
+            }
+        }
+        auto const read = ::recv(fd_, buffer_.data() + end_, buffer_.size() - end_, MSG_DONTWAIT);
+        if (read > 0) {
+            end_ += static_cast<std::size_t>(read);
+        }
+        else if (read == 0 || receive_failed()) {
+            closed_ = true;
+        }
+        else if (errno != EINTR) {
+            break;
+        }
+    }
+    return count;
+}
+
+template<typename TAG, typename...Ts>
+    std::size_t
+    astl::socket_bridge_receiver<TAG, Ts...>::poll_datagrams(std::size_t max) noexcept
+{
+    std::size_t count{0};
+    while (count < max) {
+        if (current_ < received_) {
+            auto const& message = messages_[current_];
+            if (message.msg_len == 0 && type_ == SOCK_SEQPACKET) {
+                closed_ = true;
+                break;
+            }
+            auto const data = buffer_.data() + current_ * options_.batch_bytes;
+            auto const end = data + message.msg_len;
+            std::byte const* in = data + begin_;
+            auto const result = (message.msg_hdr.msg_flags & MSG_TRUNC) ? frame_result::incomplete
+                                                                        : dispatch_frame(in, end);
+            if (result != frame_result::incomplete) {
+                begin_ = static_cast<std::size_t>(in - data);
+                result == frame_result::dispatched ? ++count : ++malformed_;
+                continue;
+            }
+            // a truncated datagram or the rest of one that does not form a frame is dropped
+            if (in != end || (message.msg_hdr.msg_flags & MSG_TRUNC)) {
+                ++malformed_;
+            }
+            ++current_;
+            begin_ = 0;
+            continue;
+        }
+        if (closed_) {
+            break;
+        }
+        auto const read = ::recvmmsg(fd_, messages_.data(), static_cast<unsigned>(messages_.size()), MSG_DONTWAIT,
+                                     nullptr);
+        if (read > 0) {
+            received_ = static_cast<std::size_t>(read);
+            current_ = 0;
+            begin_ = 0;
+        }
+        else if (read == 0 || receive_failed()) {
+            closed_ = true;
+        }
+        else if (errno != EINTR) {
+            break;
+        }
+    }
+    return count;
+}
+
+template<typename TAG, typename...Ts>
+    bool
+    astl::socket_bridge_receiver<TAG, Ts...>::receive_failed() noexcept
+{
+    return errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR;
+}
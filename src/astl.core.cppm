@@ -0,0 +1,49 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// Opt-in C++20 module interface of the core component, built with -DASTL_MODULES=ON:
+//     import astl.core;
+// The module is a thin wrapper around the headers, which remain the primary interface. Importing it compiles the
+// headers once per build instead of once per translation unit.
+module;
+
+#include <astl/event.h>
+#include <astl/recursive_event.h>
+#include <astl/slot_holder.h>
+#include <astl/final.h>
+#include <astl/multi_final.h>
+#include <astl/small_vector.h>
+#include <astl/flat_map.h>
+#include <astl/future.h>
+
+export module astl.core;
+
+export namespace astl {
+
+    using astl::slot_result;
+    using astl::signal;
+    using astl::slot;
+    using astl::event;
+    using astl::recursive_event;
+    using astl::slot_holder;
+    using astl::final;
+    using astl::multi_final;
+    using astl::small_vector;
+    using astl::flat_map;
+    using astl::inline_executor;
+    using astl::future;
+    using astl::promise;
+    using astl::when_all;
+    using astl::when_any;
+    using astl::next_invocation;
+
+} // namespace astl
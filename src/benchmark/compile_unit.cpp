@@ -0,0 +1,71 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+
+// Translation unit compiled by the astl-compile-benchmark target, once with ASTL_EXTERN_TEMPLATES and once without.
+// It uses the event machinery the way a typical producer/consumer source file does.
+#include <astl/event.h>
+#include <astl/slot_holder.h>
+#include <string>
+
+namespace {
+
+    struct producer
+    {
+        astl::event<bool, bool> enabled;
+        astl::event<int, int> count;
+        astl::event<unsigned, unsigned> id;
+        astl::event<long, long> offset;
+        astl::event<unsigned long, unsigned long> size;
+        astl::event<float, float> ratio;
+        astl::event<double, double> temperature;
+        astl::event<std::string, std::string> name;
+    };
+
+    struct consumer
+    {
+        explicit consumer(producer& p)
+        {
+            holder.connect(p.enabled.sig(), [this](bool v) { flags += v; });
+            holder.connect(p.count.sig(), [this](int v) { total += v; });
+            holder.connect(p.id.sig(), [this](unsigned v) { total += v; });
+            holder.connect(p.offset.sig(), [this](long v) { total += v; });
+            holder.connect(p.size.sig(), [this](unsigned long v) { total += static_cast<long>(v); });
+            holder.connect(p.ratio.sig(), [this](float v) { sum += v; });
+            holder.connect(p.temperature.sig(), [this](double v) { sum += v; });
+            holder.connect(p.name.sig(), [this](std::string const& v) { total += static_cast<long>(v.size()); });
+        }
+
+        astl::slot_holder holder;
+        long total{0};
+        double sum{0.0};
+        int flags{0};
+    };
+
+} // namespace
+
+long run_benchmark_unit(int n)
+{
+    producer p;
+    consumer c{p};
+    std::string const name{"sensor"};
+    for (auto i = 0; i < n; ++i) {
+        p.enabled.invoke(i % 2 == 0);
+        p.count.invoke(i);
+        p.id.invoke(static_cast<unsigned>(i));
+        p.offset.invoke(static_cast<long>(i));
+        p.size.invoke(static_cast<unsigned long>(i));
+        p.ratio.invoke(static_cast<float>(i));
+        p.temperature.invoke(static_cast<double>(i));
+        p.name.invoke(name);
+    }
+    return c.total + c.flags + static_cast<long>(c.sum);
+}
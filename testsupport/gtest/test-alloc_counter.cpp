@@ -0,0 +1,102 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <gtest/gtest.h>
+#include <gtest/gtest-spi.h>
+#include <astl/testsupport/alloc_counter.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+
+namespace {
+    // calls the allocation function directly, unlike new-expressions it may not be optimized away
+    struct block
+    {
+        block() : p{::operator new(16)} {}
+        ~block() { ::operator delete(p); }
+        void* p;
+    };
+}
+
+TEST(alloc_counter, CountsAllocations)
+{
+    astl::testsupport::alloc_counter counter{};
+    auto p = std::make_unique<std::string>(100, 'x');
+    counter.stop();
+    ASSERT_EQ(counter.allocations(), 2u);
+    ASSERT_GE(counter.bytes(), 100u);
+}
+
+TEST(alloc_counter, StopAndNesting)
+{
+    astl::testsupport::alloc_counter outer{};
+    block b1{};
+    {
+        astl::testsupport::alloc_counter inner{};
+        block b2{};
+        inner.stop();
+        block b3{};
+        ASSERT_EQ(inner.allocations(), 1u);
+    }
+    ASSERT_EQ(outer.allocations(), 3u);
+}
+
+TEST(alloc_counter, OtherThreadsNotCounted)
+{
+    std::atomic<int> step{0};
+    std::unique_ptr<std::string> p{};
+    std::thread t{[&step, &p](){
+        while (step.load() != 1) {
+            std::this_thread::yield();
+        }
+        p = std::make_unique<std::string>(100, 'x');
+        step = 2;
+    }};
+    astl::testsupport::alloc_counter counter{};
+    step = 1;
+    while (step.load() != 2) {
+        std::this_thread::yield();
+    }
+    counter.stop();
+    t.join();
+    ASSERT_EQ(counter.allocations(), 0u);
+}
+
+TEST(alloc_counter, CountsAlignedAllocations)
+{
+    void* volatile p1{nullptr};
+    void* volatile p2{nullptr};
+    void* volatile p3{nullptr};
+    astl::testsupport::alloc_counter counter{};
+    void* p{nullptr};
+    auto result = ::posix_memalign(&p, 64, 100);
+    p1 = p;
+    p2 = std::aligned_alloc(64, 128);
+    p3 = ::operator new(100, std::align_val_t{64});
+    counter.stop();
+    ASSERT_EQ(result, 0);
+    ASSERT_EQ(counter.allocations(), 3u);
+    ASSERT_GE(counter.bytes(), 328u);
+    std::free(p1);
+    std::free(p2);
+    ::operator delete(p3, std::align_val_t{64});
+}
+
+TEST(alloc_counter, ExpectAllocs)
+{
+    ASTL_EXPECT_NO_ALLOC { auto i = 1; (void)i; }
+    ASTL_EXPECT_ALLOCS(1) { block b{}; }
+    EXPECT_NONFATAL_FAILURE(ASTL_EXPECT_NO_ALLOC { block b{}; }, "counted 1");
+}
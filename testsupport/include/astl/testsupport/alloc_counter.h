@@ -0,0 +1,84 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace astl::testsupport {
+
+    //! Counts the heap allocations (malloc, calloc, realloc, posix_memalign, aligned_alloc, memalign, operator new) of the
+    //! calling thread during its lifetime or until stop(). Counters may be nested. Only available in test executables
+    //! linked with astl-testsupport.
+    //! \code
+    //! astl::testsupport::alloc_counter counter{};
+    //! holder.connect(ev.sig(), [](int const&){});
+    //! counter.stop();
+    //! std::cout << counter.allocations() << " allocations, " << counter.bytes() << " bytes\n";
+    //! \endcode
+    class alloc_counter
+    {
+    public:
+        explicit alloc_counter() noexcept;
+        ~alloc_counter() noexcept;
+
+        alloc_counter(alloc_counter const&) = delete;
+        alloc_counter& operator=(alloc_counter const&) = delete;
+
+        //! Stops counting.
+        void stop() noexcept;
+
+        //! Number of allocations counted.
+        [[nodiscard]] std::uint64_t allocations() const noexcept;
+
+        //! Number of bytes requested by the counted allocations.
+        [[nodiscard]] std::uint64_t bytes() const noexcept;
+
+    private:
+        std::uint64_t allocations_;
+        std::uint64_t bytes_;
+        bool running_{true};
+    };
+
+    //! Scope of ASTL_EXPECT_ALLOCS, reports a non-fatal gtest failure when the number of allocations differs.
+    class expect_allocs_scope
+    {
+    public:
+        expect_allocs_scope(char const* file, int line, std::uint64_t expected) noexcept;
+
+        [[nodiscard]] bool done() const noexcept;
+        void finish() noexcept;
+
+    private:
+        alloc_counter counter_{};
+        char const* file_;
+        int line_;
+        std::uint64_t expected_;
+        bool done_{false};
+    };
+
+} // namespace astl::testsupport
+
+//! Expects that the following statement or block performs exactly n heap allocations on the calling thread.
+//! \code
+//! ASTL_EXPECT_ALLOCS(1) { ev.sig().connect(secondSlot); }
+//! \endcode
+#define ASTL_EXPECT_ALLOCS(n) \
+    for (::astl::testsupport::expect_allocs_scope astl_expect_allocs_scope_{__FILE__, __LINE__, (n)}; \
+         !astl_expect_allocs_scope_.done(); astl_expect_allocs_scope_.finish())
+
+//! Expects that the following statement or block does not allocate heap memory on the calling thread.
+//! \code
+//! ASTL_EXPECT_NO_ALLOC { ev.invoke(1); }
+//! \endcode
+#define ASTL_EXPECT_NO_ALLOC ASTL_EXPECT_ALLOCS(0)
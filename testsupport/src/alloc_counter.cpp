@@ -0,0 +1,255 @@
+// (C) Copyright 2019 Alexander Seifarth
+//
+// This file is part of ASTL.
+// ASTL is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+// License as published by the Free Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+// ASTL is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+// You should have received a copy of the GNU General Public License along with Foobar.
+// If not, see <http://www.gnu.org/licenses/>.
+#include <astl/testsupport/alloc_counter.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <dlfcn.h>
+#include <sched.h>
+
+// The allocation functions of the C library are interposed by the definitions below, the next definitions - of the C
+// library or of a sanitizer runtime - are looked up with dlsym(RTLD_NEXT). operator new is replaced as well, so
+// allocations are counted even if the C++ runtime does not allocate through malloc. All functions returning heap
+// memory are counted, including the aligned ones (posix_memalign, aligned_alloc, memalign).
+namespace {
+    // plain thread_local PODs: accessing them must not allocate
+    thread_local std::uint64_t thread_allocations{0};
+    thread_local std::uint64_t thread_bytes{0};
+    thread_local bool resolving{false};
+
+    struct next_functions
+    {
+        void* (*malloc)(std::size_t);
+        void* (*calloc)(std::size_t, std::size_t);
+        void* (*realloc)(void*, std::size_t);
+        void (*free)(void*);
+        int (*posix_memalign)(void**, std::size_t, std::size_t);
+        void* (*aligned_alloc)(std::size_t, std::size_t);
+        void* (*memalign)(std::size_t, std::size_t);
+    };
+
+    // serves the allocations of dlsym() while the next functions are looked up, never freed
+    alignas(std::max_align_t) char bootstrap_buffer[4096];
+    std::atomic<std::size_t> bootstrap_used{0};
+
+    void* bootstrap_allocate(std::size_t size) noexcept
+    {
+        size = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        auto offset = bootstrap_used.fetch_add(size, std::memory_order_relaxed);
+        return offset + size <= sizeof(bootstrap_buffer) ? bootstrap_buffer + offset : nullptr;
+    }
+
+    bool is_bootstrap(void* p) noexcept
+    {
+        return p >= static_cast<void*>(bootstrap_buffer) && p < static_cast<void*>(bootstrap_buffer + sizeof(bootstrap_buffer));
+    }
+
+    template<typename F>
+    void lookup(F& function, char const* name) noexcept
+    {
+        function = reinterpret_cast<F>(::dlsym(RTLD_NEXT, name));
+    }
+
+    // std::call_once is not usable here, the first allocation may happen before the C++ runtime is initialized
+    next_functions const& next() noexcept
+    {
+        static next_functions functions{};
+        static std::atomic<int> state{0};   // 0: not looked up, 1: looking up, 2: ready
+        if (state.load(std::memory_order_acquire) != 2) {
+            auto expected = 0;
+            if (state.compare_exchange_strong(expected, 1, std::memory_order_acq_rel)) {
+                resolving = true;
+                lookup(functions.malloc, "malloc");
+                lookup(functions.calloc, "calloc");
+                lookup(functions.realloc, "realloc");
+                lookup(functions.free, "free");
+                lookup(functions.posix_memalign, "posix_memalign");
+                lookup(functions.aligned_alloc, "aligned_alloc");
+                lookup(functions.memalign, "memalign");
+                resolving = false;
+                state.store(2, std::memory_order_release);
+            }
+            while (state.load(std::memory_order_acquire) != 2) {
+                sched_yield();
+            }
+        }
+        return functions;
+    }
+
+    void count(std::size_t size) noexcept
+    {
+        ++thread_allocations;
+        thread_bytes += size;
+    }
+
+    void release(void* p) noexcept
+    {
+        if (p && !is_bootstrap(p)) {
+            next().free(p);
+        }
+    }
+
+    void* allocate(std::size_t size)
+    {
+        count(size);
+        if (auto p = next().malloc(size ? size : 1)) {
+            return p;
+        }
+        throw std::bad_alloc{};
+    }
+
+    void* allocate_aligned(std::size_t size, std::align_val_t alignment)
+    {
+        count(size);
+        void* p{nullptr};
+        if (next().posix_memalign(&p, static_cast<std::size_t>(alignment), size ? size : 1) == 0) {
+            return p;
+        }
+        throw std::bad_alloc{};
+    }
+}
+
+extern "C" {
+    void* malloc(std::size_t size) noexcept
+    {
+        if (resolving) {
+            return bootstrap_allocate(size);
+        }
+        count(size);
+        return next().malloc(size);
+    }
+
+    void* calloc(std::size_t count_, std::size_t size) noexcept
+    {
+        if (resolving) {
+            return bootstrap_allocate(count_ * size);   // zero initialized, never reused
+        }
+        count(count_ * size);
+        return next().calloc(count_, size);
+    }
+
+    void* realloc(void* p, std::size_t size) noexcept
+    {
+        if (is_bootstrap(p)) {
+            auto moved = malloc(size);
+            if (moved) {
+                auto available = static_cast<std::size_t>(bootstrap_buffer + sizeof(bootstrap_buffer) - static_cast<char*>(p));
+                std::memcpy(moved, p, size < available ? size : available);
+            }
+            return moved;
+        }
+        count(size);
+        return next().realloc(p, size);
+    }
+
+    void free(void* p) noexcept
+    {
+        release(p);
+    }
+
+    int posix_memalign(void** p, std::size_t alignment, std::size_t size) noexcept
+    {
+        count(size);
+        return next().posix_memalign(p, alignment, size);
+    }
+
+    void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+    {
+        count(size);
+        return next().aligned_alloc(alignment, size);
+    }
+
+    void* memalign(std::size_t alignment, std::size_t size) noexcept
+    {
+        count(size);
+        return next().memalign(alignment, size);
+    }
+
+    // LeakSanitizer ignores the allocations of the dynamic loader by their caller, which is the interposed malloc
+    // now. Libraries loaded at runtime (e.g. libgcc by backtrace()) are never unloaded.
+    char const* __lsan_default_suppressions()
+    {
+        return "leak:*/ld-linux*.so*\n";
+    }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept { count(size); return next().malloc(size ? size : 1); }
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept { count(size); return next().malloc(size ? size : 1); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+
+// ------------------------------------------------------------------------------------------------
+// impl alloc_counter
+// ------------------------------------------------------------------------------------------------
+astl::testsupport::alloc_counter::alloc_counter() noexcept
+    : allocations_{thread_allocations}
+    , bytes_{thread_bytes}
+{}
+
+astl::testsupport::alloc_counter::~alloc_counter() noexcept = default;
+
+void astl::testsupport::alloc_counter::stop() noexcept
+{
+    if (running_) {
+        allocations_ = thread_allocations - allocations_;
+        bytes_ = thread_bytes - bytes_;
+        running_ = false;
+    }
+}
+
+std::uint64_t astl::testsupport::alloc_counter::allocations() const noexcept
+{
+    return running_ ? thread_allocations - allocations_ : allocations_;
+}
+
+std::uint64_t astl::testsupport::alloc_counter::bytes() const noexcept
+{
+    return running_ ? thread_bytes - bytes_ : bytes_;
+}
+
+// ------------------------------------------------------------------------------------------------
+// impl expect_allocs_scope
+// ------------------------------------------------------------------------------------------------
+astl::testsupport::expect_allocs_scope::expect_allocs_scope(char const* file, int line,
+                                                           std::uint64_t expected) noexcept
+    : file_{file}
+    , line_{line}
+    , expected_{expected}
+{}
+
+bool astl::testsupport::expect_allocs_scope::done() const noexcept
+{
+    return done_;
+}
+
+void astl::testsupport::expect_allocs_scope::finish() noexcept
+{
+    counter_.stop();
+    done_ = true;
+    if (counter_.allocations() != expected_) {
+        ADD_FAILURE_AT(file_, line_) << "Expected " << expected_ << " heap allocation(s), counted "
+                                     << counter_.allocations() << " (" << counter_.bytes() << " bytes)";
+    }
+}